@@ -2,6 +2,7 @@
 // Noncommercial use only. Commercial use requires written permission.
 // See https://polyformproject.org/licenses/noncommercial/1.0.0/
 #include "HexCell.h"
+#include "HexGridGeometry.h"
 
 FHexCell::FHexCell()
 {
@@ -47,24 +48,9 @@ float FHexCell::CalculateArea(float SphereRadius) const
 	}
 
 	// Use spherical excess formula for spherical polygons
-	float totalArea = 0.0f;
-	FVector center = Position * SphereRadius;
-
-	for (int32 i = 0; i < Vertices.Num(); ++i)
-	{
-		int32 nextIndex = (i + 1) % Vertices.Num();
-		FVector v1 = Vertices[i] * SphereRadius;
-		FVector v2 = Vertices[nextIndex] * SphereRadius;
-
-		// Area of the spherical triangle formed by center, v1, and v2
-		// Simplified using cross product magnitude / 2
-		FVector edge1 = v1 - center;
-		FVector edge2 = v2 - center;
-		float triangleArea = FVector::CrossProduct(edge1, edge2).Size() / 2.0f;
-		totalArea += triangleArea;
-	}
-
-	return totalArea;
+	// Prefer UHexGridAsset::GetGeometry() when querying many cells, areas are cached there
+	double unitArea = FHexGridGeometry::ComputeSphericalPolygonArea(Position.GetSafeNormal(), Vertices);
+	return static_cast<float>(unitArea) * SphereRadius * SphereRadius;
 }
 
 FVector FHexCell::GetVertexCentroid() const
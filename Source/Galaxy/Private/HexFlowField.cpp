@@ -0,0 +1,326 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexFlowField.h"
+#include "HexGridAsset.h"
+#include "HexPathfinder.h"
+#include "PlanetData.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	struct FFlowNode
+	{
+		int32 CellId = INDEX_NONE;
+		float Distance = 0.0f;
+	};
+
+	struct FFlowNodePredicate
+	{
+		bool operator()(const FFlowNode& A, const FFlowNode& B) const
+		{
+			return A.Distance < B.Distance;
+		}
+	};
+
+	/// <summary>
+	/// Run Dijkstra from the nodes already in the heap, improving any cell it can reach
+	/// </summary>
+	void PropagateDistances(const FHexFlowCostGraph& graph, TArray<FFlowNode>& open, FHexFlowField& field)
+	{
+		while (open.Num() > 0)
+		{
+			FFlowNode node;
+			open.HeapPop(node, FFlowNodePredicate(), EAllowShrinking::No);
+
+			// Stale heap entry
+			if (node.Distance > field.Distance[node.CellId])
+			{
+				continue;
+			}
+
+			for (int32 slot = 0; slot < FHexFlowCostGraph::MaxNeighbors; ++slot)
+			{
+				int32 neighborId = graph.GetNeighbor(node.CellId, slot);
+				float cost = neighborId != INDEX_NONE ? graph.GetCost(node.CellId, slot) : MAX_flt;
+				if (cost >= MAX_flt)
+				{
+					continue;
+				}
+
+				float distance = node.Distance + cost;
+				if (distance < field.Distance[neighborId])
+				{
+					field.Distance[neighborId] = distance;
+					field.NextCellId[neighborId] = node.CellId;
+					open.HeapPush({ neighborId, distance }, FFlowNodePredicate());
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Breadth first propagation, only valid when every edge has the same cost
+	/// </summary>
+	void PropagateHops(const FHexFlowCostGraph& graph, TArray<int32>& frontier, FHexFlowField& field)
+	{
+		for (int32 i = 0; i < frontier.Num(); ++i)
+		{
+			const int32 cellId = frontier[i];
+			for (int32 slot = 0; slot < FHexFlowCostGraph::MaxNeighbors; ++slot)
+			{
+				int32 neighborId = graph.GetNeighbor(cellId, slot);
+				if (neighborId == INDEX_NONE || graph.GetCost(cellId, slot) >= MAX_flt || field.Distance[neighborId] < MAX_flt)
+				{
+					continue;
+				}
+
+				field.Distance[neighborId] = field.Distance[cellId] + graph.GetCost(cellId, slot);
+				field.NextCellId[neighborId] = cellId;
+				frontier.Add(neighborId);
+			}
+		}
+	}
+}
+
+// === Cost graph ===
+
+void FHexFlowCostGraph::Build(const UPlanetData& planet)
+{
+	if (!planet.AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FHexFlowCostGraph::Build - Planet data layers are not initialized."));
+		CellCount = 0;
+		return;
+	}
+
+	BuildTopology(*planet.Grid);
+	bUniformCost = false;
+
+	ParallelFor(CellCount, [&](int32 cellId)
+		{
+			ComputeCellEdges(planet, cellId);
+		});
+}
+
+void FHexFlowCostGraph::BuildUniform(const UHexGridAsset& grid)
+{
+	BuildTopology(grid);
+	bUniformCost = true;
+
+	for (int32 i = 0; i < NeighborIds.Num(); ++i)
+	{
+		EdgeCosts[i] = NeighborIds[i] != INDEX_NONE ? 1.0f : MAX_flt;
+	}
+}
+
+void FHexFlowCostGraph::UpdateCells(const UPlanetData& planet, TConstArrayView<int32> cellIds)
+{
+	if (bUniformCost)
+	{
+		return;
+	}
+
+	for (int32 cellId : cellIds)
+	{
+		if (cellId < 0 || cellId >= CellCount)
+		{
+			continue;
+		}
+
+		// Edges are stored on both ends
+		ComputeCellEdges(planet, cellId);
+		for (int32 slot = 0; slot < MaxNeighbors; ++slot)
+		{
+			int32 neighborId = GetNeighbor(cellId, slot);
+			if (neighborId != INDEX_NONE)
+			{
+				ComputeCellEdges(planet, neighborId);
+			}
+		}
+	}
+}
+
+void FHexFlowCostGraph::BuildTopology(const UHexGridAsset& grid)
+{
+	CellCount = grid.Cells.Num();
+	NeighborIds.Init(INDEX_NONE, CellCount * MaxNeighbors);
+	EdgeCosts.Init(MAX_flt, CellCount * MaxNeighbors);
+
+	for (int32 cellId = 0; cellId < CellCount; ++cellId)
+	{
+		const TArray<uint32>& neighbors = grid.Cells[cellId].NeighborCellIds;
+		const int32 count = FMath::Min(neighbors.Num(), MaxNeighbors);
+		for (int32 slot = 0; slot < count; ++slot)
+		{
+			NeighborIds[cellId * MaxNeighbors + slot] = neighbors[slot];
+		}
+	}
+}
+
+void FHexFlowCostGraph::ComputeCellEdges(const UPlanetData& planet, int32 cellId)
+{
+	for (int32 slot = 0; slot < MaxNeighbors; ++slot)
+	{
+		const int32 index = cellId * MaxNeighbors + slot;
+		const int32 neighborId = NeighborIds[index];
+
+		// Sources may sit on impassable cells (ports, ...), so only the destination has to be passable
+		EdgeCosts[index] = neighborId != INDEX_NONE && FHexTraversalCost::IsPassable(planet, neighborId)
+			? FHexTraversalCost::GetStepCost(planet, cellId, neighborId)
+			: MAX_flt;
+	}
+}
+
+// === Flow field ===
+
+void FHexFlowField::Reset()
+{
+	SourceCellIds.Reset();
+	Distance.Reset();
+	NextCellId.Reset();
+}
+
+void FHexFlowFieldBuilder::Compute(const FHexFlowCostGraph& graph, TConstArrayView<int32> sourceCellIds, FHexFlowField& outField)
+{
+	const int32 cellCount = graph.GetCellCount();
+
+	outField.SourceCellIds.Reset();
+	outField.Distance.Init(MAX_flt, cellCount);
+	outField.NextCellId.Init(INDEX_NONE, cellCount);
+
+	if (graph.IsUniform())
+	{
+		TArray<int32> frontier;
+		frontier.Reserve(cellCount);
+		for (int32 sourceId : sourceCellIds)
+		{
+			if (sourceId >= 0 && sourceId < cellCount && outField.Distance[sourceId] > 0.0f)
+			{
+				outField.Distance[sourceId] = 0.0f;
+				outField.SourceCellIds.Add(sourceId);
+				frontier.Add(sourceId);
+			}
+		}
+
+		PropagateHops(graph, frontier, outField);
+		return;
+	}
+
+	TArray<FFlowNode> open;
+	for (int32 sourceId : sourceCellIds)
+	{
+		if (sourceId >= 0 && sourceId < cellCount && outField.Distance[sourceId] > 0.0f)
+		{
+			outField.Distance[sourceId] = 0.0f;
+			outField.SourceCellIds.Add(sourceId);
+			open.HeapPush({ sourceId, 0.0f }, FFlowNodePredicate());
+		}
+	}
+
+	PropagateDistances(graph, open, outField);
+}
+
+void FHexFlowFieldBuilder::ComputeMany(const FHexFlowCostGraph& graph, TConstArrayView<TArray<int32>> sourceSets, TArray<FHexFlowField>& outFields)
+{
+	outFields.SetNum(sourceSets.Num());
+
+	ParallelFor(sourceSets.Num(), [&](int32 fieldIdx)
+		{
+			Compute(graph, sourceSets[fieldIdx], outFields[fieldIdx]);
+		});
+}
+
+int32 FHexFlowFieldBuilder::Repair(const FHexFlowCostGraph& graph, TConstArrayView<int32> changedCellIds, FHexFlowField& field)
+{
+	const int32 cellCount = graph.GetCellCount();
+	if (field.Distance.Num() != cellCount)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FHexFlowFieldBuilder::Repair - Field does not match the graph, computing it again."));
+		TArray<int32> sources = field.SourceCellIds;
+		Compute(graph, sources, field);
+		return cellCount;
+	}
+
+	// Changed cells and every cell whose route goes through one of them.
+	// A cell's next cell is always one of its neighbors, so the route tree is walked through neighbors.
+	TSet<int32> affectedSet;
+	TArray<int32> affected;
+	for (int32 cellId : changedCellIds)
+	{
+		if (cellId >= 0 && cellId < cellCount && !affectedSet.Contains(cellId))
+		{
+			affectedSet.Add(cellId);
+			affected.Add(cellId);
+		}
+	}
+
+	for (int32 i = 0; i < affected.Num(); ++i)
+	{
+		const int32 cellId = affected[i];
+		for (int32 slot = 0; slot < FHexFlowCostGraph::MaxNeighbors; ++slot)
+		{
+			int32 neighborId = graph.GetNeighbor(cellId, slot);
+			if (neighborId != INDEX_NONE && field.NextCellId[neighborId] == cellId && !affectedSet.Contains(neighborId))
+			{
+				affectedSet.Add(neighborId);
+				affected.Add(neighborId);
+			}
+		}
+	}
+
+	TSet<int32> sources(field.SourceCellIds);
+	for (int32 cellId : affected)
+	{
+		field.Distance[cellId] = sources.Contains(cellId) ? 0.0f : MAX_flt;
+		field.NextCellId[cellId] = INDEX_NONE;
+	}
+
+	// Seed the affected cells from their unaffected neighbors, whose routes are still valid
+	TArray<FFlowNode> open;
+	for (int32 cellId : affected)
+	{
+		if (field.Distance[cellId] == 0.0f)
+		{
+			open.HeapPush({ cellId, 0.0f }, FFlowNodePredicate());
+			continue;
+		}
+
+		for (int32 slot = 0; slot < FHexFlowCostGraph::MaxNeighbors; ++slot)
+		{
+			int32 neighborId = graph.GetNeighbor(cellId, slot);
+			if (neighborId == INDEX_NONE || affectedSet.Contains(neighborId) || field.Distance[neighborId] >= MAX_flt)
+			{
+				continue;
+			}
+
+			// Costs are symmetric, the edge cost stored on the neighbor's side is the same
+			int32 backSlot = INDEX_NONE;
+			for (int32 otherSlot = 0; otherSlot < FHexFlowCostGraph::MaxNeighbors; ++otherSlot)
+			{
+				if (graph.GetNeighbor(neighborId, otherSlot) == cellId)
+				{
+					backSlot = otherSlot;
+					break;
+				}
+			}
+
+			float cost = backSlot != INDEX_NONE ? graph.GetCost(neighborId, backSlot) : MAX_flt;
+			if (cost < MAX_flt && field.Distance[neighborId] + cost < field.Distance[cellId])
+			{
+				field.Distance[cellId] = field.Distance[neighborId] + cost;
+				field.NextCellId[cellId] = neighborId;
+			}
+		}
+
+		if (field.Distance[cellId] < MAX_flt)
+		{
+			open.HeapPush({ cellId, field.Distance[cellId] }, FFlowNodePredicate());
+		}
+	}
+
+	// Cost decreases can also shorten routes of unaffected cells, Dijkstra handles both
+	PropagateDistances(graph, open, field);
+
+	return affected.Num();
+}
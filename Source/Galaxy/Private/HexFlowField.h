@@ -0,0 +1,103 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UHexGridAsset;
+class UPlanetData;
+
+/// <summary>
+/// Flattened edge costs of the cell graph, shared by every flow field computed on the same planet.
+/// Each cell has MaxNeighbors slots, unused slots (pentagons) have NeighborIds == INDEX_NONE.
+/// Edges towards impassable cells cost MAX_flt.
+/// </summary>
+class GALAXY_API FHexFlowCostGraph
+{
+public:
+	static constexpr int32 MaxNeighbors = 6;
+
+	/// <summary>
+	/// Build edge costs from the planet data layers (FHexTraversalCost), in parallel
+	/// </summary>
+	void Build(const UPlanetData& planet);
+
+	/// <summary>
+	/// Build a graph where every edge costs 1 (hop count)
+	/// </summary>
+	void BuildUniform(const UHexGridAsset& grid);
+
+	/// <summary>
+	/// Refresh the cost of every edge touching these cells after their data changed
+	/// </summary>
+	void UpdateCells(const UPlanetData& planet, TConstArrayView<int32> cellIds);
+
+	int32 GetCellCount() const { return CellCount; }
+	bool IsValid() const { return CellCount > 0; }
+	bool IsUniform() const { return bUniformCost; }
+
+	int32 GetNeighbor(int32 cellId, int32 slot) const { return NeighborIds[cellId * MaxNeighbors + slot]; }
+	float GetCost(int32 cellId, int32 slot) const { return EdgeCosts[cellId * MaxNeighbors + slot]; }
+
+private:
+	void BuildTopology(const UHexGridAsset& grid);
+	void ComputeCellEdges(const UPlanetData& planet, int32 cellId);
+
+	int32 CellCount = 0;
+	bool bUniformCost = false;
+	TArray<int32> NeighborIds;
+	TArray<float> EdgeCosts;
+};
+
+/// <summary>
+/// Distance to the nearest source for every cell, plus the neighbor to step to in order to get closer.
+/// Sources have a distance of 0 and no next cell, unreachable cells have a distance of MAX_flt.
+/// </summary>
+struct GALAXY_API FHexFlowField
+{
+	TArray<int32> SourceCellIds;
+	TArray<float> Distance;
+	TArray<int32> NextCellId;
+
+	bool IsValid() const { return Distance.Num() > 0; }
+	bool IsReachable(int32 cellId) const { return Distance.IsValidIndex(cellId) && Distance[cellId] < MAX_flt; }
+	float GetDistance(int32 cellId) const { return Distance.IsValidIndex(cellId) ? Distance[cellId] : MAX_flt; }
+	int32 GetNextCell(int32 cellId) const { return NextCellId.IsValidIndex(cellId) ? NextCellId[cellId] : INDEX_NONE; }
+
+	void Reset();
+};
+
+/// <summary>
+/// Multi-source Dijkstra / BFS over the cell graph
+/// </summary>
+class GALAXY_API FHexFlowFieldBuilder
+{
+public:
+	/// <summary>
+	/// Compute a flow field from a set of sources (Dijkstra, or BFS when every edge has the same cost)
+	/// </summary>
+	/// <param name="graph">Edge costs</param>
+	/// <param name="sourceCellIds">Cells the field flows towards</param>
+	/// <param name="outField">Resulting field</param>
+	static void Compute(const FHexFlowCostGraph& graph, TConstArrayView<int32> sourceCellIds, FHexFlowField& outField);
+
+	/// <summary>
+	/// Compute many independent flow fields on the same graph, in parallel
+	/// </summary>
+	/// <param name="graph">Edge costs</param>
+	/// <param name="sourceSets">One set of sources per field</param>
+	/// <param name="outFields">Resulting fields, same order as the source sets</param>
+	static void ComputeMany(const FHexFlowCostGraph& graph, TConstArrayView<TArray<int32>> sourceSets, TArray<FHexFlowField>& outFields);
+
+	/// <summary>
+	/// Repair a field after the cost of a few cells changed.
+	/// The graph must already be updated (FHexFlowCostGraph::UpdateCells).
+	/// Only the cells whose route went through a changed cell are searched again.
+	/// </summary>
+	/// <param name="graph">Updated edge costs</param>
+	/// <param name="changedCellIds">Cells whose cost changed</param>
+	/// <param name="field">Field to repair</param>
+	/// <returns>Number of cells that were searched again</returns>
+	static int32 Repair(const FHexFlowCostGraph& graph, TConstArrayView<int32> changedCellIds, FHexFlowField& field);
+};
@@ -2,6 +2,8 @@
 // Noncommercial use only. Commercial use requires written permission.
 // See https://polyformproject.org/licenses/noncommercial/1.0.0/
 #include "HexGridAsset.h"
+#include "HexFlowField.h"
+#include "Async/ParallelFor.h"
 
 const FHexCell& UHexGridAsset::GetCellById(int32 CellId) const
 {
@@ -30,21 +32,17 @@ int32 UHexGridAsset::FindCellAtPosition(const FVector& Position) const
 		return INDEX_NONE;
 	}
 
-	FVector normalizedPos = Position.GetSafeNormal();
+	return GetRuntime()->GetSpatialIndex().FindCell(Position);
+}
 
-	uint32 closestCellId = 0;
-	float minDistanceSq = FLT_MAX;
-	for (int32 i = 0; i < Cells.Num(); ++i)
+int32 UHexGridAsset::FindCellAlongRay(const FVector& RayOrigin, const FVector& RayDirection, float SphereRadius, FVector& OutHitPosition) const
+{
+	if (Cells.Num() == 0 || !FHexSpatialIndex::IntersectRaySphere(RayOrigin, RayDirection, SphereRadius, OutHitPosition))
 	{
-		float distanceSq = FVector::DistSquared(normalizedPos, Cells[i].Position);
-		if (distanceSq < minDistanceSq)
-		{
-			minDistanceSq = distanceSq;
-			closestCellId = i;
-		}
+		return INDEX_NONE;
 	}
 
-	return closestCellId;
+	return GetRuntime()->GetSpatialIndex().FindCell(OutHitPosition);
 }
 
 void UHexGridAsset::FindClosestCells(const FVector& Position, TArray<int32>& outCells, int32 Count /*= 3*/) const
@@ -107,70 +105,174 @@ const TArray<int32>& UHexGridAsset::GetPentagons() const
 	return PentagonCellsIds;
 }
 
-bool UHexGridAsset::ValidateGrid(TArray<FString>& outErrors) const
+void UHexGridAsset::ComputeDistanceField(const TArray<int32>& SourceCellIds, TArray<int32>& OutDistances, TArray<int32>& OutNextCellIds) const
 {
-	outErrors.Empty();
-	bool bIsValid = true;
+	FHexFlowCostGraph hopGraph;
+	hopGraph.BuildUniform(*this);
 
-	// Check pentagon count
-	if (PentagonCount != 12)
+	FHexFlowField field;
+	FHexFlowFieldBuilder::Compute(hopGraph, SourceCellIds, field);
+
+	OutDistances.SetNumUninitialized(field.Distance.Num());
+	for (int32 i = 0; i < field.Distance.Num(); ++i)
 	{
-		outErrors.Add(FString::Printf(TEXT("Invalid pentagon count: expected 12, found %d"), PentagonCount));
-		bIsValid = false;
+		OutDistances[i] = field.Distance[i] < MAX_flt ? FMath::RoundToInt32(field.Distance[i]) : INDEX_NONE;
 	}
 
+	OutNextCellIds = MoveTemp(field.NextCellId);
+}
+
+bool UHexGridAsset::ValidateGrid(TArray<FString>& outErrors, int32 MaxReportedErrors /*= 100*/) const
+{
+	outErrors.Empty();
+	bool bIsValid = true;
+	int32 errorCount = 0;
+
+	auto reportError = [&](FString&& message)
+		{
+			bIsValid = false;
+			if (errorCount++ < MaxReportedErrors)
+			{
+				outErrors.Add(MoveTemp(message));
+			}
+		};
+
 	// Check total cell count
 	if (TotalCellCount != Cells.Num())
 	{
-		outErrors.Add(FString::Printf(TEXT("Invalid total cell count: expected %d, found %d"), TotalCellCount, Cells.Num()));
-		bIsValid = false;
+		reportError(FString::Printf(TEXT("Invalid total cell count: expected %d, found %d"), TotalCellCount, Cells.Num()));
 	}
 
-	// Validate each cell
+	// Validate each cell in parallel, failures are only recorded as flags and formatted afterwards
+	enum ECellCheck : uint8
+	{
+		CellIdMismatch		= 1 << 0,
+		NeighborCount		= 1 << 1,
+		InvalidNeighbor		= 1 << 2,
+		NeighborSymmetry	= 1 << 3,
+		VertexCount			= 1 << 4,
+		VertexWinding		= 1 << 5,
+		NotNormalized		= 1 << 6,
+	};
+
+	TArray<uint8> failedChecks;
+	failedChecks.SetNumZeroed(Cells.Num());
+
+	ParallelFor(Cells.Num(), [&](int32 i)
+		{
+			const FHexCell& cell = Cells[i];
+			uint8 flags = 0;
+
+			// Check cell ID matches index
+			if (cell.CellId != i)
+			{
+				flags |= CellIdMismatch;
+			}
+
+			// Check neighbor count
+			if (cell.NeighborCellIds.Num() != cell.GetNeighborCount())
+			{
+				flags |= NeighborCount;
+			}
+
+			// Check neighbor ids (range, self, duplicates) and symmetry
+			for (int32 n = 0; n < cell.NeighborCellIds.Num(); ++n)
+			{
+				const uint32 neighborId = cell.NeighborCellIds[n];
+				if (neighborId >= static_cast<uint32>(Cells.Num()) || neighborId == static_cast<uint32>(i)
+					|| TConstArrayView<uint32>(cell.NeighborCellIds.GetData(), n).Contains(neighborId))
+				{
+					flags |= InvalidNeighbor;
+					continue;
+				}
+
+				if (!Cells[neighborId].NeighborCellIds.Contains(static_cast<uint32>(i)))
+				{
+					flags |= NeighborSymmetry;
+				}
+			}
+
+			// Check vertices go counter-clockwise around the center, seen from outside
+			if (cell.Vertices.Num() != cell.GetNeighborCount())
+			{
+				flags |= VertexCount;
+			}
+
+			for (int32 v = 0; v < cell.Vertices.Num(); ++v)
+			{
+				FVector edge1 = cell.Vertices[v] - cell.Position;
+				FVector edge2 = cell.Vertices[(v + 1) % cell.Vertices.Num()] - cell.Position;
+				if (FVector::DotProduct(FVector::CrossProduct(edge1, edge2), cell.Position) <= 0.0)
+				{
+					flags |= VertexWinding;
+					break;
+				}
+			}
+
+			// Check position normalization
+			if (!FMath::IsNearlyEqual(cell.Position.Size(), 1.0f, 0.001f))
+			{
+				flags |= NotNormalized;
+			}
+
+			failedChecks[i] = flags;
+		});
+
+	int32 pentagonCellCount = 0;
 	for (int32 i = 0; i < Cells.Num(); ++i)
 	{
-		const FHexCell& cell = Cells[i];
+		pentagonCellCount += Cells[i].IsPentagon() ? 1 : 0;
 
-		// Check cell ID matches index
-		if (cell.CellId != i)
+		const uint8 flags = failedChecks[i];
+		if (flags == 0)
 		{
-			outErrors.Add(FString::Printf(TEXT("Cell ID mismatch at index %d: found %d"), i, cell.CellId));
-			bIsValid = false;
+			continue;
 		}
 
-		// Check neighbor count
-		int32 expectedNeighborCount = cell.GetNeighborCount();
-		if (cell.NeighborCellIds.Num() != expectedNeighborCount)
+		const FHexCell& cell = Cells[i];
+		if (flags & CellIdMismatch)
 		{
-			outErrors.Add(FString::Printf(TEXT("Neighbor count mismatch at index %d: expected %d, found %d"), i, expectedNeighborCount, cell.NeighborCellIds.Num()));
-			bIsValid = false;
+			reportError(FString::Printf(TEXT("Cell ID mismatch at index %d: found %d"), i, cell.CellId));
 		}
-
-		// Check neighbor symmetry
-		// TODO Check symmetry analysis and reenable.
-		//for (int32 neighborId : cell.NeighborCellIds)
-		//{
-		//	if (neighborId >= i)
-		//	{
-		//		outErrors.Add(FString::Printf(TEXT("Neighbor symmetry mismatch at index %d: found neighbor %d"), i, neighborId));
-		//		bIsValid = false;
-		//		continue;
-		//	}
-
-		//	const FHexCell& neighborCell = Cells[neighborId];
-		//	if (!neighborCell.HasNeighbor(i))
-		//	{
-		//		outErrors.Add(FString::Printf(TEXT("Neighbor symmetry mismatch between cells %d and %d"), i, neighborId));
-		//		bIsValid = false;
-		//	}
-		//}
-
-		// Check position normalization
-		if (!FMath::IsNearlyEqual(cell.Position.Size(), 1.0f, 0.001f))
+		if (flags & NeighborCount)
 		{
-			outErrors.Add(FString::Printf(TEXT("Cell %d is not normalized, length=%f"), i, cell.Position.Size()));
-			bIsValid = false;
+			reportError(FString::Printf(TEXT("Neighbor count mismatch at index %d: expected %d, found %d"), i, cell.GetNeighborCount(), cell.NeighborCellIds.Num()));
+		}
+		if (flags & InvalidNeighbor)
+		{
+			reportError(FString::Printf(TEXT("Cell %d has an invalid, duplicated or self neighbor"), i));
+		}
+		if (flags & NeighborSymmetry)
+		{
+			reportError(FString::Printf(TEXT("Neighbor symmetry mismatch at index %d: a neighbor does not list it back"), i));
 		}
+		if (flags & VertexCount)
+		{
+			reportError(FString::Printf(TEXT("Vertex count mismatch at index %d: expected %d, found %d"), i, cell.GetNeighborCount(), cell.Vertices.Num()));
+		}
+		if (flags & VertexWinding)
+		{
+			reportError(FString::Printf(TEXT("Cell %d vertices are not ordered counter-clockwise"), i));
+		}
+		if (flags & NotNormalized)
+		{
+			reportError(FString::Printf(TEXT("Cell %d is not normalized, length=%f"), i, cell.Position.Size()));
+		}
+	}
+
+	// Check pentagon count, then the pentagon cells match it. A single error for a wrong count
+	if (PentagonCount != 12)
+	{
+		reportError(FString::Printf(TEXT("Invalid pentagon count: expected 12, found %d (%d pentagon cells, %d pentagon ids)"), PentagonCount, pentagonCellCount, PentagonCellsIds.Num()));
+	}
+	else if (pentagonCellCount != PentagonCount || PentagonCellsIds.Num() != PentagonCount)
+	{
+		reportError(FString::Printf(TEXT("Pentagon count mismatch: %d pentagon cells, %d pentagon ids, PentagonCount=%d"), pentagonCellCount, PentagonCellsIds.Num(), PentagonCount));
+	}
+
+	if (errorCount > MaxReportedErrors)
+	{
+		outErrors.Add(FString::Printf(TEXT("... %d more errors not reported"), errorCount - MaxReportedErrors));
 	}
 
 	return bIsValid;
@@ -183,14 +285,10 @@ void UHexGridAsset::CalculateStatistics()
 		return;
 	}
 
-	TArray<float> areas;
-	areas.Reserve(Cells.Num());
-
-	for (const FHexCell& cell : Cells)
-	{
-		float area = cell.CalculateArea(1.0f); // Assuming unit sphere radius
-		areas.Add(area);
-	}
+	// Cells are final at this point, derived data is rebuilt from them
+	InvalidateRuntimeData();
+	const FHexGridRuntimePtr runtime = GetRuntime();
+	TConstArrayView<float> areas = runtime->GetGeometry().GetCellAreas(); // Unit sphere
 
 	// Find min and max
 	MinCellArea = areas[0];
@@ -230,3 +328,37 @@ int32 UHexGridAsset::GetExpectedCellCount(int32 Level)
 
 	return baseVertices + edgeVertices + faceVertices;
 }
+
+FHexGridRuntimePtr UHexGridAsset::GetRuntime() const
+{
+	FScopeLock lock(&RuntimeDataLock);
+
+	if (!Runtime.IsValid() || Runtime->GetCellCount() != Cells.Num())
+	{
+		Runtime = FHexGridRuntimeCache::Acquire(*this);
+	}
+
+	return Runtime;
+}
+
+const FHexSpatialIndex& UHexGridAsset::GetSpatialIndex() const
+{
+	FHexGridRuntimePtr runtime = GetRuntime();
+	check(runtime.IsValid());
+
+	// Only the asset keeps the runtime alive once this returns
+	return runtime->GetSpatialIndex();
+}
+
+const FHexGridGeometry& UHexGridAsset::GetGeometry() const
+{
+	FHexGridRuntimePtr runtime = GetRuntime();
+	check(runtime.IsValid());
+	return runtime->GetGeometry();
+}
+
+void UHexGridAsset::InvalidateRuntimeData()
+{
+	FScopeLock lock(&RuntimeDataLock);
+	Runtime.Reset();
+}
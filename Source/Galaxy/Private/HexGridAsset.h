@@ -6,6 +6,9 @@
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
 #include "HexCell.h"
+#include "HexSpatialIndex.h"
+#include "HexGridGeometry.h"
+#include "HexGridRuntime.h"
 #include "HexGridAsset.generated.h"
 
 UCLASS(BlueprintType)
@@ -50,9 +53,19 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid")
 	void GetNeighbors(int32 CellId, TArray<int32>& outNeighborIds) const;
 
+	/** Neighbors of a cell without copying them, empty for an invalid cell */
+	TConstArrayView<uint32> GetNeighborView(int32 CellId) const
+	{
+		return Cells.IsValidIndex(CellId) ? TConstArrayView<uint32>(Cells[CellId].NeighborCellIds) : TConstArrayView<uint32>();
+	}
+
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid")
 	int32 FindCellAtPosition(const FVector& Position) const;
 
+	/** Cell hit by a ray against the grid sphere, in grid space (sphere centered on the origin), INDEX_NONE on a miss */
+	UFUNCTION(BlueprintCallable, Category = "Hex Grid")
+	int32 FindCellAlongRay(const FVector& RayOrigin, const FVector& RayDirection, float SphereRadius, FVector& OutHitPosition) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid")
 	void FindClosestCells(const FVector& Position, TArray<int32>& outCells, int32 Count = 3) const;
 
@@ -62,10 +75,35 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid")
 	const TArray<int32>& GetPentagons() const;
 
+	/** Number of steps from every cell to the nearest source, and the neighbor to step to (multi-source BFS) */
+	UFUNCTION(BlueprintCallable, Category = "Hex Grid")
+	void ComputeDistanceField(const TArray<int32>& SourceCellIds, TArray<int32>& OutDistances, TArray<int32>& OutNextCellIds) const;
+
+	/** Check ids, neighbor count and symmetry, pentagon count, vertex winding and normalization in one parallel pass.
+	 *  Only the first MaxReportedErrors failures (in cell order) are formatted into outErrors. */
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid")
-	bool ValidateGrid(TArray<FString>& outErrors) const;
+	bool ValidateGrid(TArray<FString>& outErrors, int32 MaxReportedErrors = 100) const;
 
 	void CalculateStatistics();
 
 	static int32 GetExpectedCellCount(int32 Level);
+
+	/** Runtime data derived from the cells, acquired on first use from FHexGridRuntimeCache and shared by every
+	 *  asset with the same cells. Null for an empty grid */
+	FHexGridRuntimePtr GetRuntime() const;
+
+	/** Point location index of the runtime, the grid must not be empty. Only valid until the runtime is released
+	 *  (InvalidateRuntimeData, cells changed): for single game thread queries, hold GetRuntime() for longer work */
+	const FHexSpatialIndex& GetSpatialIndex() const;
+
+	/** Per-cell areas, centroids, edge lengths and tangent frames of the runtime, the grid must not be empty.
+	 *  Same lifetime as GetSpatialIndex */
+	const FHexGridGeometry& GetGeometry() const;
+
+	/** Release the runtime data after the cells changed */
+	void InvalidateRuntimeData();
+
+private:
+	mutable FHexGridRuntimePtr Runtime;
+	mutable FCriticalSection RuntimeDataLock;
 };
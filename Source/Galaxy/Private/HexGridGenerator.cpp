@@ -500,6 +500,22 @@ void UHexGridGenerator::AssignIcosahedronFaces(UHexGridAsset* grid)
 	}
 }
 
+void UHexGridGenerator::GetIcosahedronFaceCorners(int32 faceIndex, FVector& outA, FVector& outB, FVector& outC)
+{
+	static const FTriangleMesh icosahedron = []()
+		{
+			FTriangleMesh mesh;
+			CreateIcosahedron(mesh);
+			return mesh;
+		}();
+
+	int32 v0, v1, v2;
+	icosahedron.GetTriangle(FMath::Clamp(faceIndex, 0, icosahedron.GetTriangleCount() - 1), v0, v1, v2);
+	outA = icosahedron.Vertices[v0];
+	outB = icosahedron.Vertices[v1];
+	outC = icosahedron.Vertices[v2];
+}
+
 float UHexGridGenerator::SphericalAngle(const FVector& center, const FVector& p1, const FVector& p2)
 {
 	FVector v1 = (p1 - center * FVector::DotProduct(p1, center)).GetSafeNormal();
@@ -69,6 +69,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid Generation")
 	static bool PopulateHexGridAsset(UHexGridAsset* hexGrid, int32 level, TArray<FString>& OutErrors);
 
+	/// <summary>
+	/// Get the three corners (on the unit sphere) of one of the 20 base icosahedron faces
+	/// Face indices match FHexCell::IcosaheronFaceIndex
+	/// </summary>
+	/// <param name="faceIndex">Icosahedron face index (0-19)</param>
+	/// <param name="outA">First corner</param>
+	/// <param name="outB">Second corner</param>
+	/// <param name="outC">Third corner</param>
+	static void GetIcosahedronFaceCorners(int32 faceIndex, FVector& outA, FVector& outB, FVector& outC);
+
 private:
 	// === Generation Pipeline ===
 
@@ -0,0 +1,109 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexGridGeometry.h"
+#include "HexGridAsset.h"
+#include "Async/ParallelFor.h"
+
+void FHexGridGeometry::Build(const UHexGridAsset& grid)
+{
+	const int32 cellCount = grid.Cells.Num();
+
+	CellAreas.SetNumUninitialized(cellCount);
+	Centroids.SetNumUninitialized(cellCount);
+	EdgeLengths.SetNumZeroed(cellCount * MaxNeighbors);
+	TangentsEast.SetNumUninitialized(cellCount);
+	TangentsNorth.SetNumUninitialized(cellCount);
+
+	ParallelFor(cellCount, [&](int32 cellId)
+		{
+			ComputeCell(grid, cellId);
+		});
+}
+
+double FHexGridGeometry::ComputeSphericalPolygonArea(const FVector& center, TConstArrayView<FVector> vertices)
+{
+	double area = 0.0;
+	for (int32 i = 0; i < vertices.Num(); ++i)
+	{
+		const FVector& next = vertices[(i + 1) % vertices.Num()];
+		area += ComputeSphericalTriangleArea(center, vertices[i].GetSafeNormal(), next.GetSafeNormal());
+	}
+
+	return area;
+}
+
+double FHexGridGeometry::ComputeSphericalTriangleArea(const FVector& a, const FVector& b, const FVector& c)
+{
+	// tan(E / 2) = |a . (b x c)| / (1 + a.b + b.c + c.a)
+	const double tripleProduct = FMath::Abs(FVector::DotProduct(a, FVector::CrossProduct(b, c)));
+	const double denominator = 1.0 + FVector::DotProduct(a, b) + FVector::DotProduct(b, c) + FVector::DotProduct(c, a);
+
+	return 2.0 * FMath::Atan2(tripleProduct, denominator);
+}
+
+void FHexGridGeometry::ComputeCell(const UHexGridAsset& grid, int32 cellId)
+{
+	const FHexCell& cell = grid.Cells[cellId];
+	const FVector normal = cell.Position.GetSafeNormal();
+	const int32 vertexCount = cell.Vertices.Num();
+
+	// Area and area weighted centroid from the fan of spherical triangles around the center
+	double area = 0.0;
+	FVector centroid = FVector::ZeroVector;
+	for (int32 i = 0; i < vertexCount; ++i)
+	{
+		const FVector v1 = cell.Vertices[i].GetSafeNormal();
+		const FVector v2 = cell.Vertices[(i + 1) % vertexCount].GetSafeNormal();
+
+		double triangleArea = ComputeSphericalTriangleArea(normal, v1, v2);
+		area += triangleArea;
+		centroid += (normal + v1 + v2).GetSafeNormal() * triangleArea;
+	}
+
+	CellAreas[cellId] = static_cast<float>(area);
+	Centroids[cellId] = FVector3f(area > 0.0 ? centroid.GetSafeNormal() : normal);
+
+	// Edge shared with each neighbor: the two vertices both cells have in common
+	const int32 neighborCount = FMath::Min(cell.NeighborCellIds.Num(), MaxNeighbors);
+	for (int32 slot = 0; slot < neighborCount; ++slot)
+	{
+		const FHexCell& neighbor = grid.Cells[cell.NeighborCellIds[slot]];
+
+		FVector shared[2];
+		int32 sharedCount = 0;
+		for (const FVector& vertex : cell.Vertices)
+		{
+			for (const FVector& otherVertex : neighbor.Vertices)
+			{
+				if (vertex.Equals(otherVertex, KINDA_SMALL_NUMBER))
+				{
+					shared[sharedCount++] = vertex.GetSafeNormal();
+					break;
+				}
+			}
+
+			if (sharedCount == 2)
+			{
+				break;
+			}
+		}
+
+		if (sharedCount == 2)
+		{
+			const double cosAngle = FMath::Clamp(FVector::DotProduct(shared[0], shared[1]), -1.0, 1.0);
+			EdgeLengths[cellId * MaxNeighbors + slot] = static_cast<float>(FMath::Acos(cosAngle));
+		}
+	}
+
+	// Tangent frame aligned with the world Z axis, any axis works at the poles
+	FVector east = FVector::CrossProduct(FVector::UpVector, normal);
+	if (east.IsNearlyZero())
+	{
+		east = FVector::CrossProduct(FVector::ForwardVector, normal);
+	}
+	east.Normalize();
+
+	TangentsEast[cellId] = FVector3f(east);
+	TangentsNorth[cellId] = FVector3f(FVector::CrossProduct(normal, east));
+}
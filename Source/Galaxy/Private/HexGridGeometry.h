@@ -0,0 +1,73 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UHexGridAsset;
+
+/// <summary>
+/// Derived per-cell geometry of a hex grid, computed once on the unit sphere.
+/// Scale areas by R^2 and lengths by R for a sphere of radius R.
+///
+/// Edge data uses MaxNeighbors slots per cell, slot k is the edge shared with Cells[id].NeighborCellIds[k].
+/// Unused slots (pentagons) have a length of 0.
+/// </summary>
+class GALAXY_API FHexGridGeometry
+{
+public:
+	static constexpr int32 MaxNeighbors = 6;
+
+	/// <summary>
+	/// Compute the geometry of every cell, in parallel
+	/// </summary>
+	void Build(const UHexGridAsset& grid);
+
+	bool IsValid() const { return CellAreas.Num() > 0; }
+	int32 GetCellCount() const { return CellAreas.Num(); }
+
+	/// <summary>
+	/// Exact spherical area of every cell (spherical excess), in steradians
+	/// </summary>
+	TConstArrayView<float> GetCellAreas() const { return CellAreas; }
+
+	/// <summary>
+	/// Area weighted centroid of every cell, on the unit sphere
+	/// </summary>
+	TConstArrayView<FVector3f> GetCentroids() const { return Centroids; }
+
+	/// <summary>
+	/// Great-circle length of every edge, MaxNeighbors slots per cell
+	/// </summary>
+	TConstArrayView<float> GetEdgeLengths() const { return EdgeLengths; }
+
+	/// <summary>
+	/// Local tangent frame of every cell: East and North span the tangent plane, the normal is the cell position
+	/// </summary>
+	TConstArrayView<FVector3f> GetTangentsEast() const { return TangentsEast; }
+	TConstArrayView<FVector3f> GetTangentsNorth() const { return TangentsNorth; }
+
+	float GetCellArea(int32 cellId, float sphereRadius = 1.0f) const { return CellAreas[cellId] * sphereRadius * sphereRadius; }
+	float GetEdgeLength(int32 cellId, int32 slot, float sphereRadius = 1.0f) const { return EdgeLengths[cellId * MaxNeighbors + slot] * sphereRadius; }
+	TConstArrayView<float> GetCellEdgeLengths(int32 cellId) const { return TConstArrayView<float>(EdgeLengths.GetData() + cellId * MaxNeighbors, MaxNeighbors); }
+
+	/// <summary>
+	/// Exact area of a spherical polygon on the unit sphere, triangulated from its center
+	/// </summary>
+	static double ComputeSphericalPolygonArea(const FVector& center, TConstArrayView<FVector> vertices);
+
+	/// <summary>
+	/// Area of the spherical triangle between three unit vectors (Van Oosterom and Strackee)
+	/// </summary>
+	static double ComputeSphericalTriangleArea(const FVector& a, const FVector& b, const FVector& c);
+
+private:
+	void ComputeCell(const UHexGridAsset& grid, int32 cellId);
+
+	TArray<float> CellAreas;
+	TArray<FVector3f> Centroids;
+	TArray<float> EdgeLengths;
+	TArray<FVector3f> TangentsEast;
+	TArray<FVector3f> TangentsNorth;
+};
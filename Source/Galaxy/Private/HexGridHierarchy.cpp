@@ -0,0 +1,235 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexGridHierarchy.h"
+#include "HexSpatialIndex.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+
+bool UHexGridHierarchy::Build(UHexGridAsset* InFineGrid, UHexGridAsset* InCoarseGrid)
+{
+	ParentCellIds.Reset();
+	ChildOffsets.Reset();
+	ChildCellIds.Reset();
+	FineGrid = InFineGrid;
+	CoarseGrid = InCoarseGrid;
+
+	if (!FineGrid || !CoarseGrid || CoarseGrid->Cells.Num() == 0 || FineGrid->Cells.Num() < CoarseGrid->Cells.Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT("UHexGridHierarchy::Build - Needs a fine grid with more cells than the coarse grid."));
+		return false;
+	}
+
+	const int32 fineCount = FineGrid->Cells.Num();
+	const int32 coarseCount = CoarseGrid->Cells.Num();
+
+	// Parent of every fine cell
+	const FHexGridRuntimePtr coarseRuntime = CoarseGrid->GetRuntime();
+	const FHexSpatialIndex& coarseIndex = coarseRuntime->GetSpatialIndex();
+	ParentCellIds.SetNumUninitialized(fineCount);
+	ParallelFor(fineCount, [&](int32 fineCellId)
+		{
+			ParentCellIds[fineCellId] = coarseIndex.FindCell(FineGrid->Cells[fineCellId].Position);
+		});
+
+	// Counting sort of the fine cells by parent, empty coarse cells get the nearest fine cell as a sample
+	const FHexGridRuntimePtr fineRuntime = FineGrid->GetRuntime();
+	const FHexSpatialIndex& fineIndex = fineRuntime->GetSpatialIndex();
+	TArray<int32> childCounts;
+	childCounts.SetNumZeroed(coarseCount);
+	for (int32 parentId : ParentCellIds)
+	{
+		++childCounts[parentId];
+	}
+
+	TArray<int32> samples;
+	samples.Init(INDEX_NONE, coarseCount);
+	for (int32 coarseCellId = 0; coarseCellId < coarseCount; ++coarseCellId)
+	{
+		if (childCounts[coarseCellId] == 0)
+		{
+			samples[coarseCellId] = fineIndex.FindCell(CoarseGrid->Cells[coarseCellId].Position);
+			childCounts[coarseCellId] = 1;
+		}
+	}
+
+	ChildOffsets.SetNumUninitialized(coarseCount + 1);
+	ChildOffsets[0] = 0;
+	for (int32 coarseCellId = 0; coarseCellId < coarseCount; ++coarseCellId)
+	{
+		ChildOffsets[coarseCellId + 1] = ChildOffsets[coarseCellId] + childCounts[coarseCellId];
+	}
+
+	ChildCellIds.SetNumUninitialized(ChildOffsets[coarseCount]);
+	TArray<int32> cursors(ChildOffsets.GetData(), coarseCount);
+	for (int32 fineCellId = 0; fineCellId < fineCount; ++fineCellId)
+	{
+		ChildCellIds[cursors[ParentCellIds[fineCellId]]++] = fineCellId;
+	}
+
+	for (int32 coarseCellId = 0; coarseCellId < coarseCount; ++coarseCellId)
+	{
+		if (samples[coarseCellId] != INDEX_NONE)
+		{
+			ChildCellIds[cursors[coarseCellId]++] = samples[coarseCellId];
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("UHexGridHierarchy::Build - Mapped %d fine cells to %d coarse cells."), fineCount, coarseCount);
+	return true;
+}
+
+bool UHexGridHierarchy::IsBuilt() const
+{
+	return FineGrid && CoarseGrid
+		&& ParentCellIds.Num() == FineGrid->Cells.Num()
+		&& ChildOffsets.Num() == CoarseGrid->Cells.Num() + 1;
+}
+
+int32 UHexGridHierarchy::GetParentCell(int32 FineCellId) const
+{
+	return ParentCellIds.IsValidIndex(FineCellId) ? ParentCellIds[FineCellId] : INDEX_NONE;
+}
+
+void UHexGridHierarchy::GetChildCells(int32 CoarseCellId, TArray<int32>& OutChildCellIds) const
+{
+	OutChildCellIds.Reset();
+	OutChildCellIds.Append(GetChildView(CoarseCellId));
+}
+
+TConstArrayView<int32> UHexGridHierarchy::GetChildView(int32 coarseCellId) const
+{
+	if (coarseCellId < 0 || coarseCellId + 1 >= ChildOffsets.Num())
+	{
+		return TConstArrayView<int32>();
+	}
+
+	const int32 begin = ChildOffsets[coarseCellId];
+	return TConstArrayView<int32>(ChildCellIds.GetData() + begin, ChildOffsets[coarseCellId + 1] - begin);
+}
+
+void UHexGridHierarchy::Downsample(TConstArrayView<float> fineValues, EHexLayerAggregation aggregation, TArray<float>& outCoarseValues) const
+{
+	const int32 coarseCount = ChildOffsets.Num() - 1;
+	if (coarseCount <= 0 || fineValues.Num() != ParentCellIds.Num())
+	{
+		outCoarseValues.Reset();
+		return;
+	}
+
+	outCoarseValues.SetNumUninitialized(coarseCount);
+	ParallelFor(coarseCount, [&](int32 coarseCellId)
+		{
+			TConstArrayView<int32> children = GetChildView(coarseCellId);
+			float result = fineValues[children[0]];
+
+			switch (aggregation)
+			{
+			case EHexLayerAggregation::Mean:
+			{
+				double sum = 0.0;
+				for (int32 childId : children)
+				{
+					sum += fineValues[childId];
+				}
+				result = static_cast<float>(sum / children.Num());
+				break;
+			}
+			case EHexLayerAggregation::Min:
+				for (int32 childId : children)
+				{
+					result = FMath::Min(result, fineValues[childId]);
+				}
+				break;
+			case EHexLayerAggregation::Max:
+				for (int32 childId : children)
+				{
+					result = FMath::Max(result, fineValues[childId]);
+				}
+				break;
+			case EHexLayerAggregation::Mode:
+			{
+				// Longest run of equal values once sorted, ties go to the smallest value
+				TArray<float, TInlineAllocator<64>> sorted;
+				for (int32 childId : children)
+				{
+					sorted.Add(fineValues[childId]);
+				}
+				Algo::Sort(sorted);
+
+				int32 bestRun = 0;
+				for (int32 runStart = 0; runStart < sorted.Num();)
+				{
+					int32 runEnd = runStart + 1;
+					while (runEnd < sorted.Num() && sorted[runEnd] == sorted[runStart])
+					{
+						++runEnd;
+					}
+
+					if (runEnd - runStart > bestRun)
+					{
+						bestRun = runEnd - runStart;
+						result = sorted[runStart];
+					}
+					runStart = runEnd;
+				}
+				break;
+			}
+			}
+
+			outCoarseValues[coarseCellId] = result;
+		});
+}
+
+void UHexGridHierarchy::Upsample(TConstArrayView<float> coarseValues, TArray<float>& outFineValues) const
+{
+	if (coarseValues.Num() != ChildOffsets.Num() - 1)
+	{
+		outFineValues.Reset();
+		return;
+	}
+
+	outFineValues.SetNumUninitialized(ParentCellIds.Num());
+	ParallelFor(ParentCellIds.Num(), [&](int32 fineCellId)
+		{
+			outFineValues[fineCellId] = coarseValues[ParentCellIds[fineCellId]];
+		});
+}
+
+bool UHexGridHierarchy::DownsampleLayer(const UPlanetData* FinePlanet, UPlanetData* CoarsePlanet, EPlanetDataLayer Layer, EHexLayerAggregation Aggregation) const
+{
+	if (!IsBuilt() || !FinePlanet || !CoarsePlanet || FinePlanet->Grid != FineGrid || CoarsePlanet->Grid != CoarseGrid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UHexGridHierarchy::DownsampleLayer - Planets do not match the hierarchy grids."));
+		return false;
+	}
+
+	TArray<float> fineValues;
+	TArray<float> coarseValues;
+	if (!FinePlanet->GetLayerValues(Layer, fineValues))
+	{
+		return false;
+	}
+
+	Downsample(fineValues, Aggregation, coarseValues);
+	return CoarsePlanet->SetLayerValues(Layer, coarseValues);
+}
+
+bool UHexGridHierarchy::UpsampleLayer(const UPlanetData* CoarsePlanet, UPlanetData* FinePlanet, EPlanetDataLayer Layer) const
+{
+	if (!IsBuilt() || !FinePlanet || !CoarsePlanet || FinePlanet->Grid != FineGrid || CoarsePlanet->Grid != CoarseGrid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UHexGridHierarchy::UpsampleLayer - Planets do not match the hierarchy grids."));
+		return false;
+	}
+
+	TArray<float> coarseValues;
+	TArray<float> fineValues;
+	if (!CoarsePlanet->GetLayerValues(Layer, coarseValues))
+	{
+		return false;
+	}
+
+	Upsample(coarseValues, fineValues);
+	return FinePlanet->SetLayerValues(Layer, fineValues);
+}
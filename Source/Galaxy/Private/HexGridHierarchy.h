@@ -0,0 +1,88 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "HexGridAsset.h"
+#include "PlanetData.h"
+#include "HexGridHierarchy.generated.h"
+
+/// <summary>
+/// How the values of the fine cells covered by a coarse cell are combined
+/// </summary>
+UENUM(BlueprintType)
+enum class EHexLayerAggregation : uint8
+{
+	Mean	UMETA(DisplayName = "Mean"),
+	Min		UMETA(DisplayName = "Min"),
+	Max		UMETA(DisplayName = "Max"),
+	Mode	UMETA(DisplayName = "Mode (most frequent)"),
+};
+
+/// <summary>
+/// Mapping between a fine and a coarse hex grid, used to summarize simulation layers for rendering and AI.
+///
+/// Each fine cell belongs to the coarse cell containing its center, children of every coarse cell are
+/// stored contiguously (CSR), so downsampling and upsampling are single parallel passes.
+/// A coarse cell containing no fine center samples the fine cell nearest to its own center.
+/// </summary>
+UCLASS(BlueprintType)
+class GALAXY_API UHexGridHierarchy : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid Hierarchy")
+	TObjectPtr<UHexGridAsset> FineGrid;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid Hierarchy")
+	TObjectPtr<UHexGridAsset> CoarseGrid;
+
+	/** Compute the parent/child mapping between two grids, the fine grid must have more cells than the coarse one */
+	UFUNCTION(BlueprintCallable, Category = "Grid Hierarchy")
+	bool Build(UHexGridAsset* InFineGrid, UHexGridAsset* InCoarseGrid);
+
+	UFUNCTION(BlueprintCallable, Category = "Grid Hierarchy")
+	bool IsBuilt() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Grid Hierarchy")
+	int32 GetParentCell(int32 FineCellId) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Grid Hierarchy")
+	void GetChildCells(int32 CoarseCellId, TArray<int32>& OutChildCellIds) const;
+
+	/** Aggregate a layer of the fine planet into the same layer of the coarse planet */
+	UFUNCTION(BlueprintCallable, Category = "Grid Hierarchy")
+	bool DownsampleLayer(const UPlanetData* FinePlanet, UPlanetData* CoarsePlanet, EPlanetDataLayer Layer, EHexLayerAggregation Aggregation) const;
+
+	/** Copy a layer of the coarse planet to every child cell of the fine planet */
+	UFUNCTION(BlueprintCallable, Category = "Grid Hierarchy")
+	bool UpsampleLayer(const UPlanetData* CoarsePlanet, UPlanetData* FinePlanet, EPlanetDataLayer Layer) const;
+
+	TConstArrayView<int32> GetParentCellIds() const { return ParentCellIds; }
+	TConstArrayView<int32> GetChildView(int32 coarseCellId) const;
+
+	/// <summary>
+	/// Aggregate one value per fine cell into one value per coarse cell, in parallel
+	/// </summary>
+	void Downsample(TConstArrayView<float> fineValues, EHexLayerAggregation aggregation, TArray<float>& outCoarseValues) const;
+
+	/// <summary>
+	/// Give every fine cell the value of its parent, in parallel
+	/// </summary>
+	void Upsample(TConstArrayView<float> coarseValues, TArray<float>& outFineValues) const;
+
+private:
+	/** Coarse cell of every fine cell */
+	UPROPERTY()
+	TArray<int32> ParentCellIds;
+
+	/** Children of coarse cell i are ChildCellIds[ChildOffsets[i] .. ChildOffsets[i + 1]) */
+	UPROPERTY()
+	TArray<int32> ChildOffsets;
+
+	UPROPERTY()
+	TArray<int32> ChildCellIds;
+};
@@ -0,0 +1,87 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexGridIterators.h"
+
+FHexLineIterator::FHexLineIterator(const UHexGridAsset& grid, int32 fromCellId, int32 toCellId)
+	: Grid(grid)
+{
+	if (Grid.Cells.IsValidIndex(fromCellId) && Grid.Cells.IsValidIndex(toCellId))
+	{
+		Setup(fromCellId, Grid.Cells[fromCellId].Position, Grid.Cells[toCellId].Position);
+	}
+}
+
+FHexLineIterator::FHexLineIterator(const UHexGridAsset& grid, const FVector& fromPosition, const FVector& toPosition)
+	: Grid(grid)
+{
+	int32 fromCellId = Grid.FindCellAtPosition(fromPosition);
+	if (fromCellId != INDEX_NONE && !fromPosition.IsNearlyZero() && !toPosition.IsNearlyZero())
+	{
+		Setup(fromCellId, fromPosition, toPosition);
+	}
+}
+
+void FHexLineIterator::Setup(int32 fromCellId, const FVector& fromDirection, const FVector& toDirection)
+{
+	Origin = fromDirection.GetSafeNormal();
+	FVector target = toDirection.GetSafeNormal();
+
+	double cosAngle = FMath::Clamp(FVector::DotProduct(Origin, target), -1.0, 1.0);
+	ArcAngle = FMath::Acos(cosAngle);
+
+	// Tangent of the arc at the origin, any direction works for antipodal points
+	Tangent = (target - Origin * cosAngle).GetSafeNormal();
+	if (Tangent.IsNearlyZero())
+	{
+		FVector unused;
+		Origin.FindBestAxisVectors(Tangent, unused);
+	}
+
+	CurrentAngle = 0.0;
+	CurrentCellId = fromCellId;
+	StepsLeft = Grid.Cells.Num();
+}
+
+FHexLineIterator& FHexLineIterator::operator++()
+{
+	if (CurrentCellId == INDEX_NONE)
+	{
+		return *this;
+	}
+
+	// Arc point P(t) = cos(t) * Origin + sin(t) * Tangent leaves the current cell C for neighbor N
+	// when dot(P(t), N - C) becomes positive: a * cos(t) + b * sin(t) rises through 0 at t = atan2(b, a) - PI / 2
+	const FVector& center = Grid.Cells[CurrentCellId].Position;
+
+	double bestAngle = MAX_dbl;
+	int32 bestCellId = INDEX_NONE;
+	for (uint32 neighborId : Grid.GetNeighborView(CurrentCellId))
+	{
+		FVector delta = Grid.Cells[neighborId].Position - center;
+		double a = FVector::DotProduct(Origin, delta);
+		double b = FVector::DotProduct(Tangent, delta);
+
+		double angle = FMath::Atan2(b, a) - UE_DOUBLE_HALF_PI;
+		while (angle <= CurrentAngle + UE_DOUBLE_KINDA_SMALL_NUMBER)
+		{
+			angle += UE_DOUBLE_TWO_PI;
+		}
+
+		if (angle < bestAngle)
+		{
+			bestAngle = angle;
+			bestCellId = static_cast<int32>(neighborId);
+		}
+	}
+
+	if (bestCellId == INDEX_NONE || bestAngle > ArcAngle || --StepsLeft <= 0)
+	{
+		CurrentCellId = INDEX_NONE;
+		return *this;
+	}
+
+	CurrentCellId = bestCellId;
+	CurrentAngle = bestAngle;
+	return *this;
+}
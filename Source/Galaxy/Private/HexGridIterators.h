@@ -0,0 +1,193 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HexGridAsset.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+/// <summary>
+/// Builds the rings of cells around a center cell one after the other, keeping only the last two rings.
+/// Distances are exact hop counts on the cell graph (pentagons included).
+/// All storage lives inline, rings larger than 6 * MaxRadius cells cannot be built.
+/// </summary>
+template<int32 MaxRadius>
+class THexRingWalker
+{
+public:
+	static_assert(MaxRadius >= 0, "MaxRadius must be positive");
+	static constexpr int32 MaxRingSize = MaxRadius > 0 ? 6 * MaxRadius : 1;
+	using FRing = TArray<int32, TFixedAllocator<MaxRingSize>>;
+
+	THexRingWalker(const UHexGridAsset& inGrid, int32 centerCellId)
+		: Grid(inGrid)
+	{
+		if (centerCellId >= 0 && centerCellId < Grid.Cells.Num())
+		{
+			Current.Add(centerCellId);
+		}
+	}
+
+	/// <summary>
+	/// Move to the next ring, returns false when the ring is empty or MaxRadius is reached
+	/// </summary>
+	bool Advance()
+	{
+		if (Current.Num() == 0 || Radius >= MaxRadius)
+		{
+			Previous.Reset();
+			Current.Reset();
+			return false;
+		}
+
+		// Neighbors of ring k are at distance k-1, k or k+1, rings k-1 and k are kept sorted
+		Next.Reset();
+		for (int32 cellId : Current)
+		{
+			for (uint32 neighborId : Grid.GetNeighborView(cellId))
+			{
+				const int32 neighbor = static_cast<int32>(neighborId);
+				if (Algo::BinarySearch(Current, neighbor) != INDEX_NONE
+					|| Algo::BinarySearch(Previous, neighbor) != INDEX_NONE
+					|| Next.Contains(neighbor))
+				{
+					continue;
+				}
+
+				Next.Add(neighbor);
+			}
+		}
+
+		Algo::Sort(Next);
+		Previous = Current;
+		Current = Next;
+		++Radius;
+
+		return Current.Num() > 0;
+	}
+
+	const FRing& GetRing() const { return Current; }
+	int32 GetRadius() const { return Radius; }
+
+private:
+	const UHexGridAsset& Grid;
+	FRing Previous;
+	FRing Current;
+	FRing Next;
+	int32 Radius = 0;
+};
+
+/// <summary>
+/// Iterate the cells at exactly hex distance Radius from a center cell, without heap allocations.
+///
+/// for (THexRingIterator<> It(*Grid, CellId, 3); It; ++It) { int32 cellId = *It; }
+/// </summary>
+template<int32 MaxRadius = 16>
+class THexRingIterator
+{
+public:
+	THexRingIterator(const UHexGridAsset& grid, int32 centerCellId, int32 radius)
+		: Walker(grid, centerCellId)
+	{
+		ensureMsgf(radius <= MaxRadius, TEXT("THexRingIterator: radius %d is above MaxRadius %d"), radius, MaxRadius);
+
+		while (Walker.GetRadius() < radius && Walker.Advance())
+		{
+		}
+
+		if (Walker.GetRadius() != radius)
+		{
+			Index = Walker.GetRing().Num();
+		}
+	}
+
+	explicit operator bool() const { return Index < Walker.GetRing().Num(); }
+	int32 operator*() const { return Walker.GetRing()[Index]; }
+	THexRingIterator& operator++() { ++Index; return *this; }
+
+	/// <summary>
+	/// Number of cells in the ring
+	/// </summary>
+	int32 Num() const { return Walker.GetRing().Num(); }
+
+private:
+	THexRingWalker<MaxRadius> Walker;
+	int32 Index = 0;
+};
+
+/// <summary>
+/// Iterate the cells around a center cell, ring by ring from the center out to Radius, without heap allocations.
+///
+/// for (THexSpiralIterator<> It(*Grid, CellId, 3); It; ++It) { int32 cellId = *It; int32 ring = It.GetRadius(); }
+/// </summary>
+template<int32 MaxRadius = 16>
+class THexSpiralIterator
+{
+public:
+	THexSpiralIterator(const UHexGridAsset& grid, int32 centerCellId, int32 radius)
+		: Walker(grid, centerCellId)
+		, MaxRing(FMath::Min(radius, MaxRadius))
+	{
+		ensureMsgf(radius <= MaxRadius, TEXT("THexSpiralIterator: radius %d is above MaxRadius %d"), radius, MaxRadius);
+	}
+
+	explicit operator bool() const { return Index < Walker.GetRing().Num(); }
+	int32 operator*() const { return Walker.GetRing()[Index]; }
+
+	THexSpiralIterator& operator++()
+	{
+		++Index;
+		if (Index >= Walker.GetRing().Num() && Walker.GetRadius() < MaxRing && Walker.Advance())
+		{
+			Index = 0;
+		}
+		return *this;
+	}
+
+	/// <summary>
+	/// Distance of the current cell from the center
+	/// </summary>
+	int32 GetRadius() const { return Walker.GetRadius(); }
+
+private:
+	THexRingWalker<MaxRadius> Walker;
+	int32 MaxRing = 0;
+	int32 Index = 0;
+};
+
+/// <summary>
+/// Iterate the cells crossed by the great-circle arc between two points, in order, without heap allocations.
+///
+/// The arc is walked cell by cell: from the current cell, the next one is the neighbor whose center
+/// becomes closer to the arc point first, solved analytically along the arc angle.
+/// </summary>
+class GALAXY_API FHexLineIterator
+{
+public:
+	/// <summary>
+	/// Arc between two cell centers
+	/// </summary>
+	FHexLineIterator(const UHexGridAsset& grid, int32 fromCellId, int32 toCellId);
+
+	/// <summary>
+	/// Arc between two positions, given relative to the sphere center (any length)
+	/// </summary>
+	FHexLineIterator(const UHexGridAsset& grid, const FVector& fromPosition, const FVector& toPosition);
+
+	explicit operator bool() const { return CurrentCellId != INDEX_NONE; }
+	int32 operator*() const { return CurrentCellId; }
+	FHexLineIterator& operator++();
+
+private:
+	void Setup(int32 fromCellId, const FVector& fromDirection, const FVector& toDirection);
+
+	const UHexGridAsset& Grid;
+	FVector Origin = FVector::ZeroVector;
+	FVector Tangent = FVector::ZeroVector;
+	double ArcAngle = 0.0;
+	double CurrentAngle = 0.0;
+	int32 CurrentCellId = INDEX_NONE;
+	int32 StepsLeft = 0;
+};
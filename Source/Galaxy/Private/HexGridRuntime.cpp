@@ -0,0 +1,162 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexGridRuntime.h"
+#include "HexGridAsset.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	using FWeakRuntime = TWeakPtr<const FHexGridRuntime, ESPMode::ThreadSafe>;
+
+	FCriticalSection& GetCacheLock()
+	{
+		static FCriticalSection lock;
+		return lock;
+	}
+
+	/** Runtimes by topology hash, several per hash on collisions */
+	TMultiMap<uint32, FWeakRuntime>& GetCacheEntries()
+	{
+		static TMultiMap<uint32, FWeakRuntime> entries;
+		return entries;
+	}
+}
+
+FHexGridRuntime::FHexGridRuntime(const UHexGridAsset& grid)
+{
+	const int32 cellCount = grid.Cells.Num();
+
+	Positions.SetNumUninitialized(cellCount);
+	NeighborOffsets.SetNumUninitialized(cellCount + 1);
+	CellFaces.SetNumUninitialized(cellCount);
+	FaceCells.SetNum(IcosahedronFaceCount);
+
+	int32 neighborCount = 0;
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		NeighborOffsets[cellId] = neighborCount;
+		neighborCount += grid.Cells[cellId].NeighborCellIds.Num();
+	}
+	NeighborOffsets[cellCount] = neighborCount;
+
+	Neighbors.Reserve(neighborCount);
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		const FHexCell& cell = grid.Cells[cellId];
+		// Asset positions can be off the unit sphere (UHexGridAsset validation only reports it)
+		Positions[cellId] = cell.Position.GetSafeNormal();
+		Neighbors.Append(cell.NeighborCellIds);
+
+		const uint8 faceIndex = static_cast<uint8>(FMath::Min<int32>(cell.IcosaheronFaceIndex, IcosahedronFaceCount - 1));
+		CellFaces[cellId] = faceIndex;
+		FaceCells[faceIndex].Add(cellId);
+	}
+
+	SpatialIndex.Build(*this);
+	Geometry.Build(grid);
+	TopologyHash = ComputeTopologyHash(grid);
+}
+
+bool FHexGridRuntime::HasSameTopology(const UHexGridAsset& grid) const
+{
+	if (grid.Cells.Num() != Positions.Num())
+	{
+		return false;
+	}
+
+	for (int32 cellId = 0; cellId < Positions.Num(); ++cellId)
+	{
+		const FHexCell& cell = grid.Cells[cellId];
+		const TConstArrayView<uint32> neighbors = GetNeighbors(cellId);
+		if (cell.Position.GetSafeNormal() != Positions[cellId]
+			|| FMath::Min<int32>(cell.IcosaheronFaceIndex, IcosahedronFaceCount - 1) != CellFaces[cellId]
+			|| cell.NeighborCellIds.Num() != neighbors.Num()
+			|| FMemory::Memcmp(cell.NeighborCellIds.GetData(), neighbors.GetData(), neighbors.Num() * sizeof(uint32)) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint32 FHexGridRuntime::ComputeTopologyHash(const UHexGridAsset& grid)
+{
+	uint32 hash = GetTypeHash(grid.Cells.Num());
+	for (const FHexCell& cell : grid.Cells)
+	{
+		hash = HashCombineFast(hash, GetTypeHash(cell.Position.GetSafeNormal()));
+		hash = HashCombineFast(hash, FCrc::MemCrc32(cell.NeighborCellIds.GetData(), cell.NeighborCellIds.Num() * sizeof(uint32)));
+		hash = HashCombineFast(hash, cell.IcosaheronFaceIndex);
+	}
+	return hash;
+}
+
+FHexGridRuntimePtr FHexGridRuntimeCache::Acquire(const UHexGridAsset& grid)
+{
+	if (grid.Cells.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const uint32 hash = FHexGridRuntime::ComputeTopologyHash(grid);
+
+	{
+		FScopeLock lock(&GetCacheLock());
+		TMultiMap<uint32, FWeakRuntime>& entries = GetCacheEntries();
+
+		TArray<FWeakRuntime, TInlineAllocator<2>> candidates;
+		entries.MultiFind(hash, candidates);
+		for (const FWeakRuntime& candidate : candidates)
+		{
+			FHexGridRuntimePtr runtime = candidate.Pin();
+			if (runtime.IsValid() && runtime->HasSameTopology(grid))
+			{
+				return runtime;
+			}
+		}
+	}
+
+	// Build outside the lock, other grids can be acquired meanwhile
+	FHexGridRuntimePtr built = MakeShared<const FHexGridRuntime, ESPMode::ThreadSafe>(grid);
+
+	FScopeLock lock(&GetCacheLock());
+	TMultiMap<uint32, FWeakRuntime>& entries = GetCacheEntries();
+
+	// Another thread may have built the same topology first, keep a single shared copy
+	TArray<FWeakRuntime, TInlineAllocator<2>> candidates;
+	entries.MultiFind(hash, candidates);
+	for (const FWeakRuntime& candidate : candidates)
+	{
+		FHexGridRuntimePtr runtime = candidate.Pin();
+		if (runtime.IsValid() && runtime->HasSameTopology(grid))
+		{
+			return runtime;
+		}
+	}
+
+	// Drop the runtimes nobody holds anymore
+	for (auto It = entries.CreateIterator(); It; ++It)
+	{
+		if (!It->Value.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	entries.Add(hash, built);
+	return built;
+}
+
+int32 FHexGridRuntimeCache::GetLiveRuntimeCount()
+{
+	FScopeLock lock(&GetCacheLock());
+
+	int32 count = 0;
+	for (const TPair<uint32, FWeakRuntime>& entry : GetCacheEntries())
+	{
+		count += entry.Value.IsValid() ? 1 : 0;
+	}
+	return count;
+}
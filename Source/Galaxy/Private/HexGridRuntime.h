@@ -0,0 +1,101 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HexSpatialIndex.h"
+#include "HexGridGeometry.h"
+
+class UHexGridAsset;
+
+/// <summary>
+/// Immutable runtime data of a hex grid topology: flattened positions and adjacency, spatial index,
+/// geometry and icosahedron face tables.
+///
+/// Built once from an asset and shared through FHexGridRuntimeCache by every asset with the same cells,
+/// so planets of the same level only allocate their own layers. Thread-safe, nothing changes after construction.
+/// </summary>
+class GALAXY_API FHexGridRuntime
+{
+public:
+	static constexpr int32 IcosahedronFaceCount = 20;
+
+	/// <summary>
+	/// Build every runtime structure from the asset cells, in parallel where it pays off
+	/// </summary>
+	explicit FHexGridRuntime(const UHexGridAsset& grid);
+
+	FHexGridRuntime(const FHexGridRuntime&) = delete;
+	FHexGridRuntime& operator=(const FHexGridRuntime&) = delete;
+
+	int32 GetCellCount() const { return Positions.Num(); }
+	bool IsValidCell(int32 cellId) const { return cellId >= 0 && cellId < Positions.Num(); }
+
+	/// <summary>
+	/// Cell centers on the unit sphere, indexed by cell id. Normalized from the asset positions
+	/// </summary>
+	TConstArrayView<FVector> GetPositions() const { return Positions; }
+	const FVector& GetPosition(int32 cellId) const { return Positions[cellId]; }
+
+	/// <summary>
+	/// Neighbors of a cell from the flattened adjacency table, same order as FHexCell::NeighborCellIds
+	/// </summary>
+	TConstArrayView<uint32> GetNeighbors(int32 cellId) const
+	{
+		return TConstArrayView<uint32>(Neighbors.GetData() + NeighborOffsets[cellId], NeighborOffsets[cellId + 1] - NeighborOffsets[cellId]);
+	}
+
+	const FHexSpatialIndex& GetSpatialIndex() const { return SpatialIndex; }
+	const FHexGridGeometry& GetGeometry() const { return Geometry; }
+
+	/// <summary>
+	/// Cells of every icosahedron face in increasing order, and the face of every cell
+	/// </summary>
+	const TArray<TArray<int32>>& GetFaceCells() const { return FaceCells; }
+	const TArray<uint8>& GetCellFaces() const { return CellFaces; }
+
+	uint32 GetTopologyHash() const { return TopologyHash; }
+
+	/// <summary>
+	/// True if the asset cells have the directions, neighbors and faces this runtime was built from
+	/// </summary>
+	bool HasSameTopology(const UHexGridAsset& grid) const;
+
+	/// <summary>
+	/// Hash of the cell directions, neighbors and faces of an asset
+	/// </summary>
+	static uint32 ComputeTopologyHash(const UHexGridAsset& grid);
+
+private:
+	TArray<FVector> Positions;
+	TArray<int32> NeighborOffsets;
+	TArray<uint32> Neighbors;
+	TArray<TArray<int32>> FaceCells;
+	TArray<uint8> CellFaces;
+	FHexSpatialIndex SpatialIndex;
+	FHexGridGeometry Geometry;
+	uint32 TopologyHash = 0;
+};
+
+using FHexGridRuntimePtr = TSharedPtr<const FHexGridRuntime, ESPMode::ThreadSafe>;
+
+/// <summary>
+/// Process-wide cache of grid runtimes, keyed by asset topology.
+///
+/// Entries are weak: a runtime lives as long as an asset (or a planet system) holds it and is built
+/// again on the next acquire once every holder released it. Thread-safe.
+/// </summary>
+class GALAXY_API FHexGridRuntimeCache
+{
+public:
+	/// <summary>
+	/// Runtime of an asset, shared with every live asset of the same topology. Null for an empty grid
+	/// </summary>
+	static FHexGridRuntimePtr Acquire(const UHexGridAsset& grid);
+
+	/// <summary>
+	/// Runtimes currently alive, for stats
+	/// </summary>
+	static int32 GetLiveRuntimeCount();
+};
@@ -92,13 +92,27 @@ void AHexGridViewActor::SelectCellAtPosition(FVector worldPosition)
 		return;
 	}
 
-	FVector localPos = worldPosition - GetActorLocation();
+	// Grid space follows the actor location and rotation, displayRadius replaces the scale
+	FVector localPos = GetActorTransform().InverseTransformPositionNoScale(worldPosition);
 	FVector direction = localPos.GetSafeNormal();
 
 	uint32 cellId = GridAsset->FindCellAtPosition(direction);
 	SelectCell(static_cast<int32>(cellId));
 }
 
+void AHexGridViewActor::SelectCellAlongRay(FVector rayOrigin, FVector rayDirection)
+{
+	if (!GridAsset)
+	{
+		return;
+	}
+
+	const FTransform& transform = GetActorTransform();
+	FVector hitPosition;
+	int32 cellId = GridAsset->FindCellAlongRay(transform.InverseTransformPositionNoScale(rayOrigin), transform.InverseTransformVectorNoScale(rayDirection), displayRadius, hitPosition);
+	SelectCell(cellId);
+}
+
 void AHexGridViewActor::ClearSelection()
 {
 	selectedCellID = INDEX_NONE;
@@ -272,7 +286,7 @@ bool AHexGridViewActor::ShouldDrawCell(const FHexCell& cell) const
 
 FVector AHexGridViewActor::GridToWorldPosition(const FVector& gridPosition) const
 {
-	return GetActorLocation() + gridPosition * displayRadius;
+	return GetActorLocation() + GetActorQuat().RotateVector(gridPosition * displayRadius);
 }
 
 FLinearColor AHexGridViewActor::GetFaceColor(uint8 faceIndex) const
@@ -132,6 +132,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid Preview")
 	void SelectCellAtPosition(FVector worldPosition);
 
+	UFUNCTION(BlueprintCallable, Category = "Hex Grid Preview")
+	void SelectCellAlongRay(FVector rayOrigin, FVector rayDirection);
+
 	UFUNCTION(BlueprintCallable, Category = "Hex Grid Preview")
 	void ClearSelection();
 
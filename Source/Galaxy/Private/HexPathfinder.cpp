@@ -0,0 +1,775 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexPathfinder.h"
+#include "PlanetData.h"
+#include "HexGridGenerator.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Reverse.h"
+
+namespace
+{
+	struct FOpenNode
+	{
+		int32 CellId = INDEX_NONE;
+		float Priority = 0.0f;
+	};
+
+	struct FOpenNodePredicate
+	{
+		bool operator()(const FOpenNode& A, const FOpenNode& B) const
+		{
+			return A.Priority < B.Priority;
+		}
+	};
+}
+
+// === Traversal cost ===
+
+bool FHexTraversalCost::IsPassable(const UPlanetData& planet, int32 cellId)
+{
+	return planet.IsValidCellId(cellId) && !planet.IsCellUnderwater(cellId);
+}
+
+float FHexTraversalCost::GetCellCost(const UPlanetData& planet, int32 cellId)
+{
+	return planet.GetCellMovementCost(cellId);
+}
+
+float FHexTraversalCost::GetStepCost(const UPlanetData& planet, int32 fromCellId, int32 toCellId)
+{
+	const TArray<FHexCell>& cells = planet.Grid->Cells;
+
+	float distance = FVector::Dist(cells[fromCellId].Position, cells[toCellId].Position);
+	float cellCost = 0.5f * (GetCellCost(planet, fromCellId) + GetCellCost(planet, toCellId));
+	int32 climb = FMath::Abs(planet.GetCellElevation(toCellId) - planet.GetCellElevation(fromCellId));
+
+	return distance * cellCost * (1.0f + ElevationStepPenalty * climb);
+}
+
+// === Hierarchical pathfinder ===
+
+FHexHierarchicalPathfinder::FHexHierarchicalPathfinder()
+{
+}
+
+FHexHierarchicalPathfinder::~FHexHierarchicalPathfinder()
+{
+	Reset();
+}
+
+bool FHexHierarchicalPathfinder::Initialize(UPlanetData* inPlanet, int32 clusterSubdivision /* = INDEX_NONE */)
+{
+	Reset();
+
+	if (!inPlanet || !inPlanet->Grid || !inPlanet->AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FHexHierarchicalPathfinder::Initialize - Planet, grid or data layers are not initialized."));
+		return false;
+	}
+
+	Planet = inPlanet;
+	CellChangedHandle = Planet->OnCellDataChanged.AddRaw(this, &FHexHierarchicalPathfinder::OnPlanetCellChanged);
+
+	BuildClusters(clusterSubdivision);
+
+	const int32 cellCount = CellToCluster.Num();
+	CellCosts.SetNumUninitialized(cellCount);
+	CellElevations.SetNumUninitialized(cellCount);
+	PassableCells.Init(false, cellCount);
+	BuiltWaterLevel = Planet->WaterLevel;
+	for (const FCluster& cluster : Clusters)
+	{
+		GatherCellData(cluster.CellIds);
+	}
+
+	MinCellCost = FLT_MAX;
+	for (float cellCost : CellCosts)
+	{
+		MinCellCost = FMath::Min(MinCellCost, cellCost);
+	}
+
+	double startTime = FPlatformTime::Seconds();
+	RefreshDirtyClusters();
+
+	UE_LOG(LogTemp, Log, TEXT("FHexHierarchicalPathfinder::Initialize - %d clusters, %d portals built in %.2f ms."),
+		Clusters.Num(), GetPortalCount(), (FPlatformTime::Seconds() - startTime) * 1000.0);
+
+	return true;
+}
+
+void FHexHierarchicalPathfinder::Reset()
+{
+	if (Planet && CellChangedHandle.IsValid())
+	{
+		Planet->OnCellDataChanged.Remove(CellChangedHandle);
+	}
+
+	Planet = nullptr;
+	CellChangedHandle.Reset();
+	CellToCluster.Empty();
+	CellToLocalIndex.Empty();
+	CellCosts.Empty();
+	CellElevations.Empty();
+	PassableCells.Empty();
+	Clusters.Empty();
+	Entrances.Empty();
+	bHasDirtyClusters = true;
+}
+
+void FHexHierarchicalPathfinder::MarkCellDirty(int32 cellId)
+{
+	if (cellId == INDEX_NONE)
+	{
+		for (FCluster& cluster : Clusters)
+		{
+			cluster.bDirty = true;
+		}
+		bHasDirtyClusters = true;
+		return;
+	}
+
+	if (CellToCluster.IsValidIndex(cellId))
+	{
+		Clusters[CellToCluster[cellId]].bDirty = true;
+		bHasDirtyClusters = true;
+	}
+}
+
+void FHexHierarchicalPathfinder::MarkCellsDirty(TConstArrayView<int32> cellIds)
+{
+	for (int32 cellId : cellIds)
+	{
+		MarkCellDirty(cellId);
+	}
+}
+
+int32 FHexHierarchicalPathfinder::GetClusterOfCell(int32 cellId) const
+{
+	return CellToCluster.IsValidIndex(cellId) ? CellToCluster[cellId] : INDEX_NONE;
+}
+
+int32 FHexHierarchicalPathfinder::GetPortalCount() const
+{
+	int32 count = 0;
+	for (const FCluster& cluster : Clusters)
+	{
+		count += cluster.PortalCellIds.Num();
+	}
+	return count;
+}
+
+bool FHexHierarchicalPathfinder::FindPath(int32 startCellId, int32 goalCellId, TArray<int32>& outPath, float* outCost /* = nullptr */)
+{
+	outPath.Reset();
+
+	if (!IsInitialized() || !Planet->IsValidCellId(startCellId) || !Planet->IsValidCellId(goalCellId))
+	{
+		return false;
+	}
+
+	if (!FHexTraversalCost::IsPassable(*Planet, startCellId) || !FHexTraversalCost::IsPassable(*Planet, goalCellId))
+	{
+		return false;
+	}
+
+	if (startCellId == goalCellId)
+	{
+		outPath.Add(startCellId);
+		if (outCost)
+		{
+			*outCost = 0.0f;
+		}
+		return true;
+	}
+
+	RefreshDirtyClusters();
+
+	const int32 startCluster = CellToCluster[startCellId];
+	const int32 goalCluster = CellToCluster[goalCellId];
+
+	// Same cluster : try a direct search first
+	if (startCluster == goalCluster)
+	{
+		FClusterSearch search;
+		SearchCluster(startCluster, startCellId, goalCellId, search);
+
+		float cost = search.Cost[CellToLocalIndex[goalCellId]];
+		if (cost < MAX_flt)
+		{
+			ExtractClusterPath(startCluster, search, goalCellId, outPath);
+			if (outCost)
+			{
+				*outCost = cost;
+			}
+			return true;
+		}
+	}
+
+	// Start and goal are connected to the portals of their clusters through the cached portal searches
+	const FCluster& startClusterData = Clusters[startCluster];
+	const FCluster& goalClusterData = Clusters[goalCluster];
+	const int32 startLocal = CellToLocalIndex[startCellId];
+	const int32 goalLocal = CellToLocalIndex[goalCellId];
+
+	// A* on the portal graph
+	enum class ELinkKind : uint8 { None, FromStart, Intra, Inter, ToGoal };
+
+	struct FVisit
+	{
+		int32 ParentCellId = INDEX_NONE;
+		float Cost = MAX_flt;
+		const TArray<int32>* Path = nullptr;
+		ELinkKind Kind = ELinkKind::None;
+		bool bClosed = false;
+	};
+
+	TMap<int32, FVisit> visits;
+	TArray<FOpenNode> open;
+
+	auto relax = [&](int32 fromCellId, int32 toCellId, float cost, ELinkKind kind, const TArray<int32>* path)
+		{
+			FVisit& visit = visits.FindOrAdd(toCellId);
+			if (visit.bClosed || cost >= visit.Cost)
+			{
+				return;
+			}
+
+			visit.ParentCellId = fromCellId;
+			visit.Cost = cost;
+			visit.Path = path;
+			visit.Kind = kind;
+			open.HeapPush({ toCellId, cost + GetHeuristic(toCellId, goalCellId) }, FOpenNodePredicate());
+		};
+
+	visits.Add(startCellId).Cost = 0.0f;
+	open.HeapPush({ startCellId, GetHeuristic(startCellId, goalCellId) }, FOpenNodePredicate());
+
+	bool bFound = false;
+	while (open.Num() > 0)
+	{
+		FOpenNode node;
+		open.HeapPop(node, FOpenNodePredicate(), EAllowShrinking::No);
+
+		FVisit& visit = visits.FindChecked(node.CellId);
+		if (visit.bClosed)
+		{
+			continue;
+		}
+		visit.bClosed = true;
+
+		if (node.CellId == goalCellId)
+		{
+			bFound = true;
+			break;
+		}
+
+		const float cost = visit.Cost;
+		const int32 cluster = CellToCluster[node.CellId];
+
+		if (node.CellId == startCellId)
+		{
+			for (int32 portalIdx = 0; portalIdx < startClusterData.PortalCellIds.Num(); ++portalIdx)
+			{
+				const int32 portalCellId = startClusterData.PortalCellIds[portalIdx];
+				float portalCost = startClusterData.PortalSearches[portalIdx].Cost[startLocal];
+				if (portalCost < MAX_flt && portalCellId != startCellId)
+				{
+					relax(startCellId, portalCellId, portalCost, ELinkKind::FromStart, nullptr);
+				}
+			}
+		}
+
+		if (const TArray<FPortalLink>* links = Clusters[cluster].Links.Find(node.CellId))
+		{
+			for (const FPortalLink& link : *links)
+			{
+				bool bIntra = link.Path.Num() > 0;
+				relax(node.CellId, link.TargetCellId, cost + link.Cost, bIntra ? ELinkKind::Intra : ELinkKind::Inter, bIntra ? &link.Path : nullptr);
+			}
+		}
+
+		// The start is only a node of the goal cluster as a portal, the direct search already failed otherwise
+		const int32 goalPortalIdx = cluster == goalCluster ? goalClusterData.PortalCellIds.Find(node.CellId) : INDEX_NONE;
+		if (goalPortalIdx != INDEX_NONE)
+		{
+			float goalCost = goalClusterData.PortalSearches[goalPortalIdx].Cost[goalLocal];
+			if (goalCost < MAX_flt)
+			{
+				relax(node.CellId, goalCellId, cost + goalCost, ELinkKind::ToGoal, nullptr);
+			}
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	// Rebuild the cell path from the chain of portals
+	TArray<int32> nodes;
+	for (int32 cellId = goalCellId; cellId != INDEX_NONE; cellId = visits.FindChecked(cellId).ParentCellId)
+	{
+		nodes.Add(cellId);
+	}
+	Algo::Reverse(nodes);
+
+	outPath.Add(startCellId);
+	TArray<int32> segment;
+	for (int32 i = 1; i < nodes.Num(); ++i)
+	{
+		const FVisit& visit = visits.FindChecked(nodes[i]);
+		segment.Reset();
+
+		switch (visit.Kind)
+		{
+		case ELinkKind::FromStart:
+		{
+			const int32 portalIdx = startClusterData.PortalCellIds.Find(nodes[i]);
+			ExtractClusterPath(startCluster, startClusterData.PortalSearches[portalIdx], startCellId, segment);
+			Algo::Reverse(segment);
+			break;
+		}
+
+		case ELinkKind::Intra:
+			segment = *visit.Path;
+			break;
+
+		case ELinkKind::ToGoal:
+		{
+			const int32 portalIdx = goalClusterData.PortalCellIds.Find(nodes[i - 1]);
+			ExtractClusterPath(goalCluster, goalClusterData.PortalSearches[portalIdx], goalCellId, segment);
+			break;
+		}
+
+		default:
+			segment.Add(nodes[i - 1]);
+			segment.Add(nodes[i]);
+			break;
+		}
+
+		// Segments start on the last cell already in the path
+		for (int32 j = 1; j < segment.Num(); ++j)
+		{
+			outPath.Add(segment[j]);
+		}
+	}
+
+	if (outCost)
+	{
+		*outCost = visits.FindChecked(goalCellId).Cost;
+	}
+
+	return true;
+}
+
+void FHexHierarchicalPathfinder::BuildClusters(int32 clusterSubdivision)
+{
+	const UHexGridAsset* grid = Planet->Grid;
+	const int32 cellCount = grid->Cells.Num();
+
+	// Around 500-2000 cells per cluster by default
+	SubdivisionLevel = clusterSubdivision >= 0 ? clusterSubdivision : FMath::Clamp(grid->GridLevel - 5, 0, 3);
+	const int32 segments = 1 << SubdivisionLevel;
+	const int32 clustersPerFace = segments * segments;
+
+	// Icosahedron face planes, used to split faces into sub-triangles
+	FVector faceCorners[20][3];
+	FVector faceNormals[20];
+	for (int32 faceIdx = 0; faceIdx < 20; ++faceIdx)
+	{
+		UHexGridGenerator::GetIcosahedronFaceCorners(faceIdx, faceCorners[faceIdx][0], faceCorners[faceIdx][1], faceCorners[faceIdx][2]);
+		faceNormals[faceIdx] = (faceCorners[faceIdx][0] + faceCorners[faceIdx][1] + faceCorners[faceIdx][2]).GetSafeNormal();
+	}
+
+	CellToCluster.SetNumUninitialized(cellCount);
+	ParallelFor(cellCount, [&](int32 cellId)
+		{
+			const FHexCell& cell = grid->Cells[cellId];
+			const int32 faceIdx = FMath::Min<int32>(cell.IcosaheronFaceIndex, 19);
+
+			int32 subIndex = 0;
+			if (segments > 1)
+			{
+				const FVector& a = faceCorners[faceIdx][0];
+				const FVector& b = faceCorners[faceIdx][1];
+				const FVector& c = faceCorners[faceIdx][2];
+
+				// Gnomonic projection onto the face plane, then barycentric coordinates
+				float denom = FVector::DotProduct(cell.Position, faceNormals[faceIdx]);
+				FVector projected = denom > KINDA_SMALL_NUMBER ? cell.Position * (FVector::DotProduct(a, faceNormals[faceIdx]) / denom) : cell.Position;
+
+				FVector v0 = b - a;
+				FVector v1 = c - a;
+				FVector v2 = projected - a;
+				double d00 = FVector::DotProduct(v0, v0);
+				double d01 = FVector::DotProduct(v0, v1);
+				double d11 = FVector::DotProduct(v1, v1);
+				double d20 = FVector::DotProduct(v2, v0);
+				double d21 = FVector::DotProduct(v2, v1);
+				double baryDenom = d00 * d11 - d01 * d01;
+
+				double u = FMath::Clamp((d11 * d20 - d01 * d21) / baryDenom, 0.0, 1.0);
+				double v = FMath::Clamp((d00 * d21 - d01 * d20) / baryDenom, 0.0, 1.0);
+				if (u + v > 1.0)
+				{
+					double sum = u + v;
+					u /= sum;
+					v /= sum;
+				}
+
+				// Row i along AB, column j along AC, two sub-triangles per rhombus except on the diagonal
+				double fu = u * segments;
+				double fv = v * segments;
+				int32 i = FMath::Clamp(FMath::FloorToInt32(fu), 0, segments - 1);
+				int32 j = FMath::Clamp(FMath::FloorToInt32(fv), 0, segments - 1 - i);
+				bool bUpper = (i + j) < segments - 1 && (fu - i) + (fv - j) > 1.0;
+
+				subIndex = 2 * segments * i - i * i + 2 * j + (bUpper ? 1 : 0);
+			}
+
+			CellToCluster[cellId] = faceIdx * clustersPerFace + subIndex;
+		});
+
+	Clusters.SetNum(20 * clustersPerFace);
+	CellToLocalIndex.SetNumUninitialized(cellCount);
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		CellToLocalIndex[cellId] = Clusters[CellToCluster[cellId]].CellIds.Add(cellId);
+	}
+
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		FCluster& cluster = Clusters[CellToCluster[cellId]];
+		for (uint32 neighborId : grid->Cells[cellId].NeighborCellIds)
+		{
+			int32 neighborCluster = CellToCluster[neighborId];
+			if (neighborCluster != CellToCluster[cellId])
+			{
+				cluster.NeighborClusters.AddUnique(neighborCluster);
+			}
+		}
+	}
+
+	bHasDirtyClusters = true;
+}
+
+void FHexHierarchicalPathfinder::GatherCellData(TConstArrayView<int32> cellIds)
+{
+	for (int32 cellId : cellIds)
+	{
+		CellCosts[cellId] = FHexTraversalCost::GetCellCost(*Planet, cellId);
+		CellElevations[cellId] = Planet->GetCellElevation(cellId);
+		PassableCells[cellId] = FHexTraversalCost::IsPassable(*Planet, cellId);
+	}
+}
+
+void FHexHierarchicalPathfinder::RefreshDirtyClusters()
+{
+	// Passability depends on the water level (set directly, or by a load or a wake)
+	if (Planet && Planet->WaterLevel != BuiltWaterLevel)
+	{
+		BuiltWaterLevel = Planet->WaterLevel;
+		MarkCellDirty(INDEX_NONE);
+	}
+
+	if (!bHasDirtyClusters)
+	{
+		return;
+	}
+	bHasDirtyClusters = false;
+
+	TArray<int32> dirtyClusters;
+	for (int32 clusterIdx = 0; clusterIdx < Clusters.Num(); ++clusterIdx)
+	{
+		if (Clusters[clusterIdx].bDirty)
+		{
+			dirtyClusters.Add(clusterIdx);
+		}
+	}
+
+	if (dirtyClusters.Num() == 0)
+	{
+		return;
+	}
+
+	// Keep the heuristic admissible if a cheaper biome was painted
+	for (int32 clusterIdx : dirtyClusters)
+	{
+		GatherCellData(Clusters[clusterIdx].CellIds);
+		for (int32 cellId : Clusters[clusterIdx].CellIds)
+		{
+			MinCellCost = FMath::Min(MinCellCost, CellCosts[cellId]);
+		}
+	}
+
+	// Entrances change on every border of a dirty cluster, which also invalidates the links of the neighbors
+	TSet<uint64> rebuiltBorders;
+	TBitArray<> affectedMask(false, Clusters.Num());
+	TArray<int32> affectedClusters;
+
+	for (int32 clusterIdx : dirtyClusters)
+	{
+		if (!affectedMask[clusterIdx])
+		{
+			affectedMask[clusterIdx] = true;
+			affectedClusters.Add(clusterIdx);
+		}
+
+		for (int32 neighborCluster : Clusters[clusterIdx].NeighborClusters)
+		{
+			bool bAlreadyBuilt = false;
+			rebuiltBorders.Add(MakeClusterPairKey(clusterIdx, neighborCluster), &bAlreadyBuilt);
+			if (!bAlreadyBuilt)
+			{
+				BuildEntrances(clusterIdx, neighborCluster);
+			}
+
+			if (!affectedMask[neighborCluster])
+			{
+				affectedMask[neighborCluster] = true;
+				affectedClusters.Add(neighborCluster);
+			}
+		}
+	}
+
+	// Each cluster only writes its own links, and only reads the gathered cell data
+	ParallelFor(affectedClusters.Num(), [&](int32 index)
+		{
+			BuildClusterLinks(affectedClusters[index]);
+		});
+
+	for (int32 clusterIdx : dirtyClusters)
+	{
+		Clusters[clusterIdx].bDirty = false;
+	}
+}
+
+void FHexHierarchicalPathfinder::BuildEntrances(int32 clusterA, int32 clusterB)
+{
+	const TArray<FHexCell>& cells = Planet->Grid->Cells;
+
+	TArray<FEntrance>& entrances = Entrances.FindOrAdd(MakeClusterPairKey(clusterA, clusterB));
+	entrances.Reset();
+
+	// Passable cells of A touching a passable cell of B
+	TArray<int32> borderCells;
+	for (int32 cellId : Clusters[clusterA].CellIds)
+	{
+		if (!PassableCells[cellId])
+		{
+			continue;
+		}
+
+		for (uint32 neighborId : cells[cellId].NeighborCellIds)
+		{
+			if (CellToCluster[neighborId] == clusterB && PassableCells[neighborId])
+			{
+				borderCells.Add(cellId);
+				break;
+			}
+		}
+	}
+
+	// One portal per contiguous stretch of border, on the cell closest to the middle of the stretch
+	TSet<int32> remaining(borderCells);
+	TArray<int32> stretch;
+	for (int32 seedCellId : borderCells)
+	{
+		if (remaining.Remove(seedCellId) == 0)
+		{
+			continue;
+		}
+
+		stretch.Reset();
+		stretch.Add(seedCellId);
+		FVector centroid = FVector::ZeroVector;
+		for (int32 i = 0; i < stretch.Num(); ++i)
+		{
+			centroid += cells[stretch[i]].Position;
+			for (uint32 neighborId : cells[stretch[i]].NeighborCellIds)
+			{
+				if (remaining.Remove(neighborId) > 0)
+				{
+					stretch.Add(neighborId);
+				}
+			}
+		}
+		centroid /= stretch.Num();
+
+		int32 portalCellId = stretch[0];
+		float minDistanceSq = FLT_MAX;
+		for (int32 cellId : stretch)
+		{
+			float distanceSq = FVector::DistSquared(cells[cellId].Position, centroid);
+			if (distanceSq < minDistanceSq)
+			{
+				minDistanceSq = distanceSq;
+				portalCellId = cellId;
+			}
+		}
+
+		for (uint32 neighborId : cells[portalCellId].NeighborCellIds)
+		{
+			if (CellToCluster[neighborId] == clusterB && PassableCells[neighborId])
+			{
+				entrances.Add({ portalCellId, static_cast<int32>(neighborId) });
+				break;
+			}
+		}
+	}
+}
+
+void FHexHierarchicalPathfinder::BuildClusterLinks(int32 clusterIndex)
+{
+	FCluster& cluster = Clusters[clusterIndex];
+	cluster.Links.Reset();
+	cluster.PortalCellIds.Reset();
+	cluster.PortalSearches.Reset();
+
+	// Inter-cluster links, from the entrances of every border
+	for (int32 neighborCluster : cluster.NeighborClusters)
+	{
+		const TArray<FEntrance>* entrances = Entrances.Find(MakeClusterPairKey(clusterIndex, neighborCluster));
+		if (!entrances)
+		{
+			continue;
+		}
+
+		for (const FEntrance& entrance : *entrances)
+		{
+			bool bOwnsA = CellToCluster[entrance.CellA] == clusterIndex;
+			int32 ownCellId = bOwnsA ? entrance.CellA : entrance.CellB;
+			int32 otherCellId = bOwnsA ? entrance.CellB : entrance.CellA;
+
+			cluster.PortalCellIds.AddUnique(ownCellId);
+
+			FPortalLink& link = cluster.Links.FindOrAdd(ownCellId).AddDefaulted_GetRef();
+			link.TargetCellId = otherCellId;
+			link.Cost = GetStepCost(ownCellId, otherCellId);
+		}
+	}
+
+	// Intra-cluster links between every pair of portals, the searches are kept to connect queries
+	cluster.PortalSearches.SetNum(cluster.PortalCellIds.Num());
+	for (int32 portalIdx = 0; portalIdx < cluster.PortalCellIds.Num(); ++portalIdx)
+	{
+		const int32 portalCellId = cluster.PortalCellIds[portalIdx];
+		FClusterSearch& search = cluster.PortalSearches[portalIdx];
+		SearchCluster(clusterIndex, portalCellId, INDEX_NONE, search);
+
+		for (int32 otherPortalId : cluster.PortalCellIds)
+		{
+			if (otherPortalId == portalCellId)
+			{
+				continue;
+			}
+
+			float cost = search.Cost[CellToLocalIndex[otherPortalId]];
+			if (cost >= MAX_flt)
+			{
+				continue;
+			}
+
+			FPortalLink& link = cluster.Links.FindOrAdd(portalCellId).AddDefaulted_GetRef();
+			link.TargetCellId = otherPortalId;
+			link.Cost = cost;
+			ExtractClusterPath(clusterIndex, search, otherPortalId, link.Path);
+		}
+	}
+}
+
+void FHexHierarchicalPathfinder::SearchCluster(int32 clusterIndex, int32 sourceCellId, int32 goalCellId, FClusterSearch& outSearch) const
+{
+	const FCluster& cluster = Clusters[clusterIndex];
+	const TArray<FHexCell>& cells = Planet->Grid->Cells;
+
+	outSearch.Cost.Init(MAX_flt, cluster.CellIds.Num());
+	outSearch.Parent.Init(INDEX_NONE, cluster.CellIds.Num());
+
+	TArray<FOpenNode> open;
+	outSearch.Cost[CellToLocalIndex[sourceCellId]] = 0.0f;
+	open.HeapPush({ sourceCellId, 0.0f }, FOpenNodePredicate());
+
+	while (open.Num() > 0)
+	{
+		FOpenNode node;
+		open.HeapPop(node, FOpenNodePredicate(), EAllowShrinking::No);
+
+		if (node.CellId == goalCellId)
+		{
+			break;
+		}
+
+		const int32 localIndex = CellToLocalIndex[node.CellId];
+		const float cost = outSearch.Cost[localIndex];
+		const float heuristic = goalCellId != INDEX_NONE ? GetHeuristic(node.CellId, goalCellId) : 0.0f;
+
+		// Stale heap entry, the cell was reached again with a lower cost
+		if (node.Priority > cost + heuristic + KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		for (uint32 neighborId : cells[node.CellId].NeighborCellIds)
+		{
+			if (CellToCluster[neighborId] != clusterIndex || !PassableCells[neighborId])
+			{
+				continue;
+			}
+
+			const int32 neighborLocal = CellToLocalIndex[neighborId];
+			const float newCost = cost + GetStepCost(node.CellId, neighborId);
+			if (newCost < outSearch.Cost[neighborLocal])
+			{
+				outSearch.Cost[neighborLocal] = newCost;
+				outSearch.Parent[neighborLocal] = localIndex;
+
+				const float neighborHeuristic = goalCellId != INDEX_NONE ? GetHeuristic(neighborId, goalCellId) : 0.0f;
+				open.HeapPush({ static_cast<int32>(neighborId), newCost + neighborHeuristic }, FOpenNodePredicate());
+			}
+		}
+	}
+}
+
+void FHexHierarchicalPathfinder::ExtractClusterPath(int32 clusterIndex, const FClusterSearch& search, int32 targetCellId, TArray<int32>& outPath) const
+{
+	const FCluster& cluster = Clusters[clusterIndex];
+
+	outPath.Reset();
+	for (int32 localIndex = CellToLocalIndex[targetCellId]; localIndex != INDEX_NONE; localIndex = search.Parent[localIndex])
+	{
+		outPath.Add(cluster.CellIds[localIndex]);
+	}
+	Algo::Reverse(outPath);
+}
+
+float FHexHierarchicalPathfinder::GetStepCost(int32 fromCellId, int32 toCellId) const
+{
+	const TArray<FHexCell>& cells = Planet->Grid->Cells;
+
+	float distance = FVector::Dist(cells[fromCellId].Position, cells[toCellId].Position);
+	float cellCost = 0.5f * (CellCosts[fromCellId] + CellCosts[toCellId]);
+	int32 climb = FMath::Abs(CellElevations[toCellId] - CellElevations[fromCellId]);
+
+	return distance * cellCost * (1.0f + FHexTraversalCost::ElevationStepPenalty * climb);
+}
+
+float FHexHierarchicalPathfinder::GetHeuristic(int32 fromCellId, int32 toCellId) const
+{
+	// Chord length is never longer than the sum of the steps, and every step costs at least MinCellCost per unit
+	const TArray<FHexCell>& cells = Planet->Grid->Cells;
+	return FVector::Dist(cells[fromCellId].Position, cells[toCellId].Position) * MinCellCost;
+}
+
+void FHexHierarchicalPathfinder::OnPlanetCellChanged(int32 cellId)
+{
+	MarkCellDirty(cellId);
+}
+
+uint64 FHexHierarchicalPathfinder::MakeClusterPairKey(int32 clusterA, int32 clusterB)
+{
+	uint32 low = static_cast<uint32>(FMath::Min(clusterA, clusterB));
+	uint32 high = static_cast<uint32>(FMath::Max(clusterA, clusterB));
+	return (static_cast<uint64>(high) << 32) | low;
+}
@@ -0,0 +1,190 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPlanetData;
+
+/// <summary>
+/// Movement cost model shared by the pathfinding code.
+/// Costs are symmetric: moving A->B costs the same as moving B->A.
+/// </summary>
+struct GALAXY_API FHexTraversalCost
+{
+	/// <summary>
+	/// Extra cost factor applied per elevation level climbed or descended between two cells
+	/// </summary>
+	static constexpr float ElevationStepPenalty = 0.5f;
+
+	/// <summary>
+	/// Check if a unit can stand on the cell (underwater cells are impassable)
+	/// </summary>
+	static bool IsPassable(const UPlanetData& planet, int32 cellId);
+
+	/// <summary>
+	/// Get the cost multiplier of a single cell (biome movement cost, 1 when no biome is set)
+	/// </summary>
+	static float GetCellCost(const UPlanetData& planet, int32 cellId);
+
+	/// <summary>
+	/// Get the cost of moving between two neighboring cells, on the unit sphere
+	/// </summary>
+	static float GetStepCost(const UPlanetData& planet, int32 fromCellId, int32 toCellId);
+};
+
+/// <summary>
+/// Hierarchical (HPA*-style) pathfinder over a planet's hex grid.
+///
+/// Cells are grouped in clusters: each icosahedron face, optionally split into 4^N sub-triangles.
+/// Portals are placed on every contiguous passable stretch of border between two clusters, and the
+/// cost (and cell path) between every pair of portals of a cluster is precomputed.
+/// The search from each portal to every cell of its cluster is kept, so a query connects the start and
+/// goal to the portal graph with lookups, then runs A* on the portal graph. Only start and goal in the
+/// same cluster run a cell level A*, limited to that cluster.
+///
+/// Clusters are refreshed lazily: cells edited through UPlanetData mark their cluster dirty and the
+/// portal graph of dirty clusters (and of their direct neighbors) is rebuilt on the next query.
+/// Not thread-safe, use from the game thread.
+/// </summary>
+class GALAXY_API FHexHierarchicalPathfinder
+{
+public:
+	FHexHierarchicalPathfinder();
+	~FHexHierarchicalPathfinder();
+
+	FHexHierarchicalPathfinder(const FHexHierarchicalPathfinder&) = delete;
+	FHexHierarchicalPathfinder& operator=(const FHexHierarchicalPathfinder&) = delete;
+
+	/// <summary>
+	/// Build clusters and the portal graph for a planet
+	/// </summary>
+	/// <param name="inPlanet">Planet to path on, its grid and data layers must be initialized</param>
+	/// <param name="clusterSubdivision">Each icosahedron face is split into 4^N clusters, INDEX_NONE to pick from the grid level</param>
+	/// <returns>True if the pathfinder is ready to answer queries</returns>
+	bool Initialize(UPlanetData* inPlanet, int32 clusterSubdivision = INDEX_NONE);
+
+	/// <summary>
+	/// Release all data and stop listening to planet changes
+	/// </summary>
+	void Reset();
+
+	bool IsInitialized() const { return Planet != nullptr && CellToCluster.Num() > 0; }
+
+	/// <summary>
+	/// Mark the clusters owning these cells for refresh, INDEX_NONE marks every cluster
+	/// </summary>
+	void MarkCellDirty(int32 cellId);
+	void MarkCellsDirty(TConstArrayView<int32> cellIds);
+
+	/// <summary>
+	/// Find a path between two cells
+	/// </summary>
+	/// <param name="startCellId">Start cell</param>
+	/// <param name="goalCellId">Goal cell</param>
+	/// <param name="outPath">Cells from start to goal (both included), empty if there is no path</param>
+	/// <param name="outCost">Optional total path cost</param>
+	/// <returns>True if a path was found</returns>
+	bool FindPath(int32 startCellId, int32 goalCellId, TArray<int32>& outPath, float* outCost = nullptr);
+
+	int32 GetClusterCount() const { return Clusters.Num(); }
+	int32 GetClusterOfCell(int32 cellId) const;
+	int32 GetPortalCount() const;
+
+private:
+	/// <summary>
+	/// Link from a portal cell to another portal cell
+	/// Intra-cluster links cache the cell path, inter-cluster links are a single step between neighbors
+	/// </summary>
+	struct FPortalLink
+	{
+		int32 TargetCellId = INDEX_NONE;
+		float Cost = 0.0f;
+		TArray<int32> Path;
+	};
+
+	/// <summary>
+	/// Crossing between two clusters, CellA and CellB are neighbors on each side of the border
+	/// </summary>
+	struct FEntrance
+	{
+		int32 CellA = INDEX_NONE;
+		int32 CellB = INDEX_NONE;
+	};
+
+	/// <summary>
+	/// Result of a cell level search inside a single cluster, indexed by local cell index
+	/// </summary>
+	struct FClusterSearch
+	{
+		TArray<float> Cost;
+		TArray<int32> Parent;
+	};
+
+	struct FCluster
+	{
+		TArray<int32> CellIds;
+		TArray<int32> NeighborClusters;
+		TArray<int32> PortalCellIds;
+
+		/// <summary>
+		/// Search from each portal over the cluster, indexed like PortalCellIds.
+		/// Costs are symmetric, so it is also the cost from any cell of the cluster to the portal
+		/// </summary>
+		TArray<FClusterSearch> PortalSearches;
+
+		TMap<int32, TArray<FPortalLink>> Links;
+		bool bDirty = true;
+	};
+
+	void BuildClusters(int32 clusterSubdivision);
+
+	/// <summary>
+	/// Copy the passability, cost and elevation of cells from the planet, so cluster builds do not touch UObjects
+	/// </summary>
+	void GatherCellData(TConstArrayView<int32> cellIds);
+
+	void RefreshDirtyClusters();
+	void BuildEntrances(int32 clusterA, int32 clusterB);
+	void BuildClusterLinks(int32 clusterIndex);
+
+	/// <summary>
+	/// Dijkstra (goal == INDEX_NONE) or A* search restricted to the cells of one cluster
+	/// </summary>
+	void SearchCluster(int32 clusterIndex, int32 sourceCellId, int32 goalCellId, FClusterSearch& outSearch) const;
+
+	/// <summary>
+	/// Rebuild the cell path from the source of a cluster search to a cell of that cluster
+	/// </summary>
+	void ExtractClusterPath(int32 clusterIndex, const FClusterSearch& search, int32 targetCellId, TArray<int32>& outPath) const;
+
+	/// <summary>
+	/// Same cost as FHexTraversalCost::GetStepCost, from the gathered cell data
+	/// </summary>
+	float GetStepCost(int32 fromCellId, int32 toCellId) const;
+
+	float GetHeuristic(int32 fromCellId, int32 toCellId) const;
+
+	void OnPlanetCellChanged(int32 cellId);
+
+	static uint64 MakeClusterPairKey(int32 clusterA, int32 clusterB);
+
+	UPlanetData* Planet = nullptr;
+	FDelegateHandle CellChangedHandle;
+
+	int32 SubdivisionLevel = 0;
+	float MinCellCost = 1.0f;
+
+	TArray<int32> CellToCluster;
+	TArray<int32> CellToLocalIndex;
+	TArray<float> CellCosts;
+	TArray<int32> CellElevations;
+	TBitArray<> PassableCells;
+
+	/** UPlanetData::WaterLevel PassableCells were gathered with, changing it does not broadcast OnCellDataChanged */
+	int32 BuiltWaterLevel = 0;
+	TArray<FCluster> Clusters;
+	TMap<uint64, TArray<FEntrance>> Entrances;
+	bool bHasDirtyClusters = true;
+};
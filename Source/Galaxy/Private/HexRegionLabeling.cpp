@@ -0,0 +1,138 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexRegionLabeling.h"
+#include "HexGridAsset.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+namespace
+{
+	/// <summary>
+	/// Find the root of a cell, halving the path on the way (concurrent halving only ever shortcuts to an ancestor)
+	/// </summary>
+	int32 FindRoot(TArray<std::atomic<int32>>& parents, int32 cellId)
+	{
+		int32 parent = parents[cellId].load(std::memory_order_relaxed);
+		while (parent != cellId)
+		{
+			const int32 grandParent = parents[parent].load(std::memory_order_relaxed);
+			if (grandParent != parent)
+			{
+				parents[cellId].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+			}
+
+			cellId = parent;
+			parent = parents[cellId].load(std::memory_order_relaxed);
+		}
+
+		return cellId;
+	}
+
+	/// <summary>
+	/// Merge the components of two cells, the higher root is attached below the lower one
+	/// </summary>
+	void Union(TArray<std::atomic<int32>>& parents, int32 cellA, int32 cellB)
+	{
+		while (true)
+		{
+			int32 rootA = FindRoot(parents, cellA);
+			int32 rootB = FindRoot(parents, cellB);
+			if (rootA == rootB)
+			{
+				return;
+			}
+
+			if (rootA > rootB)
+			{
+				Swap(rootA, rootB);
+			}
+
+			// Fails if another thread attached rootB meanwhile, try again from the new roots
+			int32 expected = rootB;
+			if (parents[rootB].compare_exchange_strong(expected, rootA, std::memory_order_acq_rel))
+			{
+				return;
+			}
+		}
+	}
+}
+
+int32 FHexRegionLabeler::LabelByClass(const UHexGridAsset& grid, TConstArrayView<int32> cellClasses, TArray<int32>& outRegionIds, TArray<int32>& outRegionSizes)
+{
+	const int32 cellCount = grid.Cells.Num();
+	outRegionSizes.Reset();
+
+	if (cellClasses.Num() != cellCount)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FHexRegionLabeler::LabelByClass - %d classes given for %d cells."), cellClasses.Num(), cellCount);
+		outRegionIds.Init(INDEX_NONE, cellCount);
+		return 0;
+	}
+
+	TArray<std::atomic<int32>> parents;
+	parents.SetNum(cellCount);
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		parents[cellId].store(cellId, std::memory_order_relaxed);
+	}
+
+	// Each edge is merged once, from its lower cell
+	ParallelFor(cellCount, [&](int32 cellId)
+		{
+			const int32 cellClass = cellClasses[cellId];
+			if (cellClass < 0)
+			{
+				return;
+			}
+
+			for (uint32 neighborId : grid.Cells[cellId].NeighborCellIds)
+			{
+				if (static_cast<int32>(neighborId) > cellId && cellClasses[neighborId] == cellClass)
+				{
+					Union(parents, cellId, neighborId);
+				}
+			}
+		});
+
+	// Roots are the lowest cell of their component, so they come first in cell order
+	outRegionIds.SetNumUninitialized(cellCount);
+	int32 regionCount = 0;
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		if (cellClasses[cellId] < 0)
+		{
+			outRegionIds[cellId] = INDEX_NONE;
+			continue;
+		}
+
+		const int32 root = FindRoot(parents, cellId);
+		if (root == cellId)
+		{
+			outRegionIds[cellId] = regionCount++;
+			outRegionSizes.Add(0);
+		}
+		else
+		{
+			outRegionIds[cellId] = outRegionIds[root];
+		}
+
+		++outRegionSizes[outRegionIds[cellId]];
+	}
+
+	return regionCount;
+}
+
+int32 FHexRegionLabeler::LabelByPredicate(const UHexGridAsset& grid, TFunctionRef<bool(int32)> predicate, TArray<int32>& outRegionIds, TArray<int32>& outRegionSizes)
+{
+	const int32 cellCount = grid.Cells.Num();
+
+	TArray<int32> cellClasses;
+	cellClasses.SetNumUninitialized(cellCount);
+	ParallelFor(cellCount, [&](int32 cellId)
+		{
+			cellClasses[cellId] = predicate(cellId) ? 0 : INDEX_NONE;
+		});
+
+	return LabelByClass(grid, cellClasses, outRegionIds, outRegionSizes);
+}
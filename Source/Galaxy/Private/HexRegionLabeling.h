@@ -0,0 +1,35 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UHexGridAsset;
+
+/// <summary>
+/// Connected component labeling over the cell graph (continents, oceans, custom regions).
+///
+/// Every edge between two cells of the same class is merged in parallel into a lock-free union-find,
+/// roots always being the lowest cell id of their component. Region ids are then numbered 0..N-1 in
+/// order of their lowest cell id, so the result is deterministic whatever the thread scheduling.
+/// </summary>
+class GALAXY_API FHexRegionLabeler
+{
+public:
+	/// <summary>
+	/// Label connected cells sharing the same class
+	/// </summary>
+	/// <param name="grid">Grid to label</param>
+	/// <param name="cellClasses">Class of every cell, cells with a negative class are left out (region INDEX_NONE)</param>
+	/// <param name="outRegionIds">Region of every cell</param>
+	/// <param name="outRegionSizes">Number of cells of every region</param>
+	/// <returns>Number of regions</returns>
+	static int32 LabelByClass(const UHexGridAsset& grid, TConstArrayView<int32> cellClasses, TArray<int32>& outRegionIds, TArray<int32>& outRegionSizes);
+
+	/// <summary>
+	/// Label connected cells for which the predicate is true, other cells get INDEX_NONE.
+	/// The predicate is called from worker threads.
+	/// </summary>
+	static int32 LabelByPredicate(const UHexGridAsset& grid, TFunctionRef<bool(int32)> predicate, TArray<int32>& outRegionIds, TArray<int32>& outRegionSizes);
+};
@@ -0,0 +1,182 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "HexSpatialIndex.h"
+#include "HexGridRuntime.h"
+#include "Async/ParallelFor.h"
+
+void FHexSpatialIndex::Build(const FHexGridRuntime& runtime)
+{
+	Runtime = &runtime;
+	BucketSeeds.Reset();
+
+	const int32 cellCount = runtime.GetCellCount();
+	if (cellCount == 0)
+	{
+		Resolution = 0;
+		return;
+	}
+
+	// About one cell per bucket
+	Resolution = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(cellCount / 6.0f)));
+	BucketSeeds.Init(INDEX_NONE, 6 * Resolution * Resolution);
+
+	TArray<double> seedDots;
+	seedDots.Init(-2.0, BucketSeeds.Num());
+
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		const FVector& position = runtime.GetPosition(cellId);
+		const int32 bucketIndex = GetBucketIndex(position);
+
+		double dot = FVector::DotProduct(position, GetBucketDirection(bucketIndex));
+		if (dot > seedDots[bucketIndex])
+		{
+			seedDots[bucketIndex] = dot;
+			BucketSeeds[bucketIndex] = cellId;
+		}
+	}
+
+	// Buckets without any cell center still need a seed, walk to the cell closest to their center
+	const int32 fallbackSeed = BucketSeeds.IndexOfByPredicate([](int32 seed) { return seed != INDEX_NONE; });
+	ParallelFor(BucketSeeds.Num(), [&](int32 bucketIndex)
+		{
+			if (BucketSeeds[bucketIndex] == INDEX_NONE)
+			{
+				BucketSeeds[bucketIndex] = WalkToNearest(GetBucketDirection(bucketIndex), BucketSeeds[fallbackSeed]);
+			}
+		});
+}
+
+int32 FHexSpatialIndex::FindCell(const FVector& direction) const
+{
+	if (!IsValid() || direction.IsNearlyZero())
+	{
+		return INDEX_NONE;
+	}
+
+	return WalkToNearest(direction, BucketSeeds[GetBucketIndex(direction)]);
+}
+
+int32 FHexSpatialIndex::FindCell(const FVector& direction, int32 hintCellId) const
+{
+	if (!IsValid() || direction.IsNearlyZero())
+	{
+		return INDEX_NONE;
+	}
+
+	if (!Runtime->IsValidCell(hintCellId))
+	{
+		return FindCell(direction);
+	}
+
+	return WalkToNearest(direction, hintCellId);
+}
+
+bool FHexSpatialIndex::IntersectRaySphere(const FVector& rayOrigin, const FVector& rayDirection, double sphereRadius, FVector& outHitPosition)
+{
+	const double a = FVector::DotProduct(rayDirection, rayDirection);
+	if (a <= UE_DOUBLE_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const double b = 2.0 * FVector::DotProduct(rayOrigin, rayDirection);
+	const double c = FVector::DotProduct(rayOrigin, rayOrigin) - sphereRadius * sphereRadius;
+	const double discriminant = b * b - 4.0 * a * c;
+	if (discriminant < 0.0)
+	{
+		return false;
+	}
+
+	const double root = FMath::Sqrt(discriminant);
+	const double tNear = (-b - root) / (2.0 * a);
+	const double tFar = (-b + root) / (2.0 * a);
+	if (tFar < 0.0)
+	{
+		return false;
+	}
+
+	outHitPosition = rayOrigin + rayDirection * (tNear >= 0.0 ? tNear : tFar);
+	return true;
+}
+
+int32 FHexSpatialIndex::GetBucketIndex(const FVector& direction) const
+{
+	const FVector absolute = direction.GetAbs();
+
+	// Cube face from the major axis, then the two other components projected on that face
+	int32 face;
+	double u, v;
+	if (absolute.X >= absolute.Y && absolute.X >= absolute.Z)
+	{
+		face = direction.X >= 0.0 ? 0 : 1;
+		u = direction.Y / absolute.X;
+		v = direction.Z / absolute.X;
+	}
+	else if (absolute.Y >= absolute.Z)
+	{
+		face = direction.Y >= 0.0 ? 2 : 3;
+		u = direction.X / absolute.Y;
+		v = direction.Z / absolute.Y;
+	}
+	else
+	{
+		face = direction.Z >= 0.0 ? 4 : 5;
+		u = direction.X / absolute.Z;
+		v = direction.Y / absolute.Z;
+	}
+
+	const int32 i = FMath::Clamp(FMath::FloorToInt32((u + 1.0) * 0.5 * Resolution), 0, Resolution - 1);
+	const int32 j = FMath::Clamp(FMath::FloorToInt32((v + 1.0) * 0.5 * Resolution), 0, Resolution - 1);
+
+	return (face * Resolution + j) * Resolution + i;
+}
+
+FVector FHexSpatialIndex::GetBucketDirection(int32 bucketIndex) const
+{
+	const int32 i = bucketIndex % Resolution;
+	const int32 j = (bucketIndex / Resolution) % Resolution;
+	const int32 face = bucketIndex / (Resolution * Resolution);
+
+	const double u = (i + 0.5) / Resolution * 2.0 - 1.0;
+	const double v = (j + 0.5) / Resolution * 2.0 - 1.0;
+	const double sign = (face & 1) ? -1.0 : 1.0;
+
+	switch (face / 2)
+	{
+	case 0:		return FVector(sign, u, v).GetSafeNormal();
+	case 1:		return FVector(u, sign, v).GetSafeNormal();
+	default:	return FVector(u, v, sign).GetSafeNormal();
+	}
+}
+
+int32 FHexSpatialIndex::WalkToNearest(const FVector& direction, int32 startCellId) const
+{
+	// Greedy walk on the dual triangulation, the dot product is highest for the closest center
+	int32 currentCellId = startCellId;
+	double bestDot = FVector::DotProduct(direction, Runtime->GetPosition(currentCellId));
+
+	for (int32 step = 0; step < Runtime->GetCellCount(); ++step)
+	{
+		int32 nextCellId = INDEX_NONE;
+		for (uint32 neighborId : Runtime->GetNeighbors(currentCellId))
+		{
+			double dot = FVector::DotProduct(direction, Runtime->GetPosition(neighborId));
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				nextCellId = static_cast<int32>(neighborId);
+			}
+		}
+
+		if (nextCellId == INDEX_NONE)
+		{
+			break;
+		}
+
+		currentCellId = nextCellId;
+	}
+
+	return currentCellId;
+}
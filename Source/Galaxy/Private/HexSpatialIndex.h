@@ -0,0 +1,56 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FHexGridRuntime;
+
+/// <summary>
+/// Point location on a hex grid sphere.
+///
+/// Directions are bucketed on a cube map with about one cell per bucket, each bucket stores the cell
+/// closest to its center. A query starts from the bucket cell and walks to the neighbor closest to the
+/// direction until no neighbor is closer, which takes a couple of steps instead of scanning every cell.
+/// Read-only once built, safe to query from multiple threads.
+/// </summary>
+class GALAXY_API FHexSpatialIndex
+{
+public:
+	/// <summary>
+	/// Build the index for a grid runtime, the runtime must outlive the index
+	/// </summary>
+	void Build(const FHexGridRuntime& runtime);
+
+	bool IsValid() const { return Runtime != nullptr && BucketSeeds.Num() > 0; }
+
+	/// <summary>
+	/// Find the cell containing a direction from the sphere center (any length)
+	/// </summary>
+	int32 FindCell(const FVector& direction) const;
+
+	/// <summary>
+	/// Find the cell containing a direction, starting the walk from a nearby cell (previous hover result, ...)
+	/// </summary>
+	int32 FindCell(const FVector& direction, int32 hintCellId) const;
+
+	/// <summary>
+	/// Intersect a ray with a sphere centered on the origin
+	/// </summary>
+	/// <param name="rayOrigin">Ray origin</param>
+	/// <param name="rayDirection">Ray direction, does not need to be normalized</param>
+	/// <param name="sphereRadius">Sphere radius</param>
+	/// <param name="outHitPosition">First point where the ray hits the sphere (exit point when starting inside)</param>
+	/// <returns>True if the ray hits the sphere</returns>
+	static bool IntersectRaySphere(const FVector& rayOrigin, const FVector& rayDirection, double sphereRadius, FVector& outHitPosition);
+
+private:
+	int32 GetBucketIndex(const FVector& direction) const;
+	FVector GetBucketDirection(int32 bucketIndex) const;
+	int32 WalkToNearest(const FVector& direction, int32 startCellId) const;
+
+	const FHexGridRuntime* Runtime = nullptr;
+	int32 Resolution = 0;
+	TArray<int32> BucketSeeds;
+};
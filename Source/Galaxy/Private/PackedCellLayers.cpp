@@ -0,0 +1,187 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PackedCellLayers.h"
+
+namespace
+{
+	// Straight loops over raw pointers, without branches per element so the compiler can vectorize them
+	template<typename StorageType>
+	void NarrowValues(const int32* RESTRICT source, StorageType* RESTRICT target, int32 count)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			target[i] = static_cast<StorageType>(source[i]);
+		}
+	}
+
+	template<typename StorageType>
+	void WidenValues(const StorageType* RESTRICT source, int32* RESTRICT target, int32 count)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			target[i] = source[i];
+		}
+	}
+}
+
+// === Nibble layer ===
+
+void FPackedNibbleLayer::Init(int32 InCount, int32 InMinValue)
+{
+	Count = InCount;
+	MinValue = InMinValue;
+
+	const uint8 zero = static_cast<uint8>(FMath::Clamp(-MinValue, 0, 15));
+	Data.Init(static_cast<uint8>(zero | (zero << 4)), (Count + 1) / 2);
+}
+
+void FPackedNibbleLayer::Empty()
+{
+	Data.Empty();
+	Count = 0;
+}
+
+void FPackedNibbleLayer::Pack(TConstArrayView<int32> Values)
+{
+	check(Values.Num() == Count);
+
+	const int32 pairCount = Count / 2;
+	const int32* RESTRICT source = Values.GetData();
+	uint8* RESTRICT target = Data.GetData();
+
+	for (int32 pair = 0; pair < pairCount; ++pair)
+	{
+		const uint8 low = static_cast<uint8>(FMath::Clamp(source[2 * pair] - MinValue, 0, 15));
+		const uint8 high = static_cast<uint8>(FMath::Clamp(source[2 * pair + 1] - MinValue, 0, 15));
+		target[pair] = static_cast<uint8>(low | (high << 4));
+	}
+
+	if (Count & 1)
+	{
+		Set(Count - 1, source[Count - 1]);
+	}
+}
+
+void FPackedNibbleLayer::Unpack(TArrayView<int32> OutValues) const
+{
+	check(OutValues.Num() == Count);
+
+	const int32 pairCount = Count / 2;
+	const uint8* RESTRICT source = Data.GetData();
+	int32* RESTRICT target = OutValues.GetData();
+
+	for (int32 pair = 0; pair < pairCount; ++pair)
+	{
+		target[2 * pair] = MinValue + (source[pair] & 0xF);
+		target[2 * pair + 1] = MinValue + (source[pair] >> 4);
+	}
+
+	if (Count & 1)
+	{
+		target[Count - 1] = Get(Count - 1);
+	}
+}
+
+// === Id layer ===
+
+void FPackedIdLayer::Init(int32 InCount, int32 InitialValue)
+{
+	Count = InCount;
+	BytesPerElement = GetRequiredBytes(InitialValue, InitialValue);
+	Data.SetNumUninitialized(Count * BytesPerElement);
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Set(i, InitialValue);
+	}
+}
+
+void FPackedIdLayer::Empty()
+{
+	Data.Empty();
+	Count = 0;
+	BytesPerElement = 1;
+}
+
+void FPackedIdLayer::Set(int32 Index, int32 Value)
+{
+	const int32 requiredBytes = GetRequiredBytes(Value, Value);
+	if (requiredBytes > BytesPerElement)
+	{
+		Widen(requiredBytes);
+	}
+
+	switch (BytesPerElement)
+	{
+	case 1:		reinterpret_cast<int8*>(Data.GetData())[Index] = static_cast<int8>(Value); break;
+	case 2:		reinterpret_cast<int16*>(Data.GetData())[Index] = static_cast<int16>(Value); break;
+	default:	reinterpret_cast<int32*>(Data.GetData())[Index] = Value; break;
+	}
+}
+
+void FPackedIdLayer::Pack(TConstArrayView<int32> Values)
+{
+	check(Values.Num() == Count);
+
+	int32 minValue = 0;
+	int32 maxValue = 0;
+	for (int32 value : Values)
+	{
+		minValue = FMath::Min(minValue, value);
+		maxValue = FMath::Max(maxValue, value);
+	}
+
+	BytesPerElement = GetRequiredBytes(minValue, maxValue);
+	Data.SetNumUninitialized(Count * BytesPerElement);
+
+	switch (BytesPerElement)
+	{
+	case 1:		NarrowValues(Values.GetData(), reinterpret_cast<int8*>(Data.GetData()), Count); break;
+	case 2:		NarrowValues(Values.GetData(), reinterpret_cast<int16*>(Data.GetData()), Count); break;
+	default:	FMemory::Memcpy(Data.GetData(), Values.GetData(), Count * sizeof(int32)); break;
+	}
+}
+
+void FPackedIdLayer::Unpack(TArrayView<int32> OutValues) const
+{
+	check(OutValues.Num() == Count);
+
+	switch (BytesPerElement)
+	{
+	case 1:		WidenValues(reinterpret_cast<const int8*>(Data.GetData()), OutValues.GetData(), Count); break;
+	case 2:		WidenValues(reinterpret_cast<const int16*>(Data.GetData()), OutValues.GetData(), Count); break;
+	default:	FMemory::Memcpy(OutValues.GetData(), Data.GetData(), Count * sizeof(int32)); break;
+	}
+}
+
+int32 FPackedIdLayer::GetRequiredBytes(int32 MinValue, int32 MaxValue)
+{
+	if (MinValue >= MIN_int8 && MaxValue <= MAX_int8)
+	{
+		return 1;
+	}
+
+	if (MinValue >= MIN_int16 && MaxValue <= MAX_int16)
+	{
+		return 2;
+	}
+
+	return 4;
+}
+
+void FPackedIdLayer::Widen(int32 NewBytesPerElement)
+{
+	TArray<int32> values;
+	values.SetNumUninitialized(Count);
+	Unpack(values);
+
+	BytesPerElement = NewBytesPerElement;
+	Data.SetNumUninitialized(Count * BytesPerElement);
+
+	switch (BytesPerElement)
+	{
+	case 2:		NarrowValues(values.GetData(), reinterpret_cast<int16*>(Data.GetData()), Count); break;
+	default:	FMemory::Memcpy(Data.GetData(), values.GetData(), Count * sizeof(int32)); break;
+	}
+}
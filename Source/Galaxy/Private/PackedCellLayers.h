@@ -0,0 +1,107 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PackedCellLayers.generated.h"
+
+/**
+ * Small integers (16 consecutive values from MinValue) packed two per byte.
+ * Cell i uses the low nibble of byte i / 2 when i is even, the high nibble when odd.
+ */
+USTRUCT()
+struct GALAXY_API FPackedNibbleLayer
+{
+	GENERATED_BODY()
+
+public:
+	/** Allocate the layer, every cell holds Clamp(0, MinValue, MinValue + 15) */
+	void Init(int32 InCount, int32 InMinValue);
+	void Empty();
+
+	int32 Num() const { return Count; }
+	int32 GetMinValue() const { return MinValue; }
+	int32 GetMaxValue() const { return MinValue + 15; }
+
+	int32 Get(int32 Index) const
+	{
+		return MinValue + ((Data[Index >> 1] >> ((Index & 1) << 2)) & 0xF);
+	}
+
+	/** Values outside [MinValue, MinValue + 15] are clamped */
+	void Set(int32 Index, int32 Value)
+	{
+		const uint8 nibble = static_cast<uint8>(FMath::Clamp(Value - MinValue, 0, 15));
+		const int32 shift = (Index & 1) << 2;
+		Data[Index >> 1] = static_cast<uint8>((Data[Index >> 1] & ~(0xF << shift)) | (nibble << shift));
+	}
+
+	/** Bulk conversion, Values.Num() must equal Num() */
+	void Pack(TConstArrayView<int32> Values);
+	void Unpack(TArrayView<int32> OutValues) const;
+
+	TConstArrayView<uint8> GetBytes() const { return Data; }
+
+private:
+	UPROPERTY()
+	TArray<uint8> Data;
+
+	UPROPERTY()
+	int32 Count = 0;
+
+	UPROPERTY()
+	int32 MinValue = 0;
+};
+
+/**
+ * Integer ids stored with the smallest signed width holding every value (8, 16 or 32 bits).
+ * Storage widens automatically when a larger value is written, and never narrows except through Pack.
+ */
+USTRUCT()
+struct GALAXY_API FPackedIdLayer
+{
+	GENERATED_BODY()
+
+public:
+	/** Allocate the layer with 8-bit storage, every cell holds InitialValue */
+	void Init(int32 InCount, int32 InitialValue = 0);
+	void Empty();
+
+	int32 Num() const { return Count; }
+	int32 GetBytesPerElement() const { return BytesPerElement; }
+
+	int32 Get(int32 Index) const
+	{
+		switch (BytesPerElement)
+		{
+		case 1:		return reinterpret_cast<const int8*>(Data.GetData())[Index];
+		case 2:		return reinterpret_cast<const int16*>(Data.GetData())[Index];
+		default:	return reinterpret_cast<const int32*>(Data.GetData())[Index];
+		}
+	}
+
+	void Set(int32 Index, int32 Value);
+
+	/** Bulk conversion picking the narrowest width for the values, Values.Num() must equal Num() */
+	void Pack(TConstArrayView<int32> Values);
+	void Unpack(TArrayView<int32> OutValues) const;
+
+	/** Raw storage, Num() elements of GetBytesPerElement() bytes */
+	TConstArrayView<uint8> GetBytes() const { return Data; }
+
+	/** Width needed to store every value in this range */
+	static int32 GetRequiredBytes(int32 MinValue, int32 MaxValue);
+
+private:
+	void Widen(int32 NewBytesPerElement);
+
+	UPROPERTY()
+	TArray<uint8> Data;
+
+	UPROPERTY()
+	int32 Count = 0;
+
+	UPROPERTY()
+	int32 BytesPerElement = 1;
+};
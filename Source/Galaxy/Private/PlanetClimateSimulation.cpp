@@ -0,0 +1,501 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetClimateSimulation.h"
+#include "PlanetData.h"
+#include "HexGridGeometry.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	/** Cells computed per ParallelFor task */
+	constexpr int32 ClimateBlockSize = 1024;
+
+	/// <summary>
+	/// Prevailing wind of a latitude (three cells per hemisphere), in the local east / north frame
+	/// </summary>
+	FVector2D GetPrevailingWind(double sinLatitude)
+	{
+		const double latitude = FMath::RadiansToDegrees(FMath::Asin(FMath::Abs(sinLatitude)));
+		const double poleward = sinLatitude >= 0.0 ? 1.0 : -1.0;
+
+		// Trade winds and polar easterlies blow west towards the equator, westerlies east towards the pole
+		if (latitude < 30.0 || latitude >= 60.0)
+		{
+			return FVector2D(-1.0, -0.5 * poleward).GetSafeNormal();
+		}
+		return FVector2D(1.0, 0.5 * poleward).GetSafeNormal();
+	}
+
+	/// <summary>
+	/// Humidity water cells evaporate towards, warmer air holds more
+	/// </summary>
+	float GetSaturationHumidity(float temperature)
+	{
+		return FMath::Clamp(0.4f + 0.02f * temperature, 0.0f, 1.0f);
+	}
+}
+
+const FName FPlanetClimateKernel::TemperatureLayerName(TEXT("Climate.Temperature"));
+const FName FPlanetClimateKernel::HumidityLayerName(TEXT("Climate.Humidity"));
+
+// === Kernel ===
+
+bool FPlanetClimateKernel::Initialize(UPlanetData& planet)
+{
+	Reset();
+
+	if (!planet.AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetClimateKernel::Initialize - Planet data layers are not initialized."));
+		return false;
+	}
+
+	const UHexGridAsset& grid = *planet.Grid;
+	const FHexGridRuntimePtr gridRuntime = grid.GetRuntime();
+	const FHexGridGeometry& geometry = gridRuntime->GetGeometry();
+	const int32 cellCount = planet.GetCellCount();
+
+	NeighborTable.SetNumUninitialized(cellCount * MaxNeighbors);
+	DiffusionWeights.SetNumZeroed(cellCount * MaxNeighbors);
+	WindWeights.SetNumZeroed(cellCount * MaxNeighbors);
+	Insolation.SetNumUninitialized(cellCount);
+
+	TArray<float> diffusionSums;
+	TArray<float> windSums;
+	diffusionSums.SetNumZeroed(cellCount);
+	windSums.SetNumZeroed(cellCount);
+
+	ParallelFor(cellCount, [&](int32 cellId)
+		{
+			const FVector position = grid.Cells[cellId].Position.GetSafeNormal();
+			const FVector east = FVector(geometry.GetTangentsEast()[cellId]);
+			const FVector north = FVector(geometry.GetTangentsNorth()[cellId]);
+			const FVector2D localWind = GetPrevailingWind(position.Z);
+			const FVector wind = east * localWind.X + north * localWind.Y;
+			const float area = FMath::Max(geometry.GetCellArea(cellId), UE_KINDA_SMALL_NUMBER);
+
+			Insolation[cellId] = static_cast<float>(FMath::Sqrt(FMath::Max(0.0, 1.0 - position.Z * position.Z)));
+
+			TConstArrayView<uint32> neighbors = grid.GetNeighborView(cellId);
+			for (int32 slot = 0; slot < MaxNeighbors; ++slot)
+			{
+				const int32 index = slot * cellCount + cellId;
+				if (slot >= neighbors.Num())
+				{
+					NeighborTable[index] = cellId;
+					continue;
+				}
+
+				const int32 neighborId = static_cast<int32>(neighbors[slot]);
+				const FVector neighborPosition = grid.Cells[neighborId].Position.GetSafeNormal();
+				const float distance = static_cast<float>(FMath::Acos(FMath::Clamp(FVector::DotProduct(position, neighborPosition), -1.0, 1.0)));
+				const float edgeLength = geometry.GetEdgeLength(cellId, slot);
+
+				// Finite volume Laplacian: flux through the shared edge over the distance between centers
+				NeighborTable[index] = neighborId;
+				DiffusionWeights[index] = distance > UE_KINDA_SMALL_NUMBER ? edgeLength / (distance * area) : 0.0f;
+
+				// Air flows in through the edges facing the wind
+				const FVector toNeighbor = (neighborPosition - position).GetSafeNormal();
+				WindWeights[index] = FMath::Max(0.0f, static_cast<float>(-FVector::DotProduct(wind, toNeighbor))) * edgeLength / area;
+
+				diffusionSums[cellId] += DiffusionWeights[index];
+				windSums[cellId] += WindWeights[index];
+			}
+		});
+
+	// Normalize so a rate of 1 exchanges at most the whole cell value, the explicit step stays stable
+	const float maxDiffusion = FMath::Max(FMath::Max(diffusionSums), UE_KINDA_SMALL_NUMBER);
+	const float maxWind = FMath::Max(FMath::Max(windSums), UE_KINDA_SMALL_NUMBER);
+	for (int32 i = 0; i < DiffusionWeights.Num(); ++i)
+	{
+		DiffusionWeights[i] /= maxDiffusion;
+		WindWeights[i] /= maxWind;
+	}
+
+	Elevation.SetNumUninitialized(cellCount);
+	EquilibriumTemperature.SetNumUninitialized(cellCount);
+	SourceTarget.SetNumUninitialized(cellCount);
+	SourceRate.SetNumUninitialized(cellCount);
+
+	FPlanetLayerRegistry& registry = planet.GetLayerRegistry();
+	TemperatureLayer = registry.RegisterLayer(TemperatureLayerName, EPlanetLayerType::Float, true);
+	HumidityLayer = registry.RegisterLayer(HumidityLayerName, EPlanetLayerType::Float, true);
+	if (!registry.IsValidLayer(TemperatureLayer) || !registry.IsValidLayer(HumidityLayer))
+	{
+		Reset();
+		return false;
+	}
+
+	CellCount = cellCount;
+	GridRuntime = gridRuntime;
+	return true;
+}
+
+bool FPlanetClimateKernel::IsBuiltFor(const UPlanetData& planet) const
+{
+	return IsInitialized() && planet.Grid && CellCount == planet.GetCellCount() && GridRuntime == planet.Grid->GetRuntime();
+}
+
+void FPlanetClimateKernel::Reset()
+{
+	CellCount = 0;
+	GridRuntime.Reset();
+	NeighborTable.Empty();
+	DiffusionWeights.Empty();
+	WindWeights.Empty();
+	Insolation.Empty();
+	Elevation.Empty();
+	EquilibriumTemperature.Empty();
+	SourceTarget.Empty();
+	SourceRate.Empty();
+	ReadTemperature = nullptr;
+	ReadHumidity = nullptr;
+	WriteTemperature = nullptr;
+	WriteHumidity = nullptr;
+	TemperatureLayer = FPlanetLayerHandle();
+	HumidityLayer = FPlanetLayerHandle();
+}
+
+void FPlanetClimateKernel::InitializeClimate(UPlanetData& planet, const FPlanetClimateSettings& settings, float humidity) const
+{
+	if (!IsInitialized() || planet.GetCellCount() != CellCount)
+	{
+		return;
+	}
+
+	for (int32 cellId = 0; cellId < CellCount; ++cellId)
+	{
+		const float altitude = static_cast<float>(FMath::Max(0, planet.ElevationLayer.Get(cellId) - planet.WaterLevel));
+		planet.CellTemperature[cellId] = FMath::Lerp(settings.PoleTemperature, settings.EquatorTemperature, Insolation[cellId])
+			- settings.LapseRatePerLevel * altitude;
+		planet.CellHumidity[cellId] = FMath::Clamp(humidity, 0.0f, 1.0f);
+	}
+
+	planet.MarkLayerDirty(EPlanetDataLayer::Temperature);
+	planet.MarkLayerDirty(EPlanetDataLayer::Humidity);
+}
+
+void FPlanetClimateKernel::BeginStep(UPlanetData& planet, const FPlanetClimateSettings& settings)
+{
+	check(IsInitialized() && planet.GetCellCount() == CellCount);
+
+	StepSettings = settings;
+
+	// Publish the current state through a swap, buffers held by snapshots are never written
+	FPlanetLayerRegistry& registry = planet.GetLayerRegistry();
+	FMemory::Memcpy(registry.GetBackView<float>(TemperatureLayer).GetData(), planet.CellTemperature.GetData(), CellCount * sizeof(float));
+	FMemory::Memcpy(registry.GetBackView<float>(HumidityLayer).GetData(), planet.CellHumidity.GetData(), CellCount * sizeof(float));
+	registry.SwapBuffers(TemperatureLayer);
+	registry.SwapBuffers(HumidityLayer);
+
+	ReadTemperature = registry.GetView<float>(TemperatureLayer).GetData();
+	ReadHumidity = registry.GetView<float>(HumidityLayer).GetData();
+	WriteTemperature = registry.GetBackView<float>(TemperatureLayer).GetData();
+	WriteHumidity = registry.GetBackView<float>(HumidityLayer).GetData();
+
+	const UPlanetData& source = planet;
+	ParallelFor(FMath::DivideAndRoundUp(CellCount, ClimateBlockSize), [&](int32 blockIndex)
+		{
+			const int32 endCellId = FMath::Min(CellCount, (blockIndex + 1) * ClimateBlockSize);
+			for (int32 cellId = blockIndex * ClimateBlockSize; cellId < endCellId; ++cellId)
+			{
+				const int32 altitude = source.ElevationLayer.Get(cellId) - source.WaterLevel;
+				const bool bUnderwater = altitude <= 0;
+
+				Elevation[cellId] = static_cast<float>(altitude);
+				EquilibriumTemperature[cellId] = FMath::Lerp(settings.PoleTemperature, settings.EquatorTemperature, Insolation[cellId])
+					- settings.LapseRatePerLevel * FMath::Max(0, altitude);
+				SourceTarget[cellId] = bUnderwater ? GetSaturationHumidity(ReadTemperature[cellId]) : 0.0f;
+				SourceRate[cellId] = bUnderwater ? settings.Evaporation : settings.LandDrying;
+			}
+		});
+}
+
+void FPlanetClimateKernel::StepRange(int32 beginCellId, int32 endCellId)
+{
+	check(ReadTemperature != nullptr && beginCellId >= 0 && endCellId <= CellCount);
+
+	const VectorRegister4Float zero = VectorZeroFloat();
+	const VectorRegister4Float one = VectorOneFloat();
+	const VectorRegister4Float heatDiffusion = VectorSetFloat1(StepSettings.HeatDiffusion);
+	const VectorRegister4Float relaxation = VectorSetFloat1(StepSettings.ThermalRelaxation);
+	const VectorRegister4Float humidityDiffusion = VectorSetFloat1(StepSettings.HumidityDiffusion);
+	const VectorRegister4Float windTransport = VectorSetFloat1(StepSettings.WindTransport);
+	const VectorRegister4Float orographicLoss = VectorSetFloat1(StepSettings.OrographicLoss);
+
+	int32 cellId = beginCellId;
+	const int32 simdEndCellId = beginCellId + ((endCellId - beginCellId) / SimdWidth) * SimdWidth;
+	for (; cellId < simdEndCellId; cellId += SimdWidth)
+	{
+		const VectorRegister4Float temperature = VectorLoad(ReadTemperature + cellId);
+		const VectorRegister4Float humidity = VectorLoad(ReadHumidity + cellId);
+		const VectorRegister4Float elevation = VectorLoad(Elevation.GetData() + cellId);
+
+		VectorRegister4Float heatFlux = zero;
+		VectorRegister4Float humidityFlux = zero;
+		VectorRegister4Float inflow = zero;
+
+		for (int32 slot = 0; slot < MaxNeighbors; ++slot)
+		{
+			const int32 index = slot * CellCount + cellId;
+			const int32* neighbors = NeighborTable.GetData() + index;
+
+			const VectorRegister4Float neighborTemperature = MakeVectorRegister(
+				ReadTemperature[neighbors[0]], ReadTemperature[neighbors[1]], ReadTemperature[neighbors[2]], ReadTemperature[neighbors[3]]);
+			const VectorRegister4Float neighborHumidity = MakeVectorRegister(
+				ReadHumidity[neighbors[0]], ReadHumidity[neighbors[1]], ReadHumidity[neighbors[2]], ReadHumidity[neighbors[3]]);
+			const VectorRegister4Float neighborElevation = MakeVectorRegister(
+				Elevation[neighbors[0]], Elevation[neighbors[1]], Elevation[neighbors[2]], Elevation[neighbors[3]]);
+
+			const VectorRegister4Float diffusionWeight = VectorLoad(DiffusionWeights.GetData() + index);
+			const VectorRegister4Float windWeight = VectorLoad(WindWeights.GetData() + index);
+
+			heatFlux = VectorMultiplyAdd(diffusionWeight, VectorSubtract(neighborTemperature, temperature), heatFlux);
+			humidityFlux = VectorMultiplyAdd(diffusionWeight, VectorSubtract(neighborHumidity, humidity), humidityFlux);
+
+			// Air climbing to this cell rains part of its humidity out on the way
+			const VectorRegister4Float lift = VectorMax(VectorSubtract(elevation, neighborElevation), zero);
+			const VectorRegister4Float kept = VectorMax(VectorSubtract(one, VectorMultiply(lift, orographicLoss)), zero);
+			inflow = VectorMultiplyAdd(windWeight, VectorSubtract(VectorMultiply(neighborHumidity, kept), humidity), inflow);
+		}
+
+		const VectorRegister4Float equilibrium = VectorLoad(EquilibriumTemperature.GetData() + cellId);
+		VectorRegister4Float newTemperature = VectorMultiplyAdd(heatDiffusion, heatFlux, temperature);
+		newTemperature = VectorMultiplyAdd(relaxation, VectorSubtract(equilibrium, temperature), newTemperature);
+
+		const VectorRegister4Float sourceTarget = VectorLoad(SourceTarget.GetData() + cellId);
+		const VectorRegister4Float sourceRate = VectorLoad(SourceRate.GetData() + cellId);
+		VectorRegister4Float newHumidity = VectorMultiplyAdd(humidityDiffusion, humidityFlux, humidity);
+		newHumidity = VectorMultiplyAdd(windTransport, inflow, newHumidity);
+		newHumidity = VectorMultiplyAdd(sourceRate, VectorSubtract(sourceTarget, humidity), newHumidity);
+		newHumidity = VectorMin(VectorMax(newHumidity, zero), one);
+
+		VectorStore(newTemperature, WriteTemperature + cellId);
+		VectorStore(newHumidity, WriteHumidity + cellId);
+	}
+
+	for (; cellId < endCellId; ++cellId)
+	{
+		StepCell(cellId);
+	}
+}
+
+void FPlanetClimateKernel::StepCell(int32 cellId)
+{
+	const float temperature = ReadTemperature[cellId];
+	const float humidity = ReadHumidity[cellId];
+
+	float heatFlux = 0.0f;
+	float humidityFlux = 0.0f;
+	float inflow = 0.0f;
+
+	for (int32 slot = 0; slot < MaxNeighbors; ++slot)
+	{
+		const int32 index = slot * CellCount + cellId;
+		const int32 neighborId = NeighborTable[index];
+
+		heatFlux += DiffusionWeights[index] * (ReadTemperature[neighborId] - temperature);
+		humidityFlux += DiffusionWeights[index] * (ReadHumidity[neighborId] - humidity);
+
+		const float lift = FMath::Max(Elevation[cellId] - Elevation[neighborId], 0.0f);
+		const float kept = FMath::Max(1.0f - lift * StepSettings.OrographicLoss, 0.0f);
+		inflow += WindWeights[index] * (ReadHumidity[neighborId] * kept - humidity);
+	}
+
+	WriteTemperature[cellId] = temperature
+		+ StepSettings.HeatDiffusion * heatFlux
+		+ StepSettings.ThermalRelaxation * (EquilibriumTemperature[cellId] - temperature);
+
+	WriteHumidity[cellId] = FMath::Clamp(humidity
+		+ StepSettings.HumidityDiffusion * humidityFlux
+		+ StepSettings.WindTransport * inflow
+		+ SourceRate[cellId] * (SourceTarget[cellId] - humidity), 0.0f, 1.0f);
+}
+
+void FPlanetClimateKernel::EndStep(UPlanetData& planet)
+{
+	check(IsInitialized() && planet.GetCellCount() == CellCount);
+
+	FPlanetLayerRegistry& registry = planet.GetLayerRegistry();
+	registry.SwapBuffers(TemperatureLayer);
+	registry.SwapBuffers(HumidityLayer);
+
+	FMemory::Memcpy(planet.CellTemperature.GetData(), registry.GetView<float>(TemperatureLayer).GetData(), CellCount * sizeof(float));
+	FMemory::Memcpy(planet.CellHumidity.GetData(), registry.GetView<float>(HumidityLayer).GetData(), CellCount * sizeof(float));
+
+	ReadTemperature = nullptr;
+	ReadHumidity = nullptr;
+	WriteTemperature = nullptr;
+	WriteHumidity = nullptr;
+
+	planet.MarkLayerDirty(EPlanetDataLayer::Temperature);
+	planet.MarkLayerDirty(EPlanetDataLayer::Humidity);
+}
+
+bool FPlanetClimateKernel::IsStepValid(const UPlanetData& planet) const
+{
+	if (ReadTemperature == nullptr || planet.GetCellCount() != CellCount)
+	{
+		return false;
+	}
+
+	const FPlanetLayerRegistry& registry = planet.GetLayerRegistry();
+	return registry.GetView<float>(TemperatureLayer).GetData() == ReadTemperature
+		&& registry.GetView<float>(HumidityLayer).GetData() == ReadHumidity;
+}
+
+void FPlanetClimateKernel::Step(UPlanetData& planet, const FPlanetClimateSettings& settings)
+{
+	BeginStep(planet, settings);
+
+	ParallelFor(FMath::DivideAndRoundUp(CellCount, ClimateBlockSize), [&](int32 blockIndex)
+		{
+			StepRange(blockIndex * ClimateBlockSize, FMath::Min(CellCount, (blockIndex + 1) * ClimateBlockSize));
+		});
+
+	EndStep(planet);
+}
+
+// === Component ===
+
+UPlanetClimateSimulation::UPlanetClimateSimulation()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UPlanetClimateSimulation::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!Planet && GetOwner())
+	{
+		Planet = GetOwner()->FindComponentByClass<UPlanetData>();
+	}
+}
+
+void UPlanetClimateSimulation::InitializeClimate(float Humidity)
+{
+	if (EnsureKernel())
+	{
+		AbortStep();
+		Kernel.InitializeClimate(*Planet, Settings, Humidity);
+	}
+}
+
+void UPlanetClimateSimulation::RunSteps(int32 StepCount)
+{
+	if (!EnsureKernel())
+	{
+		return;
+	}
+
+	AbortStep();
+	for (int32 i = 0; i < StepCount; ++i)
+	{
+		Kernel.Step(*Planet, Settings);
+		++CompletedSteps;
+	}
+}
+
+void UPlanetClimateSimulation::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!bSimulate || !EnsureKernel())
+	{
+		return;
+	}
+
+	TimeAccumulator += DeltaTime;
+	while (TimeAccumulator >= StepInterval)
+	{
+		TimeAccumulator -= StepInterval;
+		++PendingSteps;
+	}
+	PendingSteps = FMath::Min(PendingSteps, MaxPendingSteps);
+
+	if (PendingSteps > 0 || NextCellId != INDEX_NONE)
+	{
+		AdvanceSteps(FPlatformTime::Seconds() + FrameBudgetMs * 0.001);
+	}
+}
+
+bool UPlanetClimateSimulation::EnsureKernel()
+{
+	if (!Planet || !Planet->AreDataLayersInitialized())
+	{
+		AbortStep();
+		return false;
+	}
+
+	// Another grid or rebuilt cells invalidate the neighbor table and weights, even with the same cell count
+	if (!Kernel.IsBuiltFor(*Planet))
+	{
+		AbortStep();
+		Kernel.Initialize(*Planet);
+	}
+	else if (NextCellId != INDEX_NONE && !Kernel.IsStepValid(*Planet))
+	{
+		AbortStep();
+	}
+
+	return Kernel.IsInitialized();
+}
+
+void UPlanetClimateSimulation::AbortStep()
+{
+	// The back buffers are simply overwritten by the next step
+	NextCellId = INDEX_NONE;
+}
+
+void UPlanetClimateSimulation::AdvanceSteps(double deadline)
+{
+	const int32 cellCount = Kernel.GetCellCount();
+
+	while (true)
+	{
+		if (NextCellId == INDEX_NONE)
+		{
+			if (PendingSteps == 0)
+			{
+				return;
+			}
+
+			--PendingSteps;
+			Kernel.BeginStep(*Planet, Settings);
+			NextCellId = 0;
+		}
+
+		const double sliceStart = FPlatformTime::Seconds();
+		if (sliceStart >= deadline)
+		{
+			return;
+		}
+
+		// Size the slice from the measured cost, at least one block so every frame makes progress
+		int32 sliceCells = SecondsPerCell > 0.0 ? static_cast<int32>(FMath::Min((deadline - sliceStart) / SecondsPerCell, static_cast<double>(cellCount))) : ClimateBlockSize;
+		sliceCells = FMath::Min(FMath::Max(sliceCells, ClimateBlockSize), cellCount - NextCellId);
+
+		const int32 beginCellId = NextCellId;
+		const int32 endCellId = beginCellId + sliceCells;
+		ParallelFor(FMath::DivideAndRoundUp(sliceCells, ClimateBlockSize), [&](int32 blockIndex)
+			{
+				const int32 blockBegin = beginCellId + blockIndex * ClimateBlockSize;
+				Kernel.StepRange(blockBegin, FMath::Min(endCellId, blockBegin + ClimateBlockSize));
+			});
+
+		const double measured = (FPlatformTime::Seconds() - sliceStart) / sliceCells;
+		SecondsPerCell = SecondsPerCell > 0.0 ? FMath::Lerp(SecondsPerCell, measured, 0.25) : measured;
+
+		NextCellId = endCellId;
+		if (NextCellId >= cellCount)
+		{
+			Kernel.EndStep(*Planet);
+			NextCellId = INDEX_NONE;
+			++CompletedSteps;
+		}
+	}
+}
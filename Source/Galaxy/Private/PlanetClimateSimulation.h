@@ -0,0 +1,238 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "PlanetLayerRegistry.h"
+#include "HexGridRuntime.h"
+#include "PlanetClimateSimulation.generated.h"
+
+class UPlanetData;
+
+/**
+ * Climate model parameters, rates are applied once per step
+ */
+USTRUCT(BlueprintType)
+struct GALAXY_API FPlanetClimateSettings
+{
+	GENERATED_BODY()
+
+	/** Equilibrium temperature at sea level on the equator */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Temperature")
+	float EquatorTemperature = 30.0f;
+
+	/** Equilibrium temperature at sea level on the poles */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Temperature")
+	float PoleTemperature = -25.0f;
+
+	/** Temperature drop per elevation level above the water level */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Temperature", meta = (ClampMin = "0"))
+	float LapseRatePerLevel = 6.0f;
+
+	/** Fraction of the temperature difference with the neighbors exchanged per step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Temperature", meta = (ClampMin = "0", ClampMax = "1"))
+	float HeatDiffusion = 0.2f;
+
+	/** Fraction of the gap to the equilibrium temperature closed per step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Temperature", meta = (ClampMin = "0", ClampMax = "1"))
+	float ThermalRelaxation = 0.05f;
+
+	/** Fraction of the humidity difference with the neighbors exchanged per step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Humidity", meta = (ClampMin = "0", ClampMax = "1"))
+	float HumidityDiffusion = 0.1f;
+
+	/** Fraction of the humidity carried in from upwind neighbors per step (prevailing winds by latitude) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Humidity", meta = (ClampMin = "0", ClampMax = "1"))
+	float WindTransport = 0.3f;
+
+	/** Fraction of the gap to saturation closed per step over water */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Humidity", meta = (ClampMin = "0", ClampMax = "1"))
+	float Evaporation = 0.1f;
+
+	/** Fraction of the humidity lost per step over land */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Humidity", meta = (ClampMin = "0", ClampMax = "1"))
+	float LandDrying = 0.01f;
+
+	/** Fraction of the carried humidity that rains out per elevation level the air climbs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Humidity", meta = (ClampMin = "0", ClampMax = "1"))
+	float OrographicLoss = 0.25f;
+};
+
+/// <summary>
+/// Explicit climate step over the cell graph: insolation by latitude, heat diffusion weighted by shared
+/// edge length, humidity transport by diffusion and prevailing winds, orographic rain shadows.
+///
+/// Neighbors and weights are flattened slot-major (slot * CellCount + cell) so 4 consecutive
+/// cells are updated together with SIMD, their neighbor values gathered from the read buffer.
+/// Unused slots point at the cell itself with a weight of 0.
+///
+/// Temperature and humidity are double buffered layers of the planet's registry: a step publishes the
+/// planet arrays as the front, writes the back in any number of StepRange calls (from any thread),
+/// then swaps and copies the result back to the planet.
+/// </summary>
+class GALAXY_API FPlanetClimateKernel
+{
+public:
+	static constexpr int32 MaxNeighbors = 6;
+	static constexpr int32 SimdWidth = 4;
+
+	static const FName TemperatureLayerName;
+	static const FName HumidityLayerName;
+
+	/// <summary>
+	/// Build the neighbor table and static weights, registers the registry layers
+	/// </summary>
+	/// <returns>False if the planet data layers are not initialized</returns>
+	bool Initialize(UPlanetData& planet);
+
+	void Reset();
+
+	bool IsInitialized() const { return CellCount > 0; }
+	int32 GetCellCount() const { return CellCount; }
+
+	/// <summary>
+	/// True if the tables were built for the current grid runtime of the planet (same topology)
+	/// </summary>
+	bool IsBuiltFor(const UPlanetData& planet) const;
+
+	/// <summary>
+	/// Equilibrium temperature of every cell, and a uniform humidity
+	/// </summary>
+	void InitializeClimate(UPlanetData& planet, const FPlanetClimateSettings& settings, float humidity = 0.5f) const;
+
+	/// <summary>
+	/// Snapshot the planet state and prepare the per-step inputs (elevation, equilibrium, sources)
+	/// </summary>
+	void BeginStep(UPlanetData& planet, const FPlanetClimateSettings& settings);
+
+	/// <summary>
+	/// Compute cells [beginCellId, endCellId), thread-safe for disjoint ranges
+	/// </summary>
+	void StepRange(int32 beginCellId, int32 endCellId);
+
+	/// <summary>
+	/// Swap the buffers and write the result to the planet arrays
+	/// </summary>
+	void EndStep(UPlanetData& planet);
+
+	/// <summary>
+	/// Check the buffers of the step in progress are still the planet's (layers were not reset since BeginStep)
+	/// </summary>
+	bool IsStepValid(const UPlanetData& planet) const;
+
+	/// <summary>
+	/// Run a whole step at once, in parallel
+	/// </summary>
+	void Step(UPlanetData& planet, const FPlanetClimateSettings& settings);
+
+	FPlanetLayerHandle GetTemperatureLayer() const { return TemperatureLayer; }
+	FPlanetLayerHandle GetHumidityLayer() const { return HumidityLayer; }
+
+private:
+	void StepCell(int32 cellId);
+
+	int32 CellCount = 0;
+
+	/// <summary>
+	/// Runtime the static tables were built from, a grid with other cells gets another runtime
+	/// </summary>
+	FHexGridRuntimePtr GridRuntime;
+
+	// Static, slot-major
+	TArray<int32> NeighborTable;
+	TArray<float> DiffusionWeights;
+	TArray<float> WindWeights;
+
+	// Static, per cell
+	TArray<float> Insolation;
+
+	// Per step, per cell
+	TArray<float> Elevation;
+	TArray<float> EquilibriumTemperature;
+	TArray<float> SourceTarget;
+	TArray<float> SourceRate;
+
+	FPlanetClimateSettings StepSettings;
+
+	// Buffers of the step in progress
+	const float* ReadTemperature = nullptr;
+	const float* ReadHumidity = nullptr;
+	float* WriteTemperature = nullptr;
+	float* WriteHumidity = nullptr;
+
+	FPlanetLayerHandle TemperatureLayer;
+	FPlanetLayerHandle HumidityLayer;
+};
+
+/**
+ * Runs the climate of the planet on the same actor at a fixed timestep.
+ * Steps are split in slices across frames so the simulation never uses more than FrameBudgetMs per frame.
+ * Temperature / humidity written to the planet while a step is in progress are overwritten when it completes.
+ */
+UCLASS(classGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GALAXY_API UPlanetClimateSimulation : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPlanetClimateSimulation();
+
+	/** Planet to simulate, the owner's UPlanetData when not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate")
+	TObjectPtr<UPlanetData> Planet;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate")
+	FPlanetClimateSettings Settings;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate")
+	bool bSimulate = true;
+
+	/** Game time between two steps, in seconds */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Scheduling", meta = (ClampMin = "0.01"))
+	float StepInterval = 1.0f;
+
+	/** Time the simulation may use per frame, in milliseconds */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Scheduling", meta = (ClampMin = "0.1"))
+	float FrameBudgetMs = 2.0f;
+
+	/** Steps that may be queued when the simulation falls behind, older ones are dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Climate|Scheduling", meta = (ClampMin = "1"))
+	int32 MaxPendingSteps = 4;
+
+	/** Set every cell to its equilibrium temperature and a uniform humidity */
+	UFUNCTION(BlueprintCallable, Category = "Climate")
+	void InitializeClimate(float Humidity = 0.5f);
+
+	/** Run steps immediately, ignoring the budget */
+	UFUNCTION(BlueprintCallable, Category = "Climate")
+	void RunSteps(int32 StepCount);
+
+	UFUNCTION(BlueprintCallable, Category = "Climate")
+	int32 GetCompletedStepCount() const { return CompletedSteps; }
+
+	const FPlanetClimateKernel& GetKernel() const { return Kernel; }
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	bool EnsureKernel();
+	void AbortStep();
+
+	/** Process slices of the current and pending steps until the deadline */
+	void AdvanceSteps(double deadline);
+
+	FPlanetClimateKernel Kernel;
+
+	float TimeAccumulator = 0.0f;
+	int32 PendingSteps = 0;
+	int32 CompletedSteps = 0;
+
+	/** Next cell of the step in progress, INDEX_NONE when no step is in progress */
+	int32 NextCellId = INDEX_NONE;
+
+	/** Measured cost, used to size the slices */
+	double SecondsPerCell = 0.0;
+};
@@ -2,10 +2,34 @@
 // Noncommercial use only. Commercial use requires written permission.
 // See https://polyformproject.org/licenses/noncommercial/1.0.0/
 #include "PlanetData.h"
+#include "HexPathfinder.h"
+#include "HexFlowField.h"
+#include "HexSpatialIndex.h"
+#include "HexRegionLabeling.h"
+#include "PlanetHydrology.h"
+#include "PlanetManagerSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	/** Batches writing more than 1/N of the cells are reported as whole layer changes */
+	constexpr int32 BatchFullLayerRatio = 4;
+
+	bool IsTraversalLayer(EPlanetDataLayer layer)
+	{
+		return layer == EPlanetDataLayer::Elevation || layer == EPlanetDataLayer::Biome;
+	}
+}
 
 UPlanetData::UPlanetData()
 {
-	PrimaryComponentTick.bCanEverTick = false;
+	// Only ticks to publish the frame's changes, enabled when a cell changes
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+	RebuildBiomeLookupTables();
 }
 
 void UPlanetData::InitializeDataLayers()
@@ -16,29 +40,132 @@ void UPlanetData::InitializeDataLayers()
 		return;
 	}
 
+	// New layers replace whatever the planet had when it was hibernated
+	if (UPlanetManagerSubsystem* manager = GetWorld() ? GetWorld()->GetSubsystem<UPlanetManagerSubsystem>() : nullptr)
+	{
+		manager->DiscardHibernatedLayers(this);
+	}
+
 	int32 cellCount = Grid->TotalCellCount;
 
 	// Initialize all data layers
-	ElevationLevel.SetNumZeroed(cellCount);
+	ElevationLayer.Init(cellCount, MIN_ELEVATION_LEVEL);
 	CellTemperature.SetNumZeroed(cellCount);
 	CellHumidity.SetNumZeroed(cellCount);
-	Biome.SetNumZeroed(cellCount);
-	TectonicPlateId.SetNumZeroed(cellCount);
-	CellRegionId.SetNumZeroed(cellCount);
+	BiomeIndex.SetNumZeroed(cellCount);
+	RebuildBiomeLookupTables();
+	TectonicPlateLayer.Init(cellCount);
+	RegionLayer.Init(cellCount);
+	LayerRegistry.SetCellCount(cellCount);
+	DirtyTracker.Initialize(cellCount);
+	SetComponentTickEnabled(true);
+
+	Pathfinder.Reset();
+	OnCellDataChanged.Broadcast(INDEX_NONE);
 
 	UE_LOG(LogTemp, Log, TEXT("UPlanetData::InitializeDataLayers - Data layers initialized for %d cells."), cellCount);
 }
 
 void UPlanetData::ClearDataLayers()
 {
-	ElevationLevel.Empty();
+	ElevationLayer.Empty();
 	CellTemperature.Empty();
 	CellHumidity.Empty();
-	Biome.Empty();
-	TectonicPlateId.Empty();
-	CellRegionId.Empty();
+	BiomeIndex.Empty();
+	TectonicPlateLayer.Empty();
+	TectonicPlates.Empty();
+	RegionLayer.Empty();
+	LayerRegistry.SetCellCount(0);
+	DirtyTracker.Initialize(0);
+	SetComponentTickEnabled(true);
+
+	Pathfinder.Reset();
+	OnCellDataChanged.Broadcast(INDEX_NONE);
 }
 
+bool UPlanetData::AreDataLayersInitialized() const
+{
+	return Grid != nullptr && Grid->Cells.Num() > 0 && ElevationLayer.Num() == Grid->Cells.Num();
+}
+
+void UPlanetData::PostLoad()
+{
+	Super::PostLoad();
+
+	if (ElevationLevel_DEPRECATED.Num() > 0)
+	{
+		ElevationLayer.Init(ElevationLevel_DEPRECATED.Num(), MIN_ELEVATION_LEVEL);
+		ElevationLayer.Pack(ElevationLevel_DEPRECATED);
+		ElevationLevel_DEPRECATED.Empty();
+	}
+
+	if (TectonicPlateId_DEPRECATED.Num() > 0)
+	{
+		TectonicPlateLayer.Init(TectonicPlateId_DEPRECATED.Num());
+		TectonicPlateLayer.Pack(TectonicPlateId_DEPRECATED);
+		TectonicPlateId_DEPRECATED.Empty();
+	}
+
+	if (CellRegionId_DEPRECATED.Num() > 0)
+	{
+		RegionLayer.Init(CellRegionId_DEPRECATED.Num());
+		RegionLayer.Pack(CellRegionId_DEPRECATED);
+		CellRegionId_DEPRECATED.Empty();
+	}
+
+	if (Biome_DEPRECATED.Num() > 0)
+	{
+		BiomeIndex.SetNumZeroed(Biome_DEPRECATED.Num());
+		for (int32 cellId = 0; cellId < Biome_DEPRECATED.Num(); ++cellId)
+		{
+			BiomeIndex[cellId] = static_cast<uint8>(FMath::Max(0, FindOrAddBiome(Biome_DEPRECATED[cellId])));
+		}
+		Biome_DEPRECATED.Empty();
+	}
+
+	// Palettes edited before slot 0 was enforced
+	if (BiomePalette.Num() == 0 || BiomePalette[0] != nullptr)
+	{
+		RemapBiomeIndices(TArray<TObjectPtr<UBiomeData>>(BiomePalette));
+	}
+
+	RebuildBiomeLookupTables();
+
+	if (AreDataLayersInitialized())
+	{
+		LayerRegistry.SetCellCount(GetCellCount());
+		DirtyTracker.Initialize(GetCellCount());
+	}
+}
+
+#if WITH_EDITOR
+void UPlanetData::PreEditChange(FProperty* PropertyAboutToChange)
+{
+	Super::PreEditChange(PropertyAboutToChange);
+
+	if (PropertyAboutToChange && PropertyAboutToChange->GetFName() == GET_MEMBER_NAME_CHECKED(UPlanetData, BiomePalette))
+	{
+		PreEditBiomePalette = BiomePalette;
+	}
+}
+
+void UPlanetData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UPlanetData, BiomePalette))
+	{
+		// Inserting, removing or moving entries shifts indices, keep every cell on its biome
+		RemapBiomeIndices(PreEditBiomePalette.Num() > 0 ? PreEditBiomePalette : TArray<TObjectPtr<UBiomeData>>(BiomePalette));
+		PreEditBiomePalette.Empty();
+
+		RebuildBiomeLookupTables();
+		MarkLayerDirty(EPlanetDataLayer::Biome);
+		OnCellDataChanged.Broadcast(INDEX_NONE);
+	}
+}
+#endif
+
 int32 UPlanetData::FindCellAtPosition(const FVector& Position) const
 {
 	if (!Grid || !GetOwner())
@@ -47,7 +174,7 @@ int32 UPlanetData::FindCellAtPosition(const FVector& Position) const
 	}
 
 	// Convert to local space
-	FVector LocalPos = Position - GetOwner()->GetActorLocation();
+	FVector LocalPos = GetOwner()->GetActorTransform().InverseTransformPosition(Position);
 	FVector Direction = LocalPos.GetSafeNormal();
 
 	return Grid->FindCellAtPosition(Direction);
@@ -61,22 +188,66 @@ FVector UPlanetData::CellIdToWorldPosition(int32 CellId) const
 	}
 
 	const FHexCell& Cell = Grid->Cells[CellId];
-	FVector worldPos = Cell.Position * PlanetRadius;
-	worldPos += GetOwner()->GetActorLocation();
+	return GetOwner()->GetActorTransform().TransformPosition(Cell.Position * PlanetRadius);
+}
 
-	return worldPos;
+int32 UPlanetData::FindCellAlongRay(const FVector& RayOrigin, const FVector& RayDirection, FVector& OutHitLocation) const
+{
+	OutHitLocation = FVector::ZeroVector;
+	if (!Grid || !GetOwner())
+	{
+		return INDEX_NONE;
+	}
+
+	// Intersect in the planet's local space, the grid is a sphere of PlanetRadius around the origin
+	const FTransform& transform = GetOwner()->GetActorTransform();
+	FVector localHit;
+	int32 cellId = Grid->FindCellAlongRay(transform.InverseTransformPosition(RayOrigin), transform.InverseTransformVector(RayDirection), PlanetRadius, localHit);
+	if (cellId != INDEX_NONE)
+	{
+		OutHitLocation = transform.TransformPosition(localHit);
+	}
+
+	return cellId;
+}
+
+void UPlanetData::FindCellsAlongRays(const TArray<FVector>& RayOrigins, const TArray<FVector>& RayDirections, TArray<int32>& OutCellIds) const
+{
+	const int32 rayCount = FMath::Min(RayOrigins.Num(), RayDirections.Num());
+	OutCellIds.Init(INDEX_NONE, rayCount);
+
+	if (!Grid || !GetOwner() || Grid->Cells.Num() == 0)
+	{
+		return;
+	}
+
+	const FTransform& transform = GetOwner()->GetActorTransform();
+	// Held for the whole loop, the asset may release its runtime meanwhile
+	const FHexGridRuntimePtr gridRuntime = Grid->GetRuntime();
+	const FHexSpatialIndex& spatialIndex = gridRuntime->GetSpatialIndex();
+
+	ParallelFor(rayCount, [&](int32 rayIdx)
+		{
+			FVector localHit;
+			if (FHexSpatialIndex::IntersectRaySphere(transform.InverseTransformPosition(RayOrigins[rayIdx]), transform.InverseTransformVector(RayDirections[rayIdx]), PlanetRadius, localHit))
+			{
+				OutCellIds[rayIdx] = spatialIndex.FindCell(localHit);
+			}
+		});
 }
 
 int32 UPlanetData::GetCellElevation(int32 CellId) const
 {
-	return IsValidCellId(CellId) ? ElevationLevel[CellId] : 0;
+	return IsValidCellId(CellId) ? ElevationLayer.Get(CellId) : 0;
 }
 
 void UPlanetData::SetCellElevation(int32 CellId, int32 Elevation)
 {
 	if (IsValidCellId(CellId))
 	{
-		ElevationLevel[CellId] = FMath::Clamp(Elevation, MIN_ELEVATION_LEVEL, MAX_ELEVATION_LEVEL);
+		ElevationLayer.Set(CellId, FMath::Clamp(Elevation, MIN_ELEVATION_LEVEL, MAX_ELEVATION_LEVEL));
+		MarkCellDirty(EPlanetDataLayer::Elevation, CellId);
+		OnCellDataChanged.Broadcast(CellId);
 	}
 }
 
@@ -84,7 +255,7 @@ int32 UPlanetData::GetWaterDepth(int32 CellId) const
 {
 	if (IsValidCellId(CellId))
 	{
-		int32 Elevation = ElevationLevel[CellId];
+		int32 Elevation = ElevationLayer.Get(CellId);
 		if (Elevation < WaterLevel)
 		{
 			return WaterLevel - Elevation;
@@ -103,6 +274,7 @@ void UPlanetData::SetCellTemperature(int32 CellId, float InTemperature)
 	if (IsValidCellId(CellId))
 	{
 		CellTemperature[CellId] = InTemperature;
+		MarkCellDirty(EPlanetDataLayer::Temperature, CellId);
 	}
 }
 
@@ -116,51 +288,700 @@ void UPlanetData::SetCellHumidity(int32 CellId, float InHumidity)
 	if (IsValidCellId(CellId))
 	{
 		CellHumidity[CellId] = InHumidity;
+		MarkCellDirty(EPlanetDataLayer::Humidity, CellId);
 	}
 }
 
 UBiomeData* UPlanetData::GetCellBiome(int32 CellId) const
 {
-	return IsValidCellId(CellId) ? Biome[CellId] : nullptr;
+	if (!IsValidCellId(CellId) || !BiomePalette.IsValidIndex(BiomeIndex[CellId]))
+	{
+		return nullptr;
+	}
+
+	return BiomePalette[BiomeIndex[CellId]];
 }
 
 void UPlanetData::SetCellBiome(int32 CellId, UBiomeData* BiomeData)
 {
-	if (IsValidCellId(CellId))
+	if (!IsValidCellId(CellId))
+	{
+		return;
+	}
+
+	int32 paletteIndex = FindOrAddBiome(BiomeData);
+	if (paletteIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::SetCellBiome - Biome palette is full (%d biomes)."), MAX_BIOMES);
+		return;
+	}
+
+	SetCellBiomeIndex(CellId, paletteIndex);
+}
+
+int32 UPlanetData::GetCellBiomeIndex(int32 CellId) const
+{
+	return IsValidCellId(CellId) ? BiomeIndex[CellId] : 0;
+}
+
+void UPlanetData::SetCellBiomeIndex(int32 CellId, int32 PaletteIndex)
+{
+	if (IsValidCellId(CellId) && PaletteIndex >= 0 && PaletteIndex < FMath::Max(BiomePalette.Num(), 1))
+	{
+		BiomeIndex[CellId] = static_cast<uint8>(PaletteIndex);
+		MarkCellDirty(EPlanetDataLayer::Biome, CellId);
+		OnCellDataChanged.Broadcast(CellId);
+	}
+}
+
+int32 UPlanetData::FindOrAddBiome(UBiomeData* BiomeData)
+{
+	if (BiomePalette.Num() == 0)
+	{
+		BiomePalette.Add(nullptr);
+	}
+
+	if (!BiomeData)
+	{
+		return 0;
+	}
+
+	int32 paletteIndex = BiomePalette.IndexOfByKey(BiomeData);
+	if (paletteIndex == INDEX_NONE && BiomePalette.Num() < MAX_BIOMES)
+	{
+		paletteIndex = BiomePalette.Add(BiomeData);
+		RebuildBiomeLookupTables();
+	}
+
+	return paletteIndex;
+}
+
+void UPlanetData::RemapBiomeIndices(const TArray<TObjectPtr<UBiomeData>>& PreviousPalette)
+{
+	if (BiomePalette.Num() == 0 || BiomePalette[0] != nullptr)
+	{
+		BiomePalette.Insert(nullptr, 0);
+	}
+
+	if (BiomePalette.Num() > MAX_BIOMES)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::RemapBiomeIndices - Biome palette is limited to %d biomes, extra entries are removed."), MAX_BIOMES);
+		BiomePalette.SetNum(MAX_BIOMES);
+	}
+
+	TStaticArray<uint8, MAX_BIOMES> remap;
+	bool bIdentity = true;
+	for (int32 paletteIndex = 0; paletteIndex < MAX_BIOMES; ++paletteIndex)
+	{
+		const UBiomeData* biome = PreviousPalette.IsValidIndex(paletteIndex) ? PreviousPalette[paletteIndex].Get() : nullptr;
+		const int32 newIndex = biome ? BiomePalette.IndexOfByKey(biome) : 0;
+		remap[paletteIndex] = static_cast<uint8>(FMath::Max(newIndex, 0));
+		bIdentity &= remap[paletteIndex] == paletteIndex || !PreviousPalette.IsValidIndex(paletteIndex);
+	}
+
+	if (bIdentity)
+	{
+		return;
+	}
+
+	for (uint8& index : BiomeIndex)
 	{
-		Biome[CellId] = BiomeData;
+		index = remap[index];
+	}
+}
+
+void UPlanetData::RebuildBiomeLookupTables()
+{
+	for (int32 paletteIndex = 0; paletteIndex < MAX_BIOMES; ++paletteIndex)
+	{
+		const UBiomeData* biome = BiomePalette.IsValidIndex(paletteIndex) ? BiomePalette[paletteIndex].Get() : nullptr;
+		BiomeMovementCosts[paletteIndex] = biome ? FMath::Max(biome->MovementCostMultiplier, KINDA_SMALL_NUMBER) : 1.0f;
+		BiomeMapColors[paletteIndex] = biome ? biome->MapColor : FLinearColor::Transparent;
+	}
+}
+
+void UPlanetData::GatherMovementCosts(TConstArrayView<int32> CellIds, TArrayView<float> OutCosts) const
+{
+	// Table lookups over the byte layer, no pointer chasing. Plain scalar loop, there is no vector gather of bytes
+	const uint8* RESTRICT indices = BiomeIndex.GetData();
+	float* RESTRICT costs = OutCosts.GetData();
+
+	if (CellIds.Num() == 0)
+	{
+		check(OutCosts.Num() == BiomeIndex.Num());
+		for (int32 cellId = 0; cellId < BiomeIndex.Num(); ++cellId)
+		{
+			costs[cellId] = BiomeMovementCosts[indices[cellId]];
+		}
+		return;
+	}
+
+	check(OutCosts.Num() == CellIds.Num());
+	for (int32 i = 0; i < CellIds.Num(); ++i)
+	{
+		costs[i] = BiomeMovementCosts[indices[CellIds[i]]];
+	}
+}
+
+void UPlanetData::GatherMapColors(TConstArrayView<int32> CellIds, TArrayView<FLinearColor> OutColors) const
+{
+	const uint8* RESTRICT indices = BiomeIndex.GetData();
+	FLinearColor* RESTRICT colors = OutColors.GetData();
+
+	if (CellIds.Num() == 0)
+	{
+		check(OutColors.Num() == BiomeIndex.Num());
+		for (int32 cellId = 0; cellId < BiomeIndex.Num(); ++cellId)
+		{
+			colors[cellId] = BiomeMapColors[indices[cellId]];
+		}
+		return;
+	}
+
+	check(OutColors.Num() == CellIds.Num());
+	for (int32 i = 0; i < CellIds.Num(); ++i)
+	{
+		colors[i] = BiomeMapColors[indices[CellIds[i]]];
 	}
 }
 
 int32 UPlanetData::GetCellTectonicPlateId(int32 CellId) const
 {
-	return IsValidCellId(CellId) ? TectonicPlateId[CellId] : -1;
+	return IsValidCellId(CellId) ? TectonicPlateLayer.Get(CellId) : -1;
 }
 
 void UPlanetData::SetCellTectonicPlateId(int32 CellId, int32 PlateId)
 {
 	if (IsValidCellId(CellId))
 	{
-		TectonicPlateId[CellId] = PlateId;
+		TectonicPlateLayer.Set(CellId, PlateId);
+		MarkCellDirty(EPlanetDataLayer::TectonicPlate, CellId);
 	}
 }
 
 int32 UPlanetData::GetCellRegionId(int32 CellId) const
 {
-	return IsValidCellId(CellId) ? CellRegionId[CellId] : -1;
+	return IsValidCellId(CellId) ? RegionLayer.Get(CellId) : -1;
 }
 
 void UPlanetData::SetCellRegionId(int32 CellId, int32 InRegionId)
 {
 	if (IsValidCellId(CellId))
 	{
-		CellRegionId[CellId] = InRegionId;
+		RegionLayer.Set(CellId, InRegionId);
+		MarkCellDirty(EPlanetDataLayer::Region, CellId);
+	}
+}
+
+bool UPlanetData::GetLayerValues(EPlanetDataLayer Layer, TArray<float>& OutValues) const
+{
+	OutValues.Reset();
+	if (!AreDataLayersInitialized())
+	{
+		return false;
+	}
+
+	const int32 cellCount = GetCellCount();
+	OutValues.SetNumUninitialized(cellCount);
+
+	TArray<int32> intValues;
+	auto copyInts = [&](const auto& source)
+		{
+			intValues.SetNumUninitialized(cellCount);
+			source.Unpack(intValues);
+			for (int32 cellId = 0; cellId < cellCount; ++cellId)
+			{
+				OutValues[cellId] = static_cast<float>(intValues[cellId]);
+			}
+		};
+
+	switch (Layer)
+	{
+	case EPlanetDataLayer::Elevation:		copyInts(ElevationLayer); break;
+	case EPlanetDataLayer::Temperature:		OutValues = CellTemperature; break;
+	case EPlanetDataLayer::Humidity:		OutValues = CellHumidity; break;
+	case EPlanetDataLayer::TectonicPlate:	copyInts(TectonicPlateLayer); break;
+	case EPlanetDataLayer::Region:			copyInts(RegionLayer); break;
+	case EPlanetDataLayer::Biome:
+		for (int32 cellId = 0; cellId < cellCount; ++cellId)
+		{
+			OutValues[cellId] = static_cast<float>(BiomeIndex[cellId]);
+		}
+		break;
+	default:
+		OutValues.Reset();
+		return false;
 	}
+
+	return true;
+}
+
+bool UPlanetData::SetLayerValues(EPlanetDataLayer Layer, const TArray<float>& Values)
+{
+	if (!AreDataLayersInitialized() || Values.Num() != GetCellCount())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::SetLayerValues - Got %d values for %d cells."), Values.Num(), GetCellCount());
+		return false;
+	}
+
+	TArray<int32> intValues;
+	auto copyInts = [&](auto& target, int32 minValue, int32 maxValue)
+		{
+			intValues.SetNumUninitialized(Values.Num());
+			for (int32 cellId = 0; cellId < Values.Num(); ++cellId)
+			{
+				intValues[cellId] = FMath::Clamp(FMath::RoundToInt32(Values[cellId]), minValue, maxValue);
+			}
+			target.Pack(intValues);
+		};
+
+	switch (Layer)
+	{
+	case EPlanetDataLayer::Elevation:
+		copyInts(ElevationLayer, MIN_ELEVATION_LEVEL, MAX_ELEVATION_LEVEL);
+		OnCellDataChanged.Broadcast(INDEX_NONE);
+		break;
+	case EPlanetDataLayer::Temperature:		CellTemperature = Values; break;
+	case EPlanetDataLayer::Humidity:		CellHumidity = Values; break;
+	case EPlanetDataLayer::TectonicPlate:	copyInts(TectonicPlateLayer, MIN_int32, MAX_int32); break;
+	case EPlanetDataLayer::Region:			copyInts(RegionLayer, MIN_int32, MAX_int32); break;
+	case EPlanetDataLayer::Biome:
+		for (int32 cellId = 0; cellId < Values.Num(); ++cellId)
+		{
+			BiomeIndex[cellId] = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt32(Values[cellId]), 0, FMath::Max(BiomePalette.Num() - 1, 0)));
+		}
+		OnCellDataChanged.Broadcast(INDEX_NONE);
+		break;
+	default:
+		return false;
+	}
+
+	MarkLayerDirty(Layer);
+	return true;
+}
+
+bool UPlanetData::GenerateTectonics(const FPlanetTectonicsSettings& Settings)
+{
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::GenerateTectonics - Data layers are not initialized."));
+		return false;
+	}
+
+	TArray<int32> plateIds;
+	TArray<int32> elevations;
+	if (!FPlanetTectonicsGenerator::Generate(*Grid, Settings, plateIds, elevations, TectonicPlates))
+	{
+		return false;
+	}
+
+	for (int32& elevation : elevations)
+	{
+		elevation = FMath::Clamp(elevation, MIN_ELEVATION_LEVEL, MAX_ELEVATION_LEVEL);
+	}
+
+	TectonicPlateLayer.Pack(plateIds);
+	ElevationLayer.Pack(elevations);
+	MarkLayerDirty(EPlanetDataLayer::TectonicPlate);
+	MarkLayerDirty(EPlanetDataLayer::Elevation);
+	OnCellDataChanged.Broadcast(INDEX_NONE);
+
+	return true;
+}
+
+bool UPlanetData::GenerateElevationFromTerrainNoise(const FPlanetTerrainElevationSettings& Settings)
+{
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::GenerateElevationFromTerrainNoise - Data layers are not initialized."));
+		return false;
+	}
+
+	TArray<int32> elevations;
+	if (!FPlanetTerrainElevationGenerator::Generate(*Grid, Settings, PlanetRadius, elevations))
+	{
+		return false;
+	}
+
+	for (int32& elevation : elevations)
+	{
+		elevation = FMath::Clamp(elevation, MIN_ELEVATION_LEVEL, MAX_ELEVATION_LEVEL);
+	}
+
+	ElevationLayer.Pack(elevations);
+	MarkLayerDirty(EPlanetDataLayer::Elevation);
+	OnCellDataChanged.Broadcast(INDEX_NONE);
+
+	return true;
+}
+
+int32 UPlanetData::ComputeHydrology()
+{
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::ComputeHydrology - Data layers are not initialized."));
+		return 0;
+	}
+
+	TArray<float> elevations;
+	elevations.SetNumUninitialized(GetCellCount());
+	for (int32 cellId = 0; cellId < elevations.Num(); ++cellId)
+	{
+		elevations[cellId] = static_cast<float>(ElevationLayer.Get(cellId));
+	}
+
+	FPlanetHydrologyResult result;
+	if (!FPlanetHydrology::Compute(*Grid, elevations, static_cast<float>(WaterLevel), result))
+	{
+		return 0;
+	}
+
+	FPlanetLayerHandle downstreamLayer = LayerRegistry.RegisterLayer(FPlanetHydrology::DownstreamLayerName, EPlanetLayerType::Int32);
+	FPlanetLayerHandle accumulationLayer = LayerRegistry.RegisterLayer(FPlanetHydrology::AccumulationLayerName, EPlanetLayerType::Float);
+	FPlanetLayerHandle lakeLayer = LayerRegistry.RegisterLayer(FPlanetHydrology::LakeLayerName, EPlanetLayerType::Int32);
+	if (!LayerRegistry.IsValidLayer(downstreamLayer) || !LayerRegistry.IsValidLayer(accumulationLayer) || !LayerRegistry.IsValidLayer(lakeLayer))
+	{
+		UE_LOG(LogTemp, Error, TEXT("UPlanetData::ComputeHydrology - Hydrology layers could not be registered."));
+		return 0;
+	}
+
+	FMemory::Memcpy(LayerRegistry.GetView<int32>(downstreamLayer).GetData(), result.DownstreamCellIds.GetData(), result.DownstreamCellIds.Num() * sizeof(int32));
+	FMemory::Memcpy(LayerRegistry.GetView<float>(accumulationLayer).GetData(), result.Accumulation.GetData(), result.Accumulation.Num() * sizeof(float));
+	FMemory::Memcpy(LayerRegistry.GetView<int32>(lakeLayer).GetData(), result.LakeIds.GetData(), result.LakeIds.Num() * sizeof(int32));
+
+	return result.GetLakeCount();
+}
+
+void UPlanetData::GetRiverCells(float MinAccumulation, TArray<int32>& OutCellIds) const
+{
+	OutCellIds.Reset();
+
+	FPlanetLayerHandle accumulationLayer = LayerRegistry.FindLayer(FPlanetHydrology::AccumulationLayerName);
+	if (!LayerRegistry.IsValidLayer(accumulationLayer))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::GetRiverCells - Hydrology has not been computed."));
+		return;
+	}
+
+	TConstArrayView<float> accumulation = LayerRegistry.GetView<float>(accumulationLayer);
+	for (int32 cellId = 0; cellId < accumulation.Num(); ++cellId)
+	{
+		if (accumulation[cellId] >= MinAccumulation && !IsCellUnderwater(cellId))
+		{
+			OutCellIds.Add(cellId);
+		}
+	}
+}
+
+float* UPlanetData::GetFloatLayerData(EPlanetDataLayer Layer)
+{
+	switch (Layer)
+	{
+	case EPlanetDataLayer::Temperature:	return CellTemperature.GetData();
+	case EPlanetDataLayer::Humidity:	return CellHumidity.GetData();
+	default:							return nullptr;
+	}
+}
+
+float UPlanetData::GetCellValueUnchecked(EPlanetDataLayer Layer, int32 CellId) const
+{
+	switch (Layer)
+	{
+	case EPlanetDataLayer::Elevation:		return static_cast<float>(ElevationLayer.Get(CellId));
+	case EPlanetDataLayer::Temperature:		return CellTemperature[CellId];
+	case EPlanetDataLayer::Humidity:		return CellHumidity[CellId];
+	case EPlanetDataLayer::TectonicPlate:	return static_cast<float>(TectonicPlateLayer.Get(CellId));
+	case EPlanetDataLayer::Region:			return static_cast<float>(RegionLayer.Get(CellId));
+	case EPlanetDataLayer::Biome:			return static_cast<float>(BiomeIndex[CellId]);
+	default:								return 0.0f;
+	}
+}
+
+void UPlanetData::SetCellValueUnchecked(EPlanetDataLayer Layer, int32 CellId, float Value)
+{
+	switch (Layer)
+	{
+	case EPlanetDataLayer::Elevation:		ElevationLayer.Set(CellId, FMath::Clamp(FMath::RoundToInt32(Value), MIN_ELEVATION_LEVEL, MAX_ELEVATION_LEVEL)); break;
+	case EPlanetDataLayer::Temperature:		CellTemperature[CellId] = Value; break;
+	case EPlanetDataLayer::Humidity:		CellHumidity[CellId] = Value; break;
+	case EPlanetDataLayer::TectonicPlate:	TectonicPlateLayer.Set(CellId, FMath::RoundToInt32(Value)); break;
+	case EPlanetDataLayer::Region:			RegionLayer.Set(CellId, FMath::RoundToInt32(Value)); break;
+	case EPlanetDataLayer::Biome:
+		BiomeIndex[CellId] = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt32(Value), 0, FMath::Max(BiomePalette.Num() - 1, 0)));
+		break;
+	default:
+		break;
+	}
+}
+
+void UPlanetData::NotifyCellsChanged(EPlanetDataLayer Layer, TConstArrayView<int32> CellIds)
+{
+	if (CellIds.Num() == 0)
+	{
+		return;
+	}
+
+	const bool bFullLayer = CellIds.Num() * BatchFullLayerRatio > GetCellCount();
+	if (bFullLayer)
+	{
+		MarkLayerDirty(Layer);
+	}
+	else
+	{
+		MarkCellsDirty(Layer, CellIds);
+	}
+
+	if (IsTraversalLayer(Layer))
+	{
+		if (bFullLayer)
+		{
+			OnCellDataChanged.Broadcast(INDEX_NONE);
+		}
+		else
+		{
+			for (int32 cellId : CellIds)
+			{
+				OnCellDataChanged.Broadcast(cellId);
+			}
+		}
+	}
+}
+
+void UPlanetData::GetCellValues(EPlanetDataLayer Layer, const TArray<int32>& CellIds, TArray<float>& OutValues) const
+{
+	OutValues.SetNumUninitialized(CellIds.Num());
+
+	const int32 cellCount = AreDataLayersInitialized() ? GetCellCount() : 0;
+	for (int32 i = 0; i < CellIds.Num(); ++i)
+	{
+		const int32 cellId = CellIds[i];
+		OutValues[i] = cellId >= 0 && cellId < cellCount ? GetCellValueUnchecked(Layer, cellId) : 0.0f;
+	}
+}
+
+int32 UPlanetData::SetCellValues(EPlanetDataLayer Layer, const TArray<int32>& CellIds, const TArray<float>& Values)
+{
+	if (!AreDataLayersInitialized() || (Values.Num() != CellIds.Num() && Values.Num() != 1))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::SetCellValues - Got %d values for %d cells."), Values.Num(), CellIds.Num());
+		return 0;
+	}
+
+	const int32 cellCount = GetCellCount();
+	const bool bSingleValue = Values.Num() == 1;
+
+	TArray<int32> written;
+	written.Reserve(CellIds.Num());
+	for (int32 i = 0; i < CellIds.Num(); ++i)
+	{
+		const int32 cellId = CellIds[i];
+		if (cellId >= 0 && cellId < cellCount)
+		{
+			SetCellValueUnchecked(Layer, cellId, Values[bSingleValue ? 0 : i]);
+			written.Add(cellId);
+		}
+	}
+
+	NotifyCellsChanged(Layer, written);
+	return written.Num();
+}
+
+int32 UPlanetData::FillLayerMasked(EPlanetDataLayer Layer, const TArray<bool>& Mask, float Value)
+{
+	if (!AreDataLayersInitialized() || Mask.Num() != GetCellCount())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::FillLayerMasked - Got a mask of %d entries for %d cells."), Mask.Num(), GetCellCount());
+		return 0;
+	}
+
+	return FillLayerWhere(Layer, [&Mask](int32 cellId) { return Mask[cellId]; }, Value);
+}
+
+int32 UPlanetData::FillLayerBits(EPlanetDataLayer Layer, const TBitArray<>& Mask, float Value)
+{
+	if (!AreDataLayersInitialized() || Mask.Num() != GetCellCount())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::FillLayerBits - Got a mask of %d bits for %d cells."), Mask.Num(), GetCellCount());
+		return 0;
+	}
+
+	// Whole words of unset bits are skipped
+	TArray<int32> written;
+	for (TConstSetBitIterator<> It(Mask); It; ++It)
+	{
+		SetCellValueUnchecked(Layer, It.GetIndex(), Value);
+		written.Add(It.GetIndex());
+	}
+
+	NotifyCellsChanged(Layer, written);
+	return written.Num();
+}
+
+int32 UPlanetData::FillLayerWhere(EPlanetDataLayer Layer, TFunctionRef<bool(int32)> Predicate, float Value)
+{
+	if (!AreDataLayersInitialized())
+	{
+		return 0;
+	}
+
+	TArray<int32> written;
+	const int32 cellCount = GetCellCount();
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		if (Predicate(cellId))
+		{
+			SetCellValueUnchecked(Layer, cellId, Value);
+			written.Add(cellId);
+		}
+	}
+
+	NotifyCellsChanged(Layer, written);
+	return written.Num();
+}
+
+int32 UPlanetData::AddToCells(EPlanetDataLayer Layer, const TArray<int32>& CellIds, float Delta, float MinValue, float MaxValue)
+{
+	if (!AreDataLayersInitialized() || MinValue > MaxValue)
+	{
+		return 0;
+	}
+
+	const int32 cellCount = GetCellCount();
+	float* floatData = GetFloatLayerData(Layer);
+
+	// Whole float layer, 4 cells at a time
+	if (CellIds.Num() == 0 && floatData)
+	{
+		const VectorRegister4Float delta = VectorSetFloat1(Delta);
+		const VectorRegister4Float minValue = VectorSetFloat1(MinValue);
+		const VectorRegister4Float maxValue = VectorSetFloat1(MaxValue);
+
+		int32 cellId = 0;
+		for (; cellId + 4 <= cellCount; cellId += 4)
+		{
+			VectorStore(VectorMin(VectorMax(VectorAdd(VectorLoad(floatData + cellId), delta), minValue), maxValue), floatData + cellId);
+		}
+		for (; cellId < cellCount; ++cellId)
+		{
+			floatData[cellId] = FMath::Clamp(floatData[cellId] + Delta, MinValue, MaxValue);
+		}
+
+		MarkLayerDirty(Layer);
+		return cellCount;
+	}
+
+	auto addToCell = [&](int32 cellId)
+		{
+			SetCellValueUnchecked(Layer, cellId, FMath::Clamp(GetCellValueUnchecked(Layer, cellId) + Delta, MinValue, MaxValue));
+		};
+
+	TArray<int32> written;
+	if (CellIds.Num() == 0)
+	{
+		written.SetNumUninitialized(cellCount);
+		for (int32 cellId = 0; cellId < cellCount; ++cellId)
+		{
+			addToCell(cellId);
+			written[cellId] = cellId;
+		}
+	}
+	else
+	{
+		written.Reserve(CellIds.Num());
+		for (int32 cellId : CellIds)
+		{
+			if (cellId >= 0 && cellId < cellCount)
+			{
+				addToCell(cellId);
+				written.Add(cellId);
+			}
+		}
+	}
+
+	NotifyCellsChanged(Layer, written);
+	return written.Num();
+}
+
+bool UPlanetData::CopyLayer(EPlanetDataLayer Source, EPlanetDataLayer Target)
+{
+	if (!AreDataLayersInitialized())
+	{
+		return false;
+	}
+
+	if (Source == Target)
+	{
+		return true;
+	}
+
+	float* sourceData = GetFloatLayerData(Source);
+	float* targetData = GetFloatLayerData(Target);
+	if (sourceData && targetData)
+	{
+		FMemory::Memcpy(targetData, sourceData, GetCellCount() * sizeof(float));
+		MarkLayerDirty(Target);
+		return true;
+	}
+
+	TArray<float> values;
+	return GetLayerValues(Source, values) && SetLayerValues(Target, values);
+}
+
+int32 UPlanetData::QueryCells(const TArray<FPlanetQueryCondition>& Conditions, TArray<int32>& OutCellIds) const
+{
+	FPlanetQuery::AllOf(Conditions).GetCellIds(*this, OutCellIds);
+	return OutCellIds.Num();
+}
+
+int32 UPlanetData::CountCells(const TArray<FPlanetQueryCondition>& Conditions) const
+{
+	return FPlanetQuery::AllOf(Conditions).Count(*this);
+}
+
+int32 UPlanetData::LabelLandAndWaterRegions(TArray<int32>& OutRegionSizes)
+{
+	OutRegionSizes.Reset();
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::LabelLandAndWaterRegions - Data layers are not initialized."));
+		return 0;
+	}
+
+	TArray<int32> cellClasses;
+	cellClasses.SetNumUninitialized(GetCellCount());
+	for (int32 cellId = 0; cellId < cellClasses.Num(); ++cellId)
+	{
+		cellClasses[cellId] = IsCellUnderwater(cellId) ? 1 : 0;
+	}
+
+	TArray<int32> regionIds;
+	int32 regionCount = FHexRegionLabeler::LabelByClass(*Grid, cellClasses, regionIds, OutRegionSizes);
+	RegionLayer.Pack(regionIds);
+	MarkLayerDirty(EPlanetDataLayer::Region);
+
+	return regionCount;
+}
+
+int32 UPlanetData::LabelRegions(TFunctionRef<bool(int32)> Predicate, TArray<int32>& OutRegionSizes)
+{
+	OutRegionSizes.Reset();
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::LabelRegions - Data layers are not initialized."));
+		return 0;
+	}
+
+	TArray<int32> regionIds;
+	int32 regionCount = FHexRegionLabeler::LabelByPredicate(*Grid, Predicate, regionIds, OutRegionSizes);
+	RegionLayer.Pack(regionIds);
+	MarkLayerDirty(EPlanetDataLayer::Region);
+
+	return regionCount;
 }
 
 bool UPlanetData::IsCellUnderwater(int32 CellId) const
 {
-	return IsValidCellId(CellId) && (ElevationLevel[CellId] <= WaterLevel);
+	return IsValidCellId(CellId) && (ElevationLayer.Get(CellId) <= WaterLevel);
 }
 
 bool UPlanetData::IsValidCellId(int32 CellId) const
@@ -172,3 +993,149 @@ int32 UPlanetData::GetCellCount() const
 {
 	return Grid != nullptr ? Grid->TotalCellCount : 0;
 }
+
+bool UPlanetData::FindPath(int32 StartCellId, int32 GoalCellId, TArray<int32>& OutPath)
+{
+	OutPath.Reset();
+
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::FindPath - Data layers are not initialized."));
+		return false;
+	}
+
+	return GetPathfinder().FindPath(StartCellId, GoalCellId, OutPath);
+}
+
+void UPlanetData::ComputeFlowField(const TArray<int32>& SourceCellIds, TArray<float>& OutDistances, TArray<int32>& OutNextCellIds) const
+{
+	OutDistances.Reset();
+	OutNextCellIds.Reset();
+
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::ComputeFlowField - Data layers are not initialized."));
+		return;
+	}
+
+	FHexFlowCostGraph costGraph;
+	costGraph.Build(*this);
+
+	FHexFlowField field;
+	FHexFlowFieldBuilder::Compute(costGraph, SourceCellIds, field);
+
+	OutDistances = MoveTemp(field.Distance);
+	OutNextCellIds = MoveTemp(field.NextCellId);
+}
+
+void UPlanetData::ComputeViewshed(int32 ObserverCellId, const FPlanetViewshedSettings& Settings, TArray<int32>& OutVisibleCells) const
+{
+	OutVisibleCells.Reset();
+
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::ComputeViewshed - Data layers are not initialized."));
+		return;
+	}
+
+	FPlanetViewshed::Compute(*this, ObserverCellId, Settings, OutVisibleCells);
+}
+
+void UPlanetData::ComputeViewsheds(TConstArrayView<int32> ObserverCellIds, const FPlanetViewshedSettings& Settings, TArray<TArray<int32>>& OutVisibleCells) const
+{
+	OutVisibleCells.Reset();
+
+	if (!AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetData::ComputeViewsheds - Data layers are not initialized."));
+		return;
+	}
+
+	FPlanetViewshed::ComputeBatch(*this, ObserverCellIds, Settings, OutVisibleCells);
+}
+
+void UPlanetData::MarkCellDirty(EPlanetDataLayer Layer, int32 CellId)
+{
+	DirtyTracker.MarkCell(Layer, CellId);
+	if (!IsComponentTickEnabled())
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UPlanetData::MarkCellsDirty(EPlanetDataLayer Layer, TConstArrayView<int32> CellIds)
+{
+	DirtyTracker.MarkCells(Layer, CellIds);
+	if (!IsComponentTickEnabled())
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UPlanetData::MarkLayerDirty(EPlanetDataLayer Layer)
+{
+	DirtyTracker.MarkAll(Layer);
+	if (!IsComponentTickEnabled())
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UPlanetData::FlushChanges()
+{
+	if (!DirtyTracker.HasPendingChanges())
+	{
+		return;
+	}
+
+	DirtyTracker.Flush(LastChangeSet);
+	OnLayersChanged.Broadcast(LastChangeSet);
+}
+
+void UPlanetData::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UPlanetManagerSubsystem* manager = GetWorld() ? GetWorld()->GetSubsystem<UPlanetManagerSubsystem>() : nullptr)
+	{
+		manager->RegisterPlanet(this);
+	}
+}
+
+void UPlanetData::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPlanetManagerSubsystem* manager = GetWorld() ? GetWorld()->GetSubsystem<UPlanetManagerSubsystem>() : nullptr)
+	{
+		manager->UnregisterPlanet(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UPlanetData::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	FlushChanges();
+
+	// Listeners may write cells during the broadcast, those changes are flushed on the next tick
+	if (!DirtyTracker.HasPendingChanges())
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+FHexHierarchicalPathfinder& UPlanetData::GetPathfinder()
+{
+	if (!Pathfinder)
+	{
+		Pathfinder = MakeShared<FHexHierarchicalPathfinder>();
+	}
+
+	if (!Pathfinder->IsInitialized() && AreDataLayersInitialized())
+	{
+		Pathfinder->Initialize(this);
+	}
+
+	return *Pathfinder;
+}
@@ -7,8 +7,24 @@
 #include "Components/ActorComponent.h"
 #include "HexGridAsset.h"
 #include "BiomeData.h"
+#include "PlanetLayerRegistry.h"
+#include "PackedCellLayers.h"
+#include "PlanetDataLayer.h"
+#include "PlanetDirtyTracker.h"
+#include "PlanetTectonics.h"
+#include "PlanetTerrainElevation.h"
+#include "PlanetViewshed.h"
+#include "PlanetQuery.h"
 #include "PlanetData.generated.h"
 
+class FHexHierarchicalPathfinder;
+
+/** Broadcast when a cell's traversal data (elevation, biome) changes, CellId is INDEX_NONE when every cell changed */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlanetCellDataChanged, int32 /* CellId */);
+
+/** Broadcast once per frame with every layer change made since the previous broadcast */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlanetLayersChanged, const FPlanetChangeSet& /* Changes */);
+
 UCLASS(classGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class GALAXY_API UPlanetData : public UActorComponent
 {
@@ -28,8 +44,9 @@ public:
 
 	// === DATA LAYERS ===
 	// All layers are indexed by CellId from the grid
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Data|Geophysical")
-	TArray<int32> ElevationLevel;
+	/** 4 bits per cell, use GetCellElevation / SetCellElevation or GetLayerValues for bulk access */
+	UPROPERTY(VisibleAnywhere, Category = "Planet Data|Geophysical")
+	FPackedNibbleLayer ElevationLayer;
 
 	static constexpr int32 MIN_ELEVATION_LEVEL = -5;
 	static constexpr int32 MAX_ELEVATION_LEVEL = 5;
@@ -40,14 +57,27 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Data|Climate")
 	TArray<float> CellHumidity;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Data|Terrain")
-	TArray<TObjectPtr<UBiomeData>> Biome;
+	/** Biomes used on this planet, cells store an index in this palette. Slot 0 is always "no biome" (nullptr) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Planet Data|Terrain")
+	TArray<TObjectPtr<UBiomeData>> BiomePalette;
+
+	/** Palette index of every cell */
+	UPROPERTY(VisibleAnywhere, Category = "Planet Data|Terrain")
+	TArray<uint8> BiomeIndex;
+
+	static constexpr int32 MAX_BIOMES = 256;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Data|Geophysical")
-	TArray<int32> TectonicPlateId;
+	/** 8 bits per cell, widened to 16 or 32 bits when larger ids are written */
+	UPROPERTY(VisibleAnywhere, Category = "Planet Data|Geophysical")
+	FPackedIdLayer TectonicPlateLayer;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Data|Gameplay")
-	TArray<int32> CellRegionId;
+	/** Plates referenced by TectonicPlateLayer, filled by GenerateTectonics */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Planet Data|Geophysical")
+	TArray<FTectonicPlate> TectonicPlates;
+
+	/** 8 bits per cell, widened to 16 or 32 bits when larger ids are written */
+	UPROPERTY(VisibleAnywhere, Category = "Planet Data|Gameplay")
+	FPackedIdLayer RegionLayer;
 
 	// === INITIALIZATION METHODS ===
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
@@ -56,6 +86,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	void ClearDataLayers();
 
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	bool AreDataLayersInitialized() const;
+
 	// === DATA ACCESS METHODS ===
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	int32 GetCellElevation(int32 CellId) const;
@@ -81,9 +114,37 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	UBiomeData* GetCellBiome(int32 CellId) const;
 
+	/** Set the biome of a cell, adding it to the palette if needed */
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	void SetCellBiome(int32 CellId, UBiomeData* BiomeData);
 
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	int32 GetCellBiomeIndex(int32 CellId) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	void SetCellBiomeIndex(int32 CellId, int32 PaletteIndex);
+
+	/** Palette index of a biome, added to the palette if missing. INDEX_NONE when the palette is full */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	int32 FindOrAddBiome(UBiomeData* BiomeData);
+
+	/** Refresh the per-palette lookup tables, call after editing a biome asset used by this planet */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	void RebuildBiomeLookupTables();
+
+	/** Biome movement cost multiplier of a cell, 1 when no biome is set or the cell is invalid */
+	float GetCellMovementCost(int32 CellId) const { return BiomeIndex.IsValidIndex(CellId) ? BiomeMovementCosts[BiomeIndex[CellId]] : BiomeMovementCosts[0]; }
+
+	/** Biome map color of a cell, transparent black when no biome is set or the cell is invalid */
+	const FLinearColor& GetCellMapColor(int32 CellId) const { return BiomeMapColors[BiomeIndex.IsValidIndex(CellId) ? BiomeIndex[CellId] : 0]; }
+
+	/**
+	 * Lookup the movement cost / map color of many cells (or every cell when CellIds is empty).
+	 * Scalar loops of one byte load and one table load per cell, no biome asset is touched
+	 */
+	void GatherMovementCosts(TConstArrayView<int32> CellIds, TArrayView<float> OutCosts) const;
+	void GatherMapColors(TConstArrayView<int32> CellIds, TArrayView<FLinearColor> OutColors) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	int32 GetCellTectonicPlateId(int32 CellId) const;
 
@@ -96,6 +157,78 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	void SetCellRegionId(int32 CellId, int32 regionId);
 
+	/** Label continents and oceans into RegionLayer: connected land cells and connected underwater cells, returns the region count */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	int32 LabelLandAndWaterRegions(TArray<int32>& OutRegionSizes);
+
+	/** Label connected cells matching the predicate into RegionLayer (INDEX_NONE elsewhere), returns the region count.
+	 *  The predicate is called from worker threads. */
+	int32 LabelRegions(TFunctionRef<bool(int32)> Predicate, TArray<int32>& OutRegionSizes);
+
+	/** Generate tectonic plates and derive every cell elevation from them, deterministic for a given seed */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Generation")
+	bool GenerateTectonics(const FPlanetTectonicsSettings& Settings);
+
+	/** Set every cell elevation from the terrain noise the planet surface is rendered with, sampled on the CPU */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Generation")
+	bool GenerateElevationFromTerrainNoise(const FPlanetTerrainElevationSettings& Settings);
+
+	/** Compute drainage, flow accumulation and lakes into the hydrology registry layers (FPlanetHydrology), returns the lake count */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Generation")
+	int32 ComputeHydrology();
+
+	/** Cells draining at least MinAccumulation average cell areas, requires ComputeHydrology */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Generation")
+	void GetRiverCells(float MinAccumulation, TArray<int32>& OutCellIds) const;
+
+	/** Copy a whole layer, integer layers are converted to float */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	bool GetLayerValues(EPlanetDataLayer Layer, TArray<float>& OutValues) const;
+
+	/** Overwrite a whole layer, values are rounded (and clamped for elevation) for integer layers */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	bool SetLayerValues(EPlanetDataLayer Layer, const TArray<float>& Values);
+
+	// === BATCH ACCESS ===
+	// Values are floats for every layer, integer layers are rounded and clamped like SetLayerValues
+
+	/** Read a layer for a list of cells, invalid cells read 0 */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Batch")
+	void GetCellValues(EPlanetDataLayer Layer, const TArray<int32>& CellIds, TArray<float>& OutValues) const;
+
+	/** Write a layer for a list of cells, Values holds one value per cell or a single value for all. Returns the number of cells written */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Batch")
+	int32 SetCellValues(EPlanetDataLayer Layer, const TArray<int32>& CellIds, const TArray<float>& Values);
+
+	/** Set Value on every cell whose Mask entry is true, Mask has one entry per cell. Returns the number of cells written */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Batch")
+	int32 FillLayerMasked(EPlanetDataLayer Layer, const TArray<bool>& Mask, float Value);
+
+	/** FillLayerMasked with a per-cell bitset (query results) */
+	int32 FillLayerBits(EPlanetDataLayer Layer, const TBitArray<>& Mask, float Value);
+
+	/** FillLayerMasked with a predicate, called once per cell from the game thread */
+	int32 FillLayerWhere(EPlanetDataLayer Layer, TFunctionRef<bool(int32)> Predicate, float Value);
+
+	/** Add Delta to the cells (every cell when CellIds is empty) and clamp the result to [MinValue, MaxValue]. Returns the number of cells written */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Batch")
+	int32 AddToCells(EPlanetDataLayer Layer, const TArray<int32>& CellIds, float Delta, float MinValue, float MaxValue);
+
+	/** Overwrite a layer with another, converted like Get/SetLayerValues */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Batch")
+	bool CopyLayer(EPlanetDataLayer Source, EPlanetDataLayer Target);
+
+	// === QUERIES ===
+	// C++ callers compose FPlanetQuery directly and can feed the bitset to FillLayerBits
+
+	/** Cells matching every condition (every cell when Conditions is empty), in increasing order. Returns the number of cells */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Query")
+	int32 QueryCells(const TArray<FPlanetQueryCondition>& Conditions, TArray<int32>& OutCellIds) const;
+
+	/** Number of cells matching every condition */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Query")
+	int32 CountCells(const TArray<FPlanetQueryCondition>& Conditions) const;
+
 	// === UTILITY METHODS ===
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	bool IsCellUnderwater(int32 CellId) const;
@@ -111,4 +244,120 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Planet Data")
 	FVector CellIdToWorldPosition(int32 CellId) const;
+
+	/** Cell hit by a world space ray (mouse picking, traces), INDEX_NONE when the ray misses the planet */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	int32 FindCellAlongRay(const FVector& RayOrigin, const FVector& RayDirection, FVector& OutHitLocation) const;
+
+	/** Batched FindCellAlongRay, one cell per ray, processed in parallel */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data")
+	void FindCellsAlongRays(const TArray<FVector>& RayOrigins, const TArray<FVector>& RayDirections, TArray<int32>& OutCellIds) const;
+
+	// === PATHFINDING ===
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Pathfinding")
+	bool FindPath(int32 StartCellId, int32 GoalCellId, TArray<int32>& OutPath);
+
+	/** Distance (movement cost) from every cell to the nearest source, and the neighbor to move to */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Pathfinding")
+	void ComputeFlowField(const TArray<int32>& SourceCellIds, TArray<float>& OutDistances, TArray<int32>& OutNextCellIds) const;
+
+	// === VISIBILITY ===
+	/** Cells visible from a cell over the elevation and the planet curvature (FPlanetViewshed), sorted by cell id */
+	UFUNCTION(BlueprintCallable, Category = "Planet Data|Visibility")
+	void ComputeViewshed(int32 ObserverCellId, const FPlanetViewshedSettings& Settings, TArray<int32>& OutVisibleCells) const;
+
+	/** Viewsheds of many observers, computed in parallel */
+	void ComputeViewsheds(TConstArrayView<int32> ObserverCellIds, const FPlanetViewshedSettings& Settings, TArray<TArray<int32>>& OutVisibleCells) const;
+
+	// === CHANGE TRACKING ===
+	/** Immediate notification, used by caches that must stay exact (pathfinding) */
+	FOnPlanetCellDataChanged OnCellDataChanged;
+
+	/** Per-frame change set, published at the end of the frame in which cells changed */
+	FOnPlanetLayersChanged OnLayersChanged;
+
+	/** Record a change made to a layer without going through the setters (bulk writes, simulation kernels) */
+	void MarkCellDirty(EPlanetDataLayer Layer, int32 CellId);
+	void MarkCellsDirty(EPlanetDataLayer Layer, TConstArrayView<int32> CellIds);
+	void MarkLayerDirty(EPlanetDataLayer Layer);
+
+	/** Publish pending changes now instead of waiting for the end of the frame */
+	void FlushChanges();
+
+	/** Drop pending changes without publishing them, for writes restoring values listeners already have */
+	void DiscardChanges() { DirtyTracker.DiscardPendingChanges(); }
+
+	/** Changes published by the last flush */
+	const FPlanetChangeSet& GetLastChangeSet() const { return LastChangeSet; }
+
+	/** Cell bits and chunk versions, for consumers polling instead of listening */
+	const FPlanetDirtyTracker& GetDirtyTracker() const { return DirtyTracker; }
+
+	/** Registers with the world UPlanetManagerSubsystem, which may hibernate the layers of planets far from every viewpoint */
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// === RUNTIME LAYERS ===
+	/** Layers registered by simulation systems, sized with the data layers (transient) */
+	FPlanetLayerRegistry& GetLayerRegistry() { return LayerRegistry; }
+	const FPlanetLayerRegistry& GetLayerRegistry() const { return LayerRegistry; }
+
+	/** Hierarchical pathfinder for this planet, built on first use */
+	FHexHierarchicalPathfinder& GetPathfinder();
+
+	/** Grid topology, spatial index and geometry shared with every planet of the same grid (FHexGridRuntimeCache), null without a grid */
+	FHexGridRuntimePtr GetGridRuntime() const { return Grid ? Grid->GetRuntime() : nullptr; }
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PreEditChange(FProperty* PropertyAboutToChange) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	/**
+	 * Put "no biome" back in palette slot 0 and move every cell index from PreviousPalette to the same biome
+	 * in BiomePalette. Biomes removed from the palette become "no biome"
+	 */
+	void RemapBiomeIndices(const TArray<TObjectPtr<UBiomeData>>& PreviousPalette);
+
+	/** Float storage of a layer, nullptr for packed / integer layers */
+	float* GetFloatLayerData(EPlanetDataLayer Layer);
+
+	/** Single cell access for the batch operations, CellId must be valid */
+	float GetCellValueUnchecked(EPlanetDataLayer Layer, int32 CellId) const;
+	void SetCellValueUnchecked(EPlanetDataLayer Layer, int32 CellId, float Value);
+
+	/** Mark written cells dirty and notify traversal caches, large batches are reported as whole layer changes */
+	void NotifyCellsChanged(EPlanetDataLayer Layer, TConstArrayView<int32> CellIds);
+
+	/** Unpacked layers saved before the packed storage, migrated in PostLoad */
+	UPROPERTY()
+	TArray<int32> ElevationLevel_DEPRECATED;
+
+	UPROPERTY()
+	TArray<int32> TectonicPlateId_DEPRECATED;
+
+	UPROPERTY()
+	TArray<int32> CellRegionId_DEPRECATED;
+
+	/** Per-cell biome references saved before the palette, migrated in PostLoad */
+	UPROPERTY()
+	TArray<TObjectPtr<UBiomeData>> Biome_DEPRECATED;
+
+#if WITH_EDITORONLY_DATA
+	/** Palette before an editor change, to remap the cells after it */
+	TArray<TObjectPtr<UBiomeData>> PreEditBiomePalette;
+#endif
+
+	/** Palette lookup tables, every index of the uint8 layer is valid */
+	TStaticArray<float, MAX_BIOMES> BiomeMovementCosts;
+	TStaticArray<FLinearColor, MAX_BIOMES> BiomeMapColors;
+
+	TSharedPtr<FHexHierarchicalPathfinder> Pathfinder;
+	FPlanetLayerRegistry LayerRegistry;
+	FPlanetDirtyTracker DirtyTracker;
+	FPlanetChangeSet LastChangeSet;
 };
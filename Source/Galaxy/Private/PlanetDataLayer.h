@@ -0,0 +1,25 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlanetDataLayer.generated.h"
+
+/**
+ * Built-in data layers of UPlanetData, used for generic access (aggregation, batch processing) and change tracking
+ */
+UENUM(BlueprintType)
+enum class EPlanetDataLayer : uint8
+{
+	Elevation		UMETA(DisplayName = "Elevation"),
+	Temperature		UMETA(DisplayName = "Temperature"),
+	Humidity		UMETA(DisplayName = "Humidity"),
+	TectonicPlate	UMETA(DisplayName = "Tectonic Plate"),
+	Region			UMETA(DisplayName = "Region"),
+	Biome			UMETA(DisplayName = "Biome (palette index)"),
+
+	Count			UMETA(Hidden)
+};
+
+inline constexpr int32 PlanetDataLayerCount = static_cast<int32>(EPlanetDataLayer::Count);
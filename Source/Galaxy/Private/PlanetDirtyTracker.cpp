@@ -0,0 +1,121 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetDirtyTracker.h"
+
+bool FPlanetChangeSet::HasAnyChanges() const
+{
+	for (const FPlanetLayerChanges& changes : Layers)
+	{
+		if (changes.HasChanges())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FPlanetDirtyTracker::Initialize(int32 cellCount)
+{
+	CellCount = cellCount;
+
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		FLayerState& state = Layers[layerIdx];
+		state.DirtyBits.Init(false, CellCount);
+		state.PendingCellIds.Reset();
+		state.ChunkVersions.Init(state.Version, GetChunkCount());
+		MarkAll(static_cast<EPlanetDataLayer>(layerIdx));
+	}
+}
+
+void FPlanetDirtyTracker::MarkCell(EPlanetDataLayer layer, int32 cellId)
+{
+	FLayerState& state = Layers[static_cast<int32>(layer)];
+	if (cellId < 0 || cellId >= CellCount)
+	{
+		return;
+	}
+
+	++state.ChunkVersions[GetChunkOfCell(cellId)];
+	++state.Version;
+	bHasPendingChanges = true;
+
+	if (!state.bAllDirty && !state.DirtyBits[cellId])
+	{
+		state.DirtyBits[cellId] = true;
+		state.PendingCellIds.Add(cellId);
+	}
+}
+
+void FPlanetDirtyTracker::MarkCells(EPlanetDataLayer layer, TConstArrayView<int32> cellIds)
+{
+	for (int32 cellId : cellIds)
+	{
+		MarkCell(layer, cellId);
+	}
+}
+
+void FPlanetDirtyTracker::MarkAll(EPlanetDataLayer layer)
+{
+	FLayerState& state = Layers[static_cast<int32>(layer)];
+
+	for (uint32& chunkVersion : state.ChunkVersions)
+	{
+		++chunkVersion;
+	}
+	++state.Version;
+
+	// The cell list is no longer needed, the whole layer will be reported
+	for (int32 cellId : state.PendingCellIds)
+	{
+		state.DirtyBits[cellId] = false;
+	}
+	state.PendingCellIds.Reset();
+	state.bAllDirty = true;
+	bHasPendingChanges = true;
+}
+
+bool FPlanetDirtyTracker::IsCellDirty(EPlanetDataLayer layer, int32 cellId) const
+{
+	const FLayerState& state = Layers[static_cast<int32>(layer)];
+	return state.bAllDirty || (state.DirtyBits.IsValidIndex(cellId) && state.DirtyBits[cellId]);
+}
+
+void FPlanetDirtyTracker::Flush(FPlanetChangeSet& outChangeSet)
+{
+	outChangeSet.FrameNumber = GFrameCounter;
+
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		FLayerState& state = Layers[layerIdx];
+		FPlanetLayerChanges& changes = outChangeSet.Layers[layerIdx];
+
+		for (int32 cellId : state.PendingCellIds)
+		{
+			state.DirtyBits[cellId] = false;
+		}
+
+		changes.bAllCells = state.bAllDirty;
+		changes.CellIds = MoveTemp(state.PendingCellIds);
+		state.PendingCellIds.Reset();
+		state.bAllDirty = false;
+	}
+
+	bHasPendingChanges = false;
+}
+
+void FPlanetDirtyTracker::DiscardPendingChanges()
+{
+	for (FLayerState& state : Layers)
+	{
+		for (int32 cellId : state.PendingCellIds)
+		{
+			state.DirtyBits[cellId] = false;
+		}
+		state.PendingCellIds.Reset();
+		state.bAllDirty = false;
+	}
+
+	bHasPendingChanges = false;
+}
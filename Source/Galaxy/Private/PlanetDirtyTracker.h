@@ -0,0 +1,104 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlanetDataLayer.h"
+
+/// <summary>
+/// Cells of one layer that changed during a frame
+/// </summary>
+struct GALAXY_API FPlanetLayerChanges
+{
+	/// <summary>
+	/// Every cell changed (layer reset, bulk write), CellIds is empty in that case
+	/// </summary>
+	bool bAllCells = false;
+
+	/// <summary>
+	/// Changed cells, each listed once, in the order they were first changed
+	/// </summary>
+	TArray<int32> CellIds;
+
+	bool HasChanges() const { return bAllCells || CellIds.Num() > 0; }
+};
+
+/// <summary>
+/// Changes of every layer published at the end of a frame
+/// </summary>
+struct GALAXY_API FPlanetChangeSet
+{
+	uint64 FrameNumber = 0;
+	TStaticArray<FPlanetLayerChanges, PlanetDataLayerCount> Layers;
+
+	const FPlanetLayerChanges& Get(EPlanetDataLayer layer) const { return Layers[static_cast<int32>(layer)]; }
+	bool HasChanges(EPlanetDataLayer layer) const { return Get(layer).HasChanges(); }
+	bool HasAnyChanges() const;
+};
+
+/// <summary>
+/// Per-layer dirty tracking at cell and chunk granularity.
+///
+/// Cells are tracked with one bit each plus a list of pending ids, so marking and flushing cost
+/// O(edited cells). Chunks of ChunkSize consecutive cells carry a version number bumped on every
+/// change, consumers that poll (renderer, replication) compare it with the version they last saw.
+/// Not thread-safe, mark cells from the game thread.
+/// </summary>
+class GALAXY_API FPlanetDirtyTracker
+{
+public:
+	static constexpr int32 ChunkShift = 10;
+	static constexpr int32 ChunkSize = 1 << ChunkShift;
+
+	/// <summary>
+	/// Resize for a cell count, clears pending changes and marks every layer fully changed.
+	/// Chunk versions continue from the layer versions, so no chunk goes back to a version seen before.
+	/// </summary>
+	void Initialize(int32 cellCount);
+
+	void MarkCell(EPlanetDataLayer layer, int32 cellId);
+	void MarkCells(EPlanetDataLayer layer, TConstArrayView<int32> cellIds);
+	void MarkAll(EPlanetDataLayer layer);
+
+	bool HasPendingChanges() const { return bHasPendingChanges; }
+	bool IsCellDirty(EPlanetDataLayer layer, int32 cellId) const;
+
+	/// <summary>
+	/// Move the pending changes to a change set and clear them
+	/// </summary>
+	void Flush(FPlanetChangeSet& outChangeSet);
+
+	/// <summary>
+	/// Clear the pending changes without publishing them, versions are kept
+	/// </summary>
+	void DiscardPendingChanges();
+
+	int32 GetCellCount() const { return CellCount; }
+	int32 GetChunkCount() const { return FMath::DivideAndRoundUp(CellCount, ChunkSize); }
+	static int32 GetChunkOfCell(int32 cellId) { return cellId >> ChunkShift; }
+
+	/// <summary>
+	/// Version of a chunk of a layer, increases every time one of its cells changes
+	/// </summary>
+	uint32 GetChunkVersion(EPlanetDataLayer layer, int32 chunkIndex) const { return Layers[static_cast<int32>(layer)].ChunkVersions[chunkIndex]; }
+
+	/// <summary>
+	/// Version of a whole layer, increases every time one of its cells changes
+	/// </summary>
+	uint32 GetLayerVersion(EPlanetDataLayer layer) const { return Layers[static_cast<int32>(layer)].Version; }
+
+private:
+	struct FLayerState
+	{
+		TBitArray<> DirtyBits;
+		TArray<int32> PendingCellIds;
+		TArray<uint32> ChunkVersions;
+		uint32 Version = 0;
+		bool bAllDirty = false;
+	};
+
+	TStaticArray<FLayerState, PlanetDataLayerCount> Layers;
+	int32 CellCount = 0;
+	bool bHasPendingChanges = false;
+};
@@ -0,0 +1,442 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetFogOfWar.h"
+#include "PlanetData.h"
+#include "HexGridAsset.h"
+#include "HexGridIterators.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	const TBitArray<> EmptyBits;
+}
+
+UPlanetFogOfWarComponent::UPlanetFogOfWarComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UPlanetFogOfWarComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!Planet && GetOwner())
+	{
+		Planet = GetOwner()->FindComponentByClass<UPlanetData>();
+	}
+
+	if (Planet)
+	{
+		LayersChangedHandle = Planet->OnLayersChanged.AddUObject(this, &UPlanetFogOfWarComponent::HandleLayersChanged);
+	}
+}
+
+void UPlanetFogOfWarComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Planet)
+	{
+		Planet->OnLayersChanged.Remove(LayersChangedHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UPlanetFogOfWarComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UpdateVisibility();
+}
+
+bool UPlanetFogOfWarComponent::IsPlanetReady() const
+{
+	return Planet && Planet->Grid && Planet->AreDataLayersInitialized();
+}
+
+UPlanetFogOfWarComponent::FPlayerVisibility& UPlanetFogOfWarComponent::GetOrAddPlayer(int32 playerIndex)
+{
+	if (playerIndex >= Players.Num())
+	{
+		Players.SetNum(playerIndex + 1);
+	}
+
+	return Players[playerIndex];
+}
+
+void UPlanetFogOfWarComponent::MarkDirty(int32 sourceId)
+{
+	FSightSource& source = Sources[sourceId];
+	if (!source.bDirty)
+	{
+		source.bDirty = true;
+		DirtySources.Add(sourceId);
+	}
+}
+
+int32 UPlanetFogOfWarComponent::AddSightSource(int32 PlayerIndex, int32 CellId, int32 SightRadius)
+{
+	if (PlayerIndex < 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetFogOfWarComponent::AddSightSource - Invalid player index %d."), PlayerIndex);
+		return INDEX_NONE;
+	}
+
+	GetOrAddPlayer(PlayerIndex);
+
+	FSightSource source;
+	source.PlayerIndex = PlayerIndex;
+	source.CellId = CellId;
+	source.SightRadius = FMath::Clamp(SightRadius, 0, MAX_SIGHT_RADIUS);
+
+	const int32 sourceId = Sources.Add(MoveTemp(source));
+	MarkDirty(sourceId);
+	return sourceId;
+}
+
+void UPlanetFogOfWarComponent::RemoveSightSource(int32 SourceId)
+{
+	if (!Sources.IsValidIndex(SourceId))
+	{
+		return;
+	}
+
+	FSightSource& source = Sources[SourceId];
+	if (source.AppliedFootprint.IsValid())
+	{
+		RemovedFootprints.Emplace(source.PlayerIndex, MoveTemp(source.AppliedFootprint));
+	}
+
+	// A source added in the same slot before the update is dirty again, stale ids in DirtySources are skipped through bDirty
+	Sources.RemoveAt(SourceId);
+}
+
+void UPlanetFogOfWarComponent::MoveSightSource(int32 SourceId, int32 CellId)
+{
+	if (Sources.IsValidIndex(SourceId) && Sources[SourceId].CellId != CellId)
+	{
+		Sources[SourceId].CellId = CellId;
+		MarkDirty(SourceId);
+	}
+}
+
+void UPlanetFogOfWarComponent::SetSightRadius(int32 SourceId, int32 SightRadius)
+{
+	SightRadius = FMath::Clamp(SightRadius, 0, MAX_SIGHT_RADIUS);
+	if (Sources.IsValidIndex(SourceId) && Sources[SourceId].SightRadius != SightRadius)
+	{
+		Sources[SourceId].SightRadius = SightRadius;
+		MarkDirty(SourceId);
+	}
+}
+
+bool UPlanetFogOfWarComponent::IsCellVisible(int32 PlayerIndex, int32 CellId) const
+{
+	const TBitArray<>& visible = GetVisibleCells(PlayerIndex);
+	return visible.IsValidIndex(CellId) && visible[CellId];
+}
+
+bool UPlanetFogOfWarComponent::IsCellExplored(int32 PlayerIndex, int32 CellId) const
+{
+	const TBitArray<>& explored = GetExploredCells(PlayerIndex);
+	return explored.IsValidIndex(CellId) && explored[CellId];
+}
+
+const TBitArray<>& UPlanetFogOfWarComponent::GetVisibleCells(int32 PlayerIndex) const
+{
+	return Players.IsValidIndex(PlayerIndex) ? Players[PlayerIndex].Visible : EmptyBits;
+}
+
+const TBitArray<>& UPlanetFogOfWarComponent::GetExploredCells(int32 PlayerIndex) const
+{
+	return Players.IsValidIndex(PlayerIndex) ? Players[PlayerIndex].Explored : EmptyBits;
+}
+
+void UPlanetFogOfWarComponent::ExploreAll(int32 PlayerIndex)
+{
+	if (PlayerIndex < 0 || !IsPlanetReady())
+	{
+		return;
+	}
+
+	SyncVisibilityGrid();
+	GetOrAddPlayer(PlayerIndex).Explored.Init(true, Planet->GetCellCount());
+}
+
+TArray<int32> UPlanetFogOfWarComponent::BuildFootprint(const UPlanetData& planet, int32 cellId, int32 sightRadius, bool bLineOfSight, const FPlanetViewshedSettings& lineOfSight)
+{
+	TArray<int32> cells;
+
+	const UHexGridAsset& grid = *planet.Grid;
+	if (!grid.Cells.IsValidIndex(cellId))
+	{
+		return cells;
+	}
+
+	if (bLineOfSight)
+	{
+		// A radius of 0 means the viewshed limit, the source only sees its own cell
+		if (sightRadius == 0)
+		{
+			cells.Add(cellId);
+			return cells;
+		}
+
+		FPlanetViewshedSettings settings = lineOfSight;
+		settings.MaxRadius = sightRadius;
+		FPlanetViewshed::Compute(planet, cellId, settings, cells);
+		return cells;
+	}
+
+	for (THexSpiralIterator<MAX_SIGHT_RADIUS> It(grid, cellId, sightRadius); It; ++It)
+	{
+		cells.Add(*It);
+	}
+
+	cells.Sort();
+	return cells;
+}
+
+FPlanetSightFootprint UPlanetFogOfWarComponent::GetFootprint(int32 CellId, int32 SightRadius)
+{
+	if (!IsPlanetReady())
+	{
+		return nullptr;
+	}
+
+	SyncFootprintSettings();
+
+	SightRadius = FMath::Clamp(SightRadius, 0, MAX_SIGHT_RADIUS);
+	FPlanetSightFootprint& footprint = FootprintCache.FindOrAdd(GetFootprintKey(CellId, SightRadius));
+	if (!footprint.IsValid())
+	{
+		footprint = MakeShared<const TArray<int32>, ESPMode::ThreadSafe>(BuildFootprint(*Planet, CellId, SightRadius, bUseLineOfSight, LineOfSight));
+	}
+
+	return footprint;
+}
+
+bool UPlanetFogOfWarComponent::SyncVisibilityGrid()
+{
+	// Counts of the previous grid do not match the new cells, removing an old footprint would underflow them
+	const int32 cellCount = Planet->GetCellCount();
+	if (cellCount == VisibilityCellCount && VisibilityGrid.Get() == Planet->Grid)
+	{
+		return false;
+	}
+
+	for (FPlayerVisibility& player : Players)
+	{
+		player.SourceCounts.Init(0, cellCount);
+		player.Visible.Init(false, cellCount);
+		player.Explored.Init(false, cellCount);
+	}
+
+	FootprintCache.Reset();
+	RemovedFootprints.Reset();
+	for (auto It = Sources.CreateIterator(); It; ++It)
+	{
+		It->AppliedFootprint.Reset();
+		MarkDirty(It.GetIndex());
+	}
+
+	VisibilityGrid = Planet->Grid;
+	VisibilityCellCount = cellCount;
+	return true;
+}
+
+void UPlanetFogOfWarComponent::UpdateVisibility()
+{
+	if (!IsPlanetReady())
+	{
+		return;
+	}
+
+	const bool bGridChanged = SyncVisibilityGrid();
+	SyncFootprintSettings();
+	if (!bGridChanged && DirtySources.Num() == 0 && RemovedFootprints.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 cellCount = Planet->GetCellCount();
+
+	// Build the missing footprints in parallel
+	TArray<uint64> missingKeys;
+	for (int32 sourceId : DirtySources)
+	{
+		if (Sources.IsValidIndex(sourceId) && Sources[sourceId].bDirty)
+		{
+			const FSightSource& source = Sources[sourceId];
+			const uint64 key = GetFootprintKey(source.CellId, source.SightRadius);
+			if (!FootprintCache.Contains(key))
+			{
+				FootprintCache.Add(key);
+				missingKeys.Add(key);
+			}
+		}
+	}
+
+	TArray<FPlanetSightFootprint> built;
+	built.SetNum(missingKeys.Num());
+	ParallelFor(missingKeys.Num(), [&](int32 keyIdx)
+		{
+			const int32 cellId = static_cast<int32>(missingKeys[keyIdx] >> 32);
+			const int32 sightRadius = static_cast<int32>(static_cast<uint32>(missingKeys[keyIdx]));
+			built[keyIdx] = MakeShared<const TArray<int32>, ESPMode::ThreadSafe>(BuildFootprint(*Planet, cellId, sightRadius, bUseLineOfSight, LineOfSight));
+		});
+
+	for (int32 keyIdx = 0; keyIdx < missingKeys.Num(); ++keyIdx)
+	{
+		FootprintCache[missingKeys[keyIdx]] = MoveTemp(built[keyIdx]);
+	}
+
+	// Group the footprint changes by player
+	TArray<TArray<FFootprintDelta>> deltas;
+	deltas.SetNum(Players.Num());
+
+	for (TPair<int32, FPlanetSightFootprint>& removed : RemovedFootprints)
+	{
+		deltas[removed.Key].Add({ MoveTemp(removed.Value), nullptr });
+	}
+	RemovedFootprints.Reset();
+
+	for (int32 sourceId : DirtySources)
+	{
+		if (!Sources.IsValidIndex(sourceId) || !Sources[sourceId].bDirty)
+		{
+			continue;
+		}
+
+		FSightSource& source = Sources[sourceId];
+		source.bDirty = false;
+
+		FPlanetSightFootprint footprint = FootprintCache.FindRef(GetFootprintKey(source.CellId, source.SightRadius));
+		if (footprint != source.AppliedFootprint)
+		{
+			deltas[source.PlayerIndex].Add({ source.AppliedFootprint, footprint });
+			source.AppliedFootprint = MoveTemp(footprint);
+		}
+	}
+	DirtySources.Reset();
+
+	// Players are independent, apply their changes in parallel
+	TArray<bool> changedPlayers;
+	changedPlayers.Init(bGridChanged, Players.Num());
+
+	ParallelFor(Players.Num(), [&](int32 playerIndex)
+		{
+			if (deltas[playerIndex].Num() == 0)
+			{
+				return;
+			}
+
+			FPlayerVisibility& player = Players[playerIndex];
+			if (player.SourceCounts.Num() != cellCount)
+			{
+				player.SourceCounts.SetNumZeroed(cellCount);
+				player.Visible.Init(false, cellCount);
+			}
+			if (player.Explored.Num() != cellCount)
+			{
+				player.Explored.Init(false, cellCount);
+			}
+
+			bool bChanged = false;
+			for (const FFootprintDelta& delta : deltas[playerIndex])
+			{
+				// Add first so cells in both footprints never drop to zero
+				if (delta.Added.IsValid())
+				{
+					for (int32 cellId : *delta.Added)
+					{
+						if (player.SourceCounts[cellId]++ == 0)
+						{
+							player.Visible[cellId] = true;
+							player.Explored[cellId] = true;
+							bChanged = true;
+						}
+					}
+				}
+
+				if (delta.Removed.IsValid())
+				{
+					for (int32 cellId : *delta.Removed)
+					{
+						if (--player.SourceCounts[cellId] == 0)
+						{
+							player.Visible[cellId] = false;
+							bChanged = true;
+						}
+					}
+				}
+			}
+
+			changedPlayers[playerIndex] |= bChanged;
+		});
+
+	TrimFootprintCache();
+
+	for (int32 playerIndex = 0; playerIndex < Players.Num(); ++playerIndex)
+	{
+		if (changedPlayers[playerIndex])
+		{
+			OnVisibilityChanged.Broadcast(playerIndex);
+		}
+	}
+}
+
+void UPlanetFogOfWarComponent::TrimFootprintCache()
+{
+	if (FootprintCache.Num() <= MaxCachedFootprints)
+	{
+		return;
+	}
+
+	// Drop the footprints only the cache holds
+	for (auto It = FootprintCache.CreateIterator(); It; ++It)
+	{
+		if (!It->Value.IsValid() || It->Value.GetSharedReferenceCount() == 1)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UPlanetFogOfWarComponent::HandleLayersChanged(const FPlanetChangeSet& changes)
+{
+	if (!bUseLineOfSight || !changes.HasChanges(EPlanetDataLayer::Elevation))
+	{
+		return;
+	}
+
+	// Elevation edits are rare, rebuild every footprint at the next update
+	InvalidateFootprints();
+}
+
+void UPlanetFogOfWarComponent::SyncFootprintSettings()
+{
+	// MaxRadius is not compared, every footprint uses the sight radius of its source
+	const bool bSameSettings = bUseLineOfSight == bFootprintLineOfSight
+		&& (!bUseLineOfSight
+			|| (LineOfSight.ObserverHeight == FootprintLineOfSight.ObserverHeight
+				&& LineOfSight.TargetHeight == FootprintLineOfSight.TargetHeight
+				&& LineOfSight.HeightPerLevel == FootprintLineOfSight.HeightPerLevel));
+	if (bSameSettings)
+	{
+		return;
+	}
+
+	bFootprintLineOfSight = bUseLineOfSight;
+	FootprintLineOfSight = LineOfSight;
+	InvalidateFootprints();
+}
+
+void UPlanetFogOfWarComponent::InvalidateFootprints()
+{
+	FootprintCache.Reset();
+	for (auto It = Sources.CreateIterator(); It; ++It)
+	{
+		MarkDirty(It.GetIndex());
+	}
+}
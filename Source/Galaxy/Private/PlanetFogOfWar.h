@@ -0,0 +1,175 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "PlanetViewshed.h"
+#include "PlanetFogOfWar.generated.h"
+
+class UPlanetData;
+class UHexGridAsset;
+struct FPlanetChangeSet;
+
+/** Broadcast at the end of a fog update for every player whose visible cells changed */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlanetVisibilityChanged, int32 /* PlayerIndex */);
+
+/// <summary>
+/// Cells seen by a sight source standing on a cell, shared by every source with the same cell and radius
+/// </summary>
+using FPlanetSightFootprint = TSharedPtr<const TArray<int32>, ESPMode::ThreadSafe>;
+
+/**
+ * Per-player visibility of the planet cells, from sight sources (units, buildings) standing on cells.
+ *
+ * Every player has a count of the sources seeing each cell plus two bitsets: the cells visible now and
+ * the cells ever explored. Moving a source only queues it; at the next tick the footprints that are not
+ * cached yet are built in parallel, then every moved source removes its old footprint and adds its new
+ * one to the counts, in parallel across players. A frame with many units moving costs about the cells
+ * of their footprints, whatever the number of cells of the planet.
+ *
+ * Footprints are the cells within the sight radius, optionally only those in the viewshed (FPlanetViewshed).
+ * They are cached per cell and radius and rebuilt when the elevation layer or the line of sight settings change.
+ */
+UCLASS(classGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GALAXY_API UPlanetFogOfWarComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Sight radius limit, in cells */
+	static constexpr int32 MAX_SIGHT_RADIUS = 32;
+
+	UPlanetFogOfWarComponent();
+
+	/** Planet to track, the owner's UPlanetData when not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fog Of War")
+	TObjectPtr<UPlanetData> Planet;
+
+	/** Hide the cells behind higher cells, otherwise sources see every cell within their radius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fog Of War")
+	bool bUseLineOfSight = true;
+
+	/** Heights used for line of sight, MaxRadius is replaced by the sight radius of each source */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fog Of War")
+	FPlanetViewshedSettings LineOfSight;
+
+	/** Footprints kept once no source uses them anymore */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fog Of War", meta = (ClampMin = "0"))
+	int32 MaxCachedFootprints = 4096;
+
+	/** Add a sight source for a player, returns its id */
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	int32 AddSightSource(int32 PlayerIndex, int32 CellId, int32 SightRadius);
+
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	void RemoveSightSource(int32 SourceId);
+
+	/** Move a source, the fog is updated at the next tick */
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	void MoveSightSource(int32 SourceId, int32 CellId);
+
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	void SetSightRadius(int32 SourceId, int32 SightRadius);
+
+	/** Apply the pending source changes now instead of at the next tick */
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	void UpdateVisibility();
+
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	bool IsCellVisible(int32 PlayerIndex, int32 CellId) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	bool IsCellExplored(int32 PlayerIndex, int32 CellId) const;
+
+	/** Mark every cell explored for a player (map reveal, loaded game) */
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	void ExploreAll(int32 PlayerIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	int32 GetPlayerCount() const { return Players.Num(); }
+
+	/** Visible / explored cells of a player indexed by cell id, empty for an unknown player */
+	const TBitArray<>& GetVisibleCells(int32 PlayerIndex) const;
+	const TBitArray<>& GetExploredCells(int32 PlayerIndex) const;
+
+	/** Cells seen from a cell with the current settings, built on first use. Game thread */
+	FPlanetSightFootprint GetFootprint(int32 CellId, int32 SightRadius);
+
+	FOnPlanetVisibilityChanged OnVisibilityChanged;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	struct FPlayerVisibility
+	{
+		/** Number of sources seeing each cell */
+		TArray<uint16> SourceCounts;
+		TBitArray<> Visible;
+		TBitArray<> Explored;
+	};
+
+	struct FSightSource
+	{
+		int32 PlayerIndex = 0;
+		int32 CellId = INDEX_NONE;
+		int32 SightRadius = 0;
+
+		/** Footprint currently added to the player counts */
+		FPlanetSightFootprint AppliedFootprint;
+		bool bDirty = false;
+	};
+
+	/** Footprint changes of one player during an update */
+	struct FFootprintDelta
+	{
+		FPlanetSightFootprint Removed;
+		FPlanetSightFootprint Added;
+	};
+
+	static uint64 GetFootprintKey(int32 cellId, int32 sightRadius) { return (static_cast<uint64>(cellId) << 32) | static_cast<uint32>(sightRadius); }
+
+	/** Cells seen from a cell, thread-safe */
+	static TArray<int32> BuildFootprint(const UPlanetData& planet, int32 cellId, int32 sightRadius, bool bLineOfSight, const FPlanetViewshedSettings& lineOfSight);
+
+	bool IsPlanetReady() const;
+
+	/**
+	 * Forget the counts and applied footprints of every player and queue every source again when the planet
+	 * grid changed. Returns true if it did
+	 */
+	bool SyncVisibilityGrid();
+
+	/** Drop the cached footprints when bUseLineOfSight or LineOfSight changed since they were built */
+	void SyncFootprintSettings();
+
+	/** Drop the cached footprints and queue every source again */
+	void InvalidateFootprints();
+
+	FPlayerVisibility& GetOrAddPlayer(int32 playerIndex);
+	void MarkDirty(int32 sourceId);
+	void TrimFootprintCache();
+	void HandleLayersChanged(const FPlanetChangeSet& changes);
+
+	TSparseArray<FSightSource> Sources;
+	TArray<int32> DirtySources;
+
+	/** Sources whose footprint has to be removed without a new one */
+	TArray<TPair<int32, FPlanetSightFootprint>> RemovedFootprints;
+
+	TArray<FPlayerVisibility> Players;
+	TMap<uint64, FPlanetSightFootprint> FootprintCache;
+
+	/** Settings the cached footprints were built with */
+	bool bFootprintLineOfSight = true;
+	FPlanetViewshedSettings FootprintLineOfSight;
+
+	/** Grid the counts and applied footprints refer to */
+	TWeakObjectPtr<const UHexGridAsset> VisibilityGrid;
+	int32 VisibilityCellCount = 0;
+
+	FDelegateHandle LayersChangedHandle;
+};
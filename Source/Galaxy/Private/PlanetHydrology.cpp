@@ -0,0 +1,238 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetHydrology.h"
+#include "HexGridAsset.h"
+#include "HexGridGeometry.h"
+#include "HexRegionLabeling.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+namespace
+{
+	struct FFloodNode
+	{
+		float Elevation = 0.0f;
+		int32 Order = 0;
+		int32 CellId = INDEX_NONE;
+	};
+
+	/// <summary>
+	/// Lowest elevation first, insertion order on ties so the flood does not depend on the heap layout
+	/// </summary>
+	struct FFloodNodePredicate
+	{
+		bool operator()(const FFloodNode& A, const FFloodNode& B) const
+		{
+			return A.Elevation < B.Elevation || (A.Elevation == B.Elevation && A.Order < B.Order);
+		}
+	};
+}
+
+const FName FPlanetHydrology::DownstreamLayerName(TEXT("Hydrology.Downstream"));
+const FName FPlanetHydrology::AccumulationLayerName(TEXT("Hydrology.Accumulation"));
+const FName FPlanetHydrology::LakeLayerName(TEXT("Hydrology.Lake"));
+
+void FPlanetHydrologyResult::Reset()
+{
+	DownstreamCellIds.Reset();
+	Accumulation.Reset();
+	FilledElevation.Reset();
+	LakeIds.Reset();
+	LakeSizes.Reset();
+}
+
+bool FPlanetHydrology::Compute(const UHexGridAsset& grid, TConstArrayView<float> elevations, float waterLevel, FPlanetHydrologyResult& outResult)
+{
+	const int32 cellCount = grid.Cells.Num();
+	outResult.Reset();
+
+	if (cellCount == 0 || elevations.Num() != cellCount)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetHydrology::Compute - %d elevations given for %d cells."), elevations.Num(), cellCount);
+		return false;
+	}
+
+	outResult.DownstreamCellIds.Init(INDEX_NONE, cellCount);
+	outResult.FilledElevation = TArray<float>(elevations.GetData(), cellCount);
+
+	TBitArray<> closed(false, cellCount);
+	TArray<FFloodNode> open;
+	TArray<int32> pit;
+	int32 pitHead = 0;
+	int32 order = 0;
+
+	// Water cells are sinks, the flood starts from the ones touching land
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		if (elevations[cellId] > waterLevel)
+		{
+			continue;
+		}
+
+		closed[cellId] = true;
+		outResult.FilledElevation[cellId] = waterLevel;
+		for (uint32 neighborId : grid.GetNeighborView(cellId))
+		{
+			if (elevations[neighborId] > waterLevel)
+			{
+				open.HeapPush({ waterLevel, order++, cellId }, FFloodNodePredicate());
+				break;
+			}
+		}
+	}
+
+	// Dry planet, everything drains to the lowest cell
+	if (open.Num() == 0 && closed.CountSetBits() == 0)
+	{
+		int32 lowestCellId = 0;
+		for (int32 cellId = 1; cellId < cellCount; ++cellId)
+		{
+			if (elevations[cellId] < elevations[lowestCellId])
+			{
+				lowestCellId = cellId;
+			}
+		}
+
+		closed[lowestCellId] = true;
+		open.HeapPush({ elevations[lowestCellId], order++, lowestCellId }, FFloodNodePredicate());
+	}
+
+	while (pitHead < pit.Num() || open.Num() > 0)
+	{
+		int32 cellId;
+		if (pitHead < pit.Num())
+		{
+			cellId = pit[pitHead++];
+		}
+		else
+		{
+			FFloodNode node;
+			open.HeapPop(node, FFloodNodePredicate(), EAllowShrinking::No);
+			cellId = node.CellId;
+		}
+
+		const float surface = outResult.FilledElevation[cellId];
+		for (uint32 neighborId : grid.GetNeighborView(cellId))
+		{
+			if (closed[neighborId])
+			{
+				continue;
+			}
+
+			closed[neighborId] = true;
+			outResult.DownstreamCellIds[neighborId] = cellId;
+
+			// Lower or level with the water surface: part of a depression or flat, flooded first
+			if (elevations[neighborId] <= surface)
+			{
+				outResult.FilledElevation[neighborId] = surface;
+				pit.Add(neighborId);
+			}
+			else
+			{
+				open.HeapPush({ elevations[neighborId], order++, static_cast<int32>(neighborId) }, FFloodNodePredicate());
+			}
+		}
+	}
+
+	// Accumulate cell areas, in average cell areas
+	const FHexGridRuntimePtr gridRuntime = grid.GetRuntime();
+	const FHexGridGeometry& geometry = gridRuntime->GetGeometry();
+	const float areaScale = cellCount / (4.0f * UE_PI);
+	TArray<float> cellAreas;
+	cellAreas.SetNumUninitialized(cellCount);
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		cellAreas[cellId] = geometry.GetCellArea(cellId) * areaScale;
+	}
+
+	Accumulate(outResult.DownstreamCellIds, cellAreas, outResult.Accumulation);
+
+	const TArray<float>& filled = outResult.FilledElevation;
+	FHexRegionLabeler::LabelByPredicate(grid,
+		[&](int32 cellId) { return elevations[cellId] > waterLevel && filled[cellId] > elevations[cellId]; },
+		outResult.LakeIds, outResult.LakeSizes);
+
+	return true;
+}
+
+void FPlanetHydrology::Accumulate(TConstArrayView<int32> downstreamCellIds, TConstArrayView<float> cellValues, TArray<float>& outAccumulation)
+{
+	const int32 cellCount = downstreamCellIds.Num();
+	outAccumulation.SetNumUninitialized(cellCount);
+
+	// Upstream cells of every cell (CSR), in cell id order
+	TArray<int32> upstreamOffsets;
+	upstreamOffsets.SetNumZeroed(cellCount + 1);
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		const int32 downstreamId = downstreamCellIds[cellId];
+		if (downstreamId != INDEX_NONE)
+		{
+			++upstreamOffsets[downstreamId + 1];
+		}
+	}
+
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		upstreamOffsets[cellId + 1] += upstreamOffsets[cellId];
+	}
+
+	TArray<int32> upstreamCellIds;
+	upstreamCellIds.SetNumUninitialized(upstreamOffsets[cellCount]);
+	{
+		TArray<int32> cursor(upstreamOffsets.GetData(), cellCount);
+		for (int32 cellId = 0; cellId < cellCount; ++cellId)
+		{
+			const int32 downstreamId = downstreamCellIds[cellId];
+			if (downstreamId != INDEX_NONE)
+			{
+				upstreamCellIds[cursor[downstreamId]++] = cellId;
+			}
+		}
+	}
+
+	// Rounds start from the sources, a cell joins the next round when its last upstream cell is done
+	TArray<std::atomic<int32>> pendingUpstream;
+	pendingUpstream.SetNum(cellCount);
+
+	TArray<int32> round;
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		const int32 upstreamCount = upstreamOffsets[cellId + 1] - upstreamOffsets[cellId];
+		pendingUpstream[cellId].store(upstreamCount, std::memory_order_relaxed);
+		if (upstreamCount == 0)
+		{
+			round.Add(cellId);
+		}
+	}
+
+	TArray<int32> nextRound;
+	nextRound.SetNumUninitialized(cellCount);
+
+	while (round.Num() > 0)
+	{
+		std::atomic<int32> nextCount = 0;
+
+		ParallelFor(round.Num(), [&](int32 roundIdx)
+			{
+				const int32 cellId = round[roundIdx];
+
+				float total = cellValues[cellId];
+				for (int32 i = upstreamOffsets[cellId]; i < upstreamOffsets[cellId + 1]; ++i)
+				{
+					total += outAccumulation[upstreamCellIds[i]];
+				}
+				outAccumulation[cellId] = total;
+
+				const int32 downstreamId = downstreamCellIds[cellId];
+				if (downstreamId != INDEX_NONE && pendingUpstream[downstreamId].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					nextRound[nextCount.fetch_add(1, std::memory_order_relaxed)] = downstreamId;
+				}
+			});
+
+		round = TArray<int32>(nextRound.GetData(), nextCount.load());
+	}
+}
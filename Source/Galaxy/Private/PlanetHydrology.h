@@ -0,0 +1,81 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UHexGridAsset;
+
+/// <summary>
+/// Drainage of every cell of a planet
+/// </summary>
+struct GALAXY_API FPlanetHydrologyResult
+{
+	/// <summary>
+	/// Neighbor the water of a cell flows to, INDEX_NONE for underwater cells (sinks)
+	/// </summary>
+	TArray<int32> DownstreamCellIds;
+
+	/// <summary>
+	/// Area drained through every cell including itself, in average cell areas (rivers have large values)
+	/// </summary>
+	TArray<float> Accumulation;
+
+	/// <summary>
+	/// Elevation of the water surface once every depression is filled, equal to the elevation outside lakes
+	/// </summary>
+	TArray<float> FilledElevation;
+
+	/// <summary>
+	/// Lake of every cell, INDEX_NONE outside lakes
+	/// </summary>
+	TArray<int32> LakeIds;
+	TArray<int32> LakeSizes;
+
+	int32 GetLakeCount() const { return LakeSizes.Num(); }
+	bool IsLake(int32 cellId) const { return LakeIds[cellId] != INDEX_NONE; }
+
+	void Reset();
+};
+
+/// <summary>
+/// Hydrology over the cell graph.
+///
+/// A priority flood from the water cells (Barnes et al. 2014) visits every land cell in order of the
+/// lowest level water must reach to leave it, filling depressions on the way. Each cell drains into the
+/// cell it was reached from, which routes water across flats and out of lakes. Depressions and flats
+/// are flooded through a plain queue, so only cells climbing out of them pay the heap cost: O(N log N).
+///
+/// Flow accumulation walks the drainage tree from the sources down in topological rounds: a cell is
+/// computed, in parallel with the rest of its round, once all its upstream cells are, by summing them
+/// in a fixed order. The result is deterministic.
+/// </summary>
+class GALAXY_API FPlanetHydrology
+{
+public:
+	/// <summary>
+	/// Registry layers UPlanetData::ComputeHydrology writes (Int32, Float and Int32)
+	/// </summary>
+	static const FName DownstreamLayerName;
+	static const FName AccumulationLayerName;
+	static const FName LakeLayerName;
+
+	/// <summary>
+	/// Compute drainage, accumulation and lakes
+	/// </summary>
+	/// <param name="grid">Grid the elevations belong to</param>
+	/// <param name="elevations">Elevation of every cell</param>
+	/// <param name="waterLevel">Cells at or below this elevation are underwater</param>
+	/// <param name="outResult">Drainage of every cell</param>
+	/// <returns>False if the elevations do not match the grid</returns>
+	static bool Compute(const UHexGridAsset& grid, TConstArrayView<float> elevations, float waterLevel, FPlanetHydrologyResult& outResult);
+
+	/// <summary>
+	/// Accumulate per-cell values down a drainage tree, in parallel
+	/// </summary>
+	/// <param name="downstreamCellIds">Drainage tree, must not contain cycles</param>
+	/// <param name="cellValues">Value contributed by every cell</param>
+	/// <param name="outAccumulation">Sum of the values of every cell and of all the cells upstream of it</param>
+	static void Accumulate(TConstArrayView<int32> downstreamCellIds, TConstArrayView<float> cellValues, TArray<float>& outAccumulation);
+};
@@ -0,0 +1,254 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetLayerRegistry.h"
+
+void FPlanetLayerRegistry::SetCellCount(int32 inCellCount)
+{
+	CellCount = FMath::Max(0, inCellCount);
+
+	// New buffers rather than resizing, snapshots may still reference the old ones
+	for (FLayer& layer : Layers)
+	{
+		if (!layer.Name.IsNone())
+		{
+			layer.Front = MakeBuffer(layer.Type);
+			if (layer.Back.IsValid())
+			{
+				layer.Back = MakeBuffer(layer.Type);
+			}
+		}
+	}
+}
+
+FPlanetLayerHandle FPlanetLayerRegistry::RegisterLayer(FName name, EPlanetLayerType type, bool bDoubleBuffered)
+{
+	if (name.IsNone())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetLayerRegistry::RegisterLayer - Layers need a name."));
+		return FPlanetLayerHandle();
+	}
+
+	if (const int32* existingIndex = LayerIndices.Find(name))
+	{
+		const FLayer& existing = Layers[*existingIndex];
+		if (existing.Type != type || existing.Back.IsValid() != bDoubleBuffered)
+		{
+			UE_LOG(LogTemp, Error, TEXT("FPlanetLayerRegistry::RegisterLayer - Layer %s is already registered with another type or buffering."), *name.ToString());
+			return FPlanetLayerHandle();
+		}
+		return MakeHandle(*existingIndex);
+	}
+
+	int32 index = Layers.IndexOfByPredicate([](const FLayer& layer) { return layer.Name.IsNone(); });
+	if (index == INDEX_NONE)
+	{
+		index = Layers.AddDefaulted();
+	}
+
+	FLayer& layer = Layers[index];
+	layer.Name = name;
+	layer.Generation = NextGeneration++;
+	layer.Type = type;
+	layer.Front = MakeBuffer(type);
+	layer.Back = bDoubleBuffered ? MakeBuffer(type) : nullptr;
+	LayerIndices.Add(name, index);
+
+	return MakeHandle(index);
+}
+
+bool FPlanetLayerRegistry::UnregisterLayer(FName name)
+{
+	int32 index;
+	if (!LayerIndices.RemoveAndCopyValue(name, index))
+	{
+		return false;
+	}
+
+	Layers[index].Name = NAME_None;
+	Layers[index].Front.Reset();
+	Layers[index].Back.Reset();
+	return true;
+}
+
+FPlanetLayerHandle FPlanetLayerRegistry::FindLayer(FName name) const
+{
+	const int32* index = LayerIndices.Find(name);
+	return index ? MakeHandle(*index) : FPlanetLayerHandle();
+}
+
+bool FPlanetLayerRegistry::IsValidLayer(FPlanetLayerHandle handle) const
+{
+	return Layers.IsValidIndex(handle.Index) && !Layers[handle.Index].Name.IsNone() && Layers[handle.Index].Generation == handle.Generation;
+}
+
+EPlanetLayerType FPlanetLayerRegistry::GetLayerType(FPlanetLayerHandle handle) const
+{
+	check(IsValidLayer(handle));
+	return Layers[handle.Index].Type;
+}
+
+FName FPlanetLayerRegistry::GetLayerName(FPlanetLayerHandle handle) const
+{
+	return IsValidLayer(handle) ? Layers[handle.Index].Name : NAME_None;
+}
+
+bool FPlanetLayerRegistry::IsDoubleBuffered(FPlanetLayerHandle handle) const
+{
+	return IsValidLayer(handle) && Layers[handle.Index].Back.IsValid();
+}
+
+void FPlanetLayerRegistry::GetLayerNames(TArray<FName>& outNames) const
+{
+	LayerIndices.GenerateKeyArray(outNames);
+}
+
+void FPlanetLayerRegistry::ClearLayer(FPlanetLayerHandle handle)
+{
+	if (!IsValidLayer(handle))
+	{
+		return;
+	}
+
+	// Snapshots keep the values they were taken with
+	FLayer& layer = Layers[handle.Index];
+	layer.Front = MakeBuffer(layer.Type);
+
+	// Clear the back buffer too, or the next swap would bring the old values back
+	if (layer.Back.IsValid())
+	{
+		layer.Back = MakeBuffer(layer.Type);
+	}
+}
+
+void FPlanetLayerRegistry::Reset()
+{
+	Layers.Empty();
+	LayerIndices.Empty();
+}
+
+void FPlanetLayerRegistry::SwapBuffers(FPlanetLayerHandle handle)
+{
+	if (!CheckDoubleBuffered(handle))
+	{
+		return;
+	}
+
+	FLayer& layer = Layers[handle.Index];
+	Swap(layer.Front, layer.Back);
+
+	// The old front is still read by a snapshot, leave it to them and write the next step elsewhere
+	if (!layer.Back.IsUnique())
+	{
+		layer.Back = MakeBuffer(layer.Type);
+	}
+}
+
+void FPlanetLayerRegistry::SwapAllBuffers()
+{
+	for (int32 index = 0; index < Layers.Num(); ++index)
+	{
+		if (!Layers[index].Name.IsNone() && Layers[index].Back.IsValid())
+		{
+			SwapBuffers(MakeHandle(index));
+		}
+	}
+}
+
+void FPlanetLayerRegistry::CopyFrontToBack(FPlanetLayerHandle handle)
+{
+	if (CheckDoubleBuffered(handle))
+	{
+		FLayer& layer = Layers[handle.Index];
+		FMemory::Memcpy(layer.Back->Bytes.GetData(), layer.Front->Bytes.GetData(), layer.Front->Bytes.Num());
+	}
+}
+
+FPlanetLayerSnapshot FPlanetLayerRegistry::GetSnapshot(FPlanetLayerHandle handle) const
+{
+	if (!IsValidLayer(handle))
+	{
+		return FPlanetLayerSnapshot();
+	}
+
+	const FLayer& layer = Layers[handle.Index];
+	return FPlanetLayerSnapshot(layer.Front, layer.Type, CellCount);
+}
+
+TArrayView<uint8> FPlanetLayerRegistry::GetRawData(FPlanetLayerHandle handle)
+{
+	return IsValidLayer(handle) ? TArrayView<uint8>(Layers[handle.Index].Front->Bytes) : TArrayView<uint8>();
+}
+
+TConstArrayView<uint8> FPlanetLayerRegistry::GetRawData(FPlanetLayerHandle handle) const
+{
+	return IsValidLayer(handle) ? TConstArrayView<uint8>(Layers[handle.Index].Front->Bytes) : TConstArrayView<uint8>();
+}
+
+FPlanetLayerBitView FPlanetLayerRegistry::GetBitView(FPlanetLayerHandle handle)
+{
+	if (!CheckType(handle, EPlanetLayerType::Bitset))
+	{
+		return FPlanetLayerBitView();
+	}
+	return FPlanetLayerBitView(reinterpret_cast<uint32*>(Layers[handle.Index].Front->Bytes.GetData()), CellCount);
+}
+
+FPlanetLayerConstBitView FPlanetLayerRegistry::GetBitView(FPlanetLayerHandle handle) const
+{
+	if (!CheckType(handle, EPlanetLayerType::Bitset))
+	{
+		return FPlanetLayerConstBitView();
+	}
+	return FPlanetLayerConstBitView(reinterpret_cast<const uint32*>(Layers[handle.Index].Front->Bytes.GetData()), CellCount);
+}
+
+FPlanetLayerBitView FPlanetLayerRegistry::GetBackBitView(FPlanetLayerHandle handle)
+{
+	if (!CheckType(handle, EPlanetLayerType::Bitset) || !CheckDoubleBuffered(handle))
+	{
+		return FPlanetLayerBitView();
+	}
+	return FPlanetLayerBitView(reinterpret_cast<uint32*>(Layers[handle.Index].Back->Bytes.GetData()), CellCount);
+}
+
+int32 FPlanetLayerRegistry::GetLayerByteSize(EPlanetLayerType type, int32 cellCount)
+{
+	switch (type)
+	{
+	case EPlanetLayerType::Int8:	return cellCount;
+	case EPlanetLayerType::Int16:	return cellCount * 2;
+	case EPlanetLayerType::Int32:	return cellCount * 4;
+	case EPlanetLayerType::Float:	return cellCount * 4;
+	case EPlanetLayerType::Half:	return cellCount * 2;
+	case EPlanetLayerType::Bitset:	return FMath::DivideAndRoundUp(cellCount, 32) * 4;
+	default:						return 0;
+	}
+}
+
+bool FPlanetLayerRegistry::CheckType(FPlanetLayerHandle handle, EPlanetLayerType type) const
+{
+	if (!IsValidLayer(handle))
+	{
+		return false;
+	}
+
+	return ensureMsgf(Layers[handle.Index].Type == type, TEXT("FPlanetLayerRegistry - Layer %s accessed with the wrong type."), *Layers[handle.Index].Name.ToString());
+}
+
+bool FPlanetLayerRegistry::CheckDoubleBuffered(FPlanetLayerHandle handle) const
+{
+	if (!IsValidLayer(handle))
+	{
+		return false;
+	}
+
+	return ensureMsgf(Layers[handle.Index].Back.IsValid(), TEXT("FPlanetLayerRegistry - Layer %s is not double buffered."), *Layers[handle.Index].Name.ToString());
+}
+
+FPlanetLayerRegistry::FBufferPtr FPlanetLayerRegistry::MakeBuffer(EPlanetLayerType type) const
+{
+	FBufferPtr buffer = MakeShared<FPlanetLayerBuffer, ESPMode::ThreadSafe>();
+	buffer->Bytes.SetNumZeroed(GetLayerByteSize(type, CellCount));
+	return buffer;
+}
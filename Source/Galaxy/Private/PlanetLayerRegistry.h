@@ -0,0 +1,279 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Float16.h"
+
+/// <summary>
+/// Element type of a registered planet layer
+/// </summary>
+enum class EPlanetLayerType : uint8
+{
+	Int8,
+	Int16,
+	Int32,
+	Float,
+	Half,
+	Bitset,
+};
+
+/// <summary>
+/// Maps a C++ element type to its layer type, used to check typed views
+/// </summary>
+template<typename T> struct TPlanetLayerElement;
+template<> struct TPlanetLayerElement<int8>		{ static constexpr EPlanetLayerType Type = EPlanetLayerType::Int8; };
+template<> struct TPlanetLayerElement<int16>	{ static constexpr EPlanetLayerType Type = EPlanetLayerType::Int16; };
+template<> struct TPlanetLayerElement<int32>	{ static constexpr EPlanetLayerType Type = EPlanetLayerType::Int32; };
+template<> struct TPlanetLayerElement<float>	{ static constexpr EPlanetLayerType Type = EPlanetLayerType::Float; };
+template<> struct TPlanetLayerElement<FFloat16>	{ static constexpr EPlanetLayerType Type = EPlanetLayerType::Half; };
+
+/// <summary>
+/// Index of a registered layer, stays valid until the layer is unregistered.
+/// The generation tells a stale handle from the layer registered later in the same slot.
+/// </summary>
+struct FPlanetLayerHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	bool operator==(const FPlanetLayerHandle& other) const { return Index == other.Index && Generation == other.Generation; }
+};
+
+/// <summary>
+/// View over a bitset layer, one bit per cell packed in 32-bit words.
+/// Writes are not atomic: two threads must not write cells sharing the same word.
+/// </summary>
+template<typename WordType>
+class TPlanetLayerBitView
+{
+public:
+	TPlanetLayerBitView() = default;
+	TPlanetLayerBitView(WordType* inWords, int32 inNum) : Words(inWords), NumBits(inNum) {}
+
+	int32 Num() const { return NumBits; }
+	int32 NumWords() const { return FMath::DivideAndRoundUp(NumBits, 32); }
+	WordType* GetWords() const { return Words; }
+
+	bool Get(int32 index) const { return (Words[index >> 5] >> (index & 31)) & 1u; }
+	bool operator[](int32 index) const { return Get(index); }
+
+	void Set(int32 index, bool bValue) const
+	{
+		const uint32 mask = 1u << (index & 31);
+		Words[index >> 5] = bValue ? (Words[index >> 5] | mask) : (Words[index >> 5] & ~mask);
+	}
+
+private:
+	WordType* Words = nullptr;
+	int32 NumBits = 0;
+};
+
+using FPlanetLayerBitView = TPlanetLayerBitView<uint32>;
+using FPlanetLayerConstBitView = TPlanetLayerBitView<const uint32>;
+
+/// <summary>
+/// Storage of one layer buffer, shared with the snapshots still reading it
+/// </summary>
+struct FPlanetLayerBuffer
+{
+	/** Cache line alignment */
+	static constexpr uint32 Alignment = 64;
+
+	TArray<uint8, TAlignedHeapAllocator<Alignment>> Bytes;
+};
+
+/// <summary>
+/// Read-only reference to the front buffer of a layer at the time it was taken.
+/// For double buffered layers the data never changes while the snapshot is alive: swapping gives the
+/// layer a new back buffer instead of reusing the one the snapshot reads. Safe to read from any thread.
+/// </summary>
+class GALAXY_API FPlanetLayerSnapshot
+{
+public:
+	FPlanetLayerSnapshot() = default;
+	FPlanetLayerSnapshot(TSharedPtr<const FPlanetLayerBuffer, ESPMode::ThreadSafe> inBuffer, EPlanetLayerType inType, int32 inCellCount)
+		: Buffer(MoveTemp(inBuffer)), Type(inType), CellCount(inCellCount) {}
+
+	bool IsValid() const { return Buffer.IsValid(); }
+	EPlanetLayerType GetType() const { return Type; }
+	int32 Num() const { return CellCount; }
+
+	template<typename T>
+	TConstArrayView<T> GetView() const
+	{
+		if (!IsValid() || !ensure(Type == TPlanetLayerElement<T>::Type))
+		{
+			return TConstArrayView<T>();
+		}
+		return TConstArrayView<T>(reinterpret_cast<const T*>(Buffer->Bytes.GetData()), CellCount);
+	}
+
+	FPlanetLayerConstBitView GetBitView() const
+	{
+		if (!IsValid() || !ensure(Type == EPlanetLayerType::Bitset))
+		{
+			return FPlanetLayerConstBitView();
+		}
+		return FPlanetLayerConstBitView(reinterpret_cast<const uint32*>(Buffer->Bytes.GetData()), CellCount);
+	}
+
+private:
+	TSharedPtr<const FPlanetLayerBuffer, ESPMode::ThreadSafe> Buffer;
+	EPlanetLayerType Type = EPlanetLayerType::Float;
+	int32 CellCount = 0;
+};
+
+/// <summary>
+/// Named per-cell data layers registered at runtime by simulation systems.
+///
+/// Every layer is a contiguous, cache line aligned array of CellCount elements (structure of arrays),
+/// accessed through typed views. Layers are transient: they are not saved with the planet.
+/// Register and unregister from the game thread, views can be used from any thread.
+///
+/// Double buffered layers have a front buffer (state of the last completed step, what GetView returns)
+/// and a back buffer written by the step in progress (GetBackView). A simulation step reads the front,
+/// writes every cell of the back from a ParallelFor, then calls SwapBuffers on the game thread.
+/// Other threads read snapshots taken on the game thread, which stay valid and unchanged after swaps.
+/// </summary>
+class GALAXY_API FPlanetLayerRegistry
+{
+public:
+	static constexpr uint32 Alignment = FPlanetLayerBuffer::Alignment;
+
+	/// <summary>
+	/// Resize every layer, values are reset to zero
+	/// </summary>
+	void SetCellCount(int32 inCellCount);
+	int32 GetCellCount() const { return CellCount; }
+
+	/// <summary>
+	/// Register a layer, or return the existing one if a layer with that name and type exists
+	/// </summary>
+	/// <param name="name">Unique layer name</param>
+	/// <param name="type">Element type</param>
+	/// <param name="bDoubleBuffered">Give the layer a back buffer for parallel simulation steps</param>
+	/// <returns>Invalid handle if the name is already used by a layer of another type or buffering</returns>
+	FPlanetLayerHandle RegisterLayer(FName name, EPlanetLayerType type, bool bDoubleBuffered = false);
+
+	bool UnregisterLayer(FName name);
+	FPlanetLayerHandle FindLayer(FName name) const;
+	bool IsValidLayer(FPlanetLayerHandle handle) const;
+	EPlanetLayerType GetLayerType(FPlanetLayerHandle handle) const;
+	FName GetLayerName(FPlanetLayerHandle handle) const;
+	bool IsDoubleBuffered(FPlanetLayerHandle handle) const;
+
+	/// <summary>
+	/// Names of every registered layer
+	/// </summary>
+	void GetLayerNames(TArray<FName>& outNames) const;
+
+	/// <summary>
+	/// Reset every value of a layer to zero, in both buffers of a double buffered layer
+	/// </summary>
+	void ClearLayer(FPlanetLayerHandle handle);
+
+	/// <summary>
+	/// Remove every layer
+	/// </summary>
+	void Reset();
+
+	/// <summary>
+	/// Make the back buffer the new front buffer, game thread only.
+	/// The back buffer content is undefined afterwards unless CopyFrontToBack is called.
+	/// </summary>
+	void SwapBuffers(FPlanetLayerHandle handle);
+
+	/// <summary>
+	/// Swap every double buffered layer
+	/// </summary>
+	void SwapAllBuffers();
+
+	/// <summary>
+	/// Start the back buffer from the front values, for steps that only write some cells
+	/// </summary>
+	void CopyFrontToBack(FPlanetLayerHandle handle);
+
+	/// <summary>
+	/// Reference the current front buffer, take it on the game thread and hand it to other threads
+	/// </summary>
+	FPlanetLayerSnapshot GetSnapshot(FPlanetLayerHandle handle) const;
+
+	/// <summary>
+	/// Raw bytes of the front buffer of a layer, for serialization and copies
+	/// </summary>
+	TArrayView<uint8> GetRawData(FPlanetLayerHandle handle);
+	TConstArrayView<uint8> GetRawData(FPlanetLayerHandle handle) const;
+
+	/// <summary>
+	/// Front buffer: current values
+	/// </summary>
+	template<typename T>
+	TArrayView<T> GetView(FPlanetLayerHandle handle)
+	{
+		if (!CheckType(handle, TPlanetLayerElement<T>::Type))
+		{
+			return TArrayView<T>();
+		}
+		return TArrayView<T>(reinterpret_cast<T*>(Layers[handle.Index].Front->Bytes.GetData()), CellCount);
+	}
+
+	template<typename T>
+	TConstArrayView<T> GetView(FPlanetLayerHandle handle) const
+	{
+		if (!CheckType(handle, TPlanetLayerElement<T>::Type))
+		{
+			return TConstArrayView<T>();
+		}
+		return TConstArrayView<T>(reinterpret_cast<const T*>(Layers[handle.Index].Front->Bytes.GetData()), CellCount);
+	}
+
+	/// <summary>
+	/// Back buffer of a double buffered layer: values being computed by the current step
+	/// </summary>
+	template<typename T>
+	TArrayView<T> GetBackView(FPlanetLayerHandle handle)
+	{
+		if (!CheckType(handle, TPlanetLayerElement<T>::Type) || !CheckDoubleBuffered(handle))
+		{
+			return TArrayView<T>();
+		}
+		return TArrayView<T>(reinterpret_cast<T*>(Layers[handle.Index].Back->Bytes.GetData()), CellCount);
+	}
+
+	FPlanetLayerBitView GetBitView(FPlanetLayerHandle handle);
+	FPlanetLayerConstBitView GetBitView(FPlanetLayerHandle handle) const;
+	FPlanetLayerBitView GetBackBitView(FPlanetLayerHandle handle);
+
+	/// <summary>
+	/// Size in bytes of the storage of a layer of this type
+	/// </summary>
+	static int32 GetLayerByteSize(EPlanetLayerType type, int32 cellCount);
+
+private:
+	using FBufferPtr = TSharedPtr<FPlanetLayerBuffer, ESPMode::ThreadSafe>;
+
+	struct FLayer
+	{
+		FName Name;
+		uint32 Generation = 0;
+		EPlanetLayerType Type = EPlanetLayerType::Float;
+		FBufferPtr Front;
+		FBufferPtr Back;
+	};
+
+	FPlanetLayerHandle MakeHandle(int32 index) const { return FPlanetLayerHandle{ index, Layers[index].Generation }; }
+	bool CheckType(FPlanetLayerHandle handle, EPlanetLayerType type) const;
+	bool CheckDoubleBuffered(FPlanetLayerHandle handle) const;
+	FBufferPtr MakeBuffer(EPlanetLayerType type) const;
+
+	/** Unregistered layers leave an empty slot (NAME_None) so other handles stay valid */
+	TArray<FLayer> Layers;
+	TMap<FName, int32> LayerIndices;
+	int32 CellCount = 0;
+
+	/** Never reset, so handles taken before Reset are not valid for the new layers either */
+	uint32 NextGeneration = 1;
+};
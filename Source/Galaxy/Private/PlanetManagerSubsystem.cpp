@@ -0,0 +1,641 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetManagerSubsystem.h"
+#include "PlanetData.h"
+#include "PlanetReplication.h"
+#include "HexGridAsset.h"
+#include "Algo/AllOf.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+
+void UPlanetManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Sessions that crashed never deleted their files, running sessions (server and client on one machine) keep theirs
+	IFileManager& fileManager = IFileManager::Get();
+	const FString hibernateRoot = FPaths::GetPath(GetHibernateDirectory());
+	TArray<FString> entries;
+	fileManager.FindFiles(entries, *FPaths::Combine(hibernateRoot, TEXT("*")), true, true);
+	for (const FString& entry : entries)
+	{
+		const FString path = FPaths::Combine(hibernateRoot, entry);
+		if (!fileManager.DirectoryExists(*path))
+		{
+			fileManager.Delete(*path, false, false, true);
+			continue;
+		}
+
+		const uint32 processId = entry.IsNumeric() ? static_cast<uint32>(FCString::Strtoui64(*entry, nullptr, 10)) : 0;
+		if (processId != FPlatformProcess::GetCurrentProcessId() && (processId == 0 || !FPlatformProcess::IsApplicationRunning(processId)))
+		{
+			fileManager.DeleteDirectory(*path, false, true);
+		}
+	}
+}
+
+void UPlanetManagerSubsystem::Deinitialize()
+{
+	for (TPair<TObjectKey<UPlanetData>, FManagedPlanet>& pair : Planets)
+	{
+		// Workers only hold copies, let them finish before the files go away
+		if (pair.Value.HibernateTask.IsValid())
+		{
+			pair.Value.HibernateTask.Wait();
+			pair.Value.FilePath = pair.Value.HibernateTask.Get().FilePath;
+		}
+		if (pair.Value.WakeTask.IsValid())
+		{
+			pair.Value.WakeTask.Wait();
+		}
+		DeleteHibernateFile(pair.Value);
+	}
+
+	Planets.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UPlanetManagerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPlanetManagerSubsystem, STATGROUP_Tickables);
+}
+
+void UPlanetManagerSubsystem::RegisterPlanet(UPlanetData* Planet)
+{
+	if (!Planet || Planets.Contains(Planet))
+	{
+		return;
+	}
+
+	FManagedPlanet managed;
+	managed.Planet = Planet;
+	Planets.Add(Planet, MoveTemp(managed));
+}
+
+void UPlanetManagerSubsystem::UnregisterPlanet(UPlanetData* Planet)
+{
+	FManagedPlanet* managed = Planets.Find(Planet);
+	if (!managed)
+	{
+		return;
+	}
+
+	// A planet leaving the world while hibernated does not get its layers back
+	if (managed->HibernateTask.IsValid())
+	{
+		managed->HibernateTask.Wait();
+		managed->FilePath = managed->HibernateTask.Get().FilePath;
+	}
+	DeleteHibernateFile(*managed);
+
+	Planets.Remove(Planet);
+}
+
+bool UPlanetManagerSubsystem::RequestActive(UPlanetData* Planet)
+{
+	FManagedPlanet* managed = Planets.Find(Planet);
+	if (!managed)
+	{
+		return false;
+	}
+
+	managed->OutOfRangeTime = 0.0f;
+	switch (managed->Residency)
+	{
+	case EPlanetResidency::Hibernating:	managed->bWakeRequested = true; return true;
+	case EPlanetResidency::Hibernated:	return StartWake(*managed);
+	default:							return true;
+	}
+}
+
+bool UPlanetManagerSubsystem::WakePlanetNow(UPlanetData* Planet)
+{
+	FManagedPlanet* managed = Planets.Find(Planet);
+	if (!managed)
+	{
+		return Planet != nullptr;
+	}
+
+	managed->OutOfRangeTime = 0.0f;
+
+	if (managed->Residency == EPlanetResidency::Hibernating)
+	{
+		managed->HibernateTask.Wait();
+		CompleteHibernate(*managed);
+	}
+
+	if (managed->Residency == EPlanetResidency::Hibernated)
+	{
+		StartWake(*managed);
+	}
+
+	if (managed->Residency == EPlanetResidency::Waking)
+	{
+		managed->WakeTask.Wait();
+		CompleteWake(*managed);
+	}
+
+	return managed->Residency == EPlanetResidency::Active;
+}
+
+bool UPlanetManagerSubsystem::HibernatePlanet(UPlanetData* Planet)
+{
+	FManagedPlanet* managed = Planets.Find(Planet);
+	return managed && CanHibernate(*managed) && StartHibernate(*managed);
+}
+
+void UPlanetManagerSubsystem::DiscardHibernatedLayers(UPlanetData* Planet)
+{
+	FManagedPlanet* managed = Planets.Find(Planet);
+	if (!managed || managed->Residency == EPlanetResidency::Active || Planet == RestoringPlanet)
+	{
+		return;
+	}
+
+	// The background work is dropped, only its file needs to go
+	if (managed->HibernateTask.IsValid())
+	{
+		managed->HibernateTask.Wait();
+		managed->FilePath = managed->HibernateTask.Consume().FilePath;
+	}
+	if (managed->WakeTask.IsValid())
+	{
+		managed->WakeTask.Wait();
+		managed->WakeTask.Consume();
+	}
+
+	DeleteHibernateFile(*managed);
+	managed->Hibernated = FPlanetSaveContent();
+	managed->RegistryLayers.Empty();
+	managed->HibernatedBytes = 0;
+	managed->GridRuntime.Reset();
+	managed->bWakeRequested = false;
+	managed->OutOfRangeTime = 0.0f;
+	SetResidency(*managed, EPlanetResidency::Active);
+}
+
+void UPlanetManagerSubsystem::SetPlanetPinned(UPlanetData* Planet, bool bPinned)
+{
+	if (FManagedPlanet* managed = Planets.Find(Planet))
+	{
+		managed->bPinned = bPinned;
+		if (bPinned)
+		{
+			RequestActive(Planet);
+		}
+	}
+}
+
+EPlanetResidency UPlanetManagerSubsystem::GetResidency(const UPlanetData* Planet) const
+{
+	const FManagedPlanet* managed = Planets.Find(Planet);
+	return managed ? managed->Residency : EPlanetResidency::Active;
+}
+
+int64 UPlanetManagerSubsystem::GetHibernatedMemoryBytes() const
+{
+	int64 bytes = 0;
+	for (const TPair<TObjectKey<UPlanetData>, FManagedPlanet>& pair : Planets)
+	{
+		bytes += pair.Value.HibernatedBytes;
+	}
+	return bytes;
+}
+
+int32 UPlanetManagerSubsystem::GetActivePlanetCount() const
+{
+	int32 count = 0;
+	for (const TPair<TObjectKey<UPlanetData>, FManagedPlanet>& pair : Planets)
+	{
+		count += pair.Value.Residency == EPlanetResidency::Active ? 1 : 0;
+	}
+	return count;
+}
+
+FString UPlanetManagerSubsystem::GetHibernateDirectory()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Planets"), TEXT("Hibernated"),
+		FString::Printf(TEXT("%u"), FPlatformProcess::GetCurrentProcessId()));
+}
+
+FString UPlanetManagerSubsystem::GetHibernatePath(const UPlanetData& planet) const
+{
+	const FString ownerName = planet.GetOwner() ? planet.GetOwner()->GetName() : planet.GetName();
+	return FPaths::Combine(GetHibernateDirectory(), FString::Printf(TEXT("%s_%u.planet"), *ownerName, planet.GetUniqueID()));
+}
+
+bool UPlanetManagerSubsystem::CanHibernate(const FManagedPlanet& managed) const
+{
+	const UPlanetData* planet = managed.Planet.Get();
+	if (!planet || managed.Residency != EPlanetResidency::Active || !planet->AreDataLayersInitialized())
+	{
+		return false;
+	}
+
+	// Client layers come from the server, a snapshot restored later would overwrite newer replicated values
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		return false;
+	}
+
+	// Replication reads the layers every tick to send them
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* playerController = It->Get();
+		const UPlanetReplicationComponent* replication = playerController ? playerController->FindComponentByClass<UPlanetReplicationComponent>() : nullptr;
+		if (replication && replication->Planet == planet)
+		{
+			return false;
+		}
+	}
+
+	// The save component reads and writes the layers in the background
+	const UPlanetSaveComponent* saveComponent = planet->GetOwner() ? planet->GetOwner()->FindComponentByClass<UPlanetSaveComponent>() : nullptr;
+	return !saveComponent || (!saveComponent->IsSaving() && !saveComponent->IsLoading());
+}
+
+bool UPlanetManagerSubsystem::StartHibernate(FManagedPlanet& managed)
+{
+	UPlanetData* planet = managed.Planet.Get();
+	check(planet);
+
+	// Pending edits are part of the hibernated state
+	planet->FlushChanges();
+
+	managed.GridRuntime = planet->Grid->GetRuntime();
+	const TArray<TArray<int32>>& faceCells = managed.GridRuntime->GetFaceCells();
+
+	FHibernateResult gathered;
+	gathered.Content.CellCount = planet->GetCellCount();
+	gathered.Content.Metadata.Capture(*planet);
+	gathered.Words.SetNum(FPlanetSaveFormat::ChunkCount);
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		for (int32 faceIndex = 0; faceIndex < FPlanetSaveFormat::FaceCount; ++faceIndex)
+		{
+			const EPlanetDataLayer layer = static_cast<EPlanetDataLayer>(layerIdx);
+			FPlanetSaveFormat::GatherChunk(*planet, layer, faceCells[faceIndex],
+				gathered.Words[FPlanetSaveFormat::GetChunkIndex(layer, faceIndex)]);
+		}
+	}
+
+	// Registry layers stay registered while the planet hibernates, only their values are kept
+	const FPlanetLayerRegistry& registry = planet->GetLayerRegistry();
+	TArray<FName> layerNames;
+	registry.GetLayerNames(layerNames);
+	for (FName layerName : layerNames)
+	{
+		const TConstArrayView<uint8> bytes = registry.GetRawData(registry.FindLayer(layerName));
+		FRegistryLayer& registryLayer = gathered.RegistryLayers.AddDefaulted_GetRef();
+		registryLayer.Name = layerName;
+		registryLayer.ByteCount = bytes.Num();
+		registryLayer.Words.SetNumZeroed(FMath::DivideAndRoundUp(bytes.Num(), static_cast<int32>(sizeof(uint32))));
+		FMemory::Memcpy(registryLayer.Words.GetData(), bytes.GetData(), bytes.Num());
+	}
+
+	planet->ClearDataLayers();
+	SetResidency(managed, EPlanetResidency::Hibernating);
+
+	managed.HibernateTask = Async(EAsyncExecution::ThreadPool,
+		[gathered = MoveTemp(gathered), path = bHibernateToDisk ? GetHibernatePath(*planet) : FString()]() mutable
+		{
+			FHibernateResult result = MoveTemp(gathered);
+			result.Content.Chunks.SetNum(FPlanetSaveFormat::ChunkCount);
+
+			ParallelFor(FPlanetSaveFormat::ChunkCount, [&](int32 chunkIndex)
+				{
+					result.Content.Chunks[chunkIndex] = FPlanetSaveFormat::CompressChunk(result.Words[chunkIndex]);
+				});
+			ParallelFor(result.RegistryLayers.Num(), [&](int32 layerIndex)
+				{
+					FRegistryLayer& registryLayer = result.RegistryLayers[layerIndex];
+					registryLayer.Chunk = FPlanetSaveFormat::CompressChunk(registryLayer.Words);
+				});
+
+			const bool bRegistryCompressed = Algo::AllOf(result.RegistryLayers, [](const FRegistryLayer& registryLayer) { return registryLayer.Chunk.IsValid(); });
+			for (const FPlanetSaveBlob& chunk : result.Content.Chunks)
+			{
+				if (!chunk || !bRegistryCompressed)
+				{
+					UE_LOG(LogTemp, Error, TEXT("UPlanetManagerSubsystem - A chunk could not be compressed, the planet stays resident."));
+					result.Content.Chunks.Empty();
+					return result;
+				}
+			}
+
+			result.Words.Empty();
+			for (FRegistryLayer& registryLayer : result.RegistryLayers)
+			{
+				registryLayer.Words.Empty();
+			}
+			result.bSuccess = true;
+
+			if (!path.IsEmpty())
+			{
+				if (FPlanetSaveFormat::WriteFile(path, result.Content))
+				{
+					result.FilePath = path;
+					result.Content.Chunks.Empty();
+				}
+				else
+				{
+					UE_LOG(LogTemp, Warning, TEXT("UPlanetManagerSubsystem - Could not write %s, the planet is kept in memory."), *path);
+				}
+			}
+
+			return result;
+		});
+
+	return true;
+}
+
+void UPlanetManagerSubsystem::CompleteHibernate(FManagedPlanet& managed)
+{
+	FHibernateResult result = managed.HibernateTask.Consume();
+	UPlanetData* planet = managed.Planet.Get();
+
+	if (!result.bSuccess)
+	{
+		if (planet && managed.GridRuntime.IsValid())
+		{
+			RestoreLayers(*planet, result.Content.Metadata, *managed.GridRuntime, result.Words, result.RegistryLayers);
+		}
+		managed.bWakeRequested = false;
+		managed.OutOfRangeTime = 0.0f;
+		SetResidency(managed, EPlanetResidency::Active);
+		return;
+	}
+
+	managed.FilePath = MoveTemp(result.FilePath);
+	managed.Hibernated = MoveTemp(result.Content);
+	managed.RegistryLayers = MoveTemp(result.RegistryLayers);
+	managed.HibernatedBytes = 0;
+	for (const FPlanetSaveBlob& chunk : managed.Hibernated.Chunks)
+	{
+		managed.HibernatedBytes += chunk ? chunk->Num() : 0;
+	}
+	for (const FRegistryLayer& registryLayer : managed.RegistryLayers)
+	{
+		managed.HibernatedBytes += registryLayer.Chunk->Num();
+	}
+
+	SetResidency(managed, EPlanetResidency::Hibernated);
+
+	if (managed.bWakeRequested)
+	{
+		managed.bWakeRequested = false;
+		StartWake(managed);
+	}
+}
+
+bool UPlanetManagerSubsystem::StartWake(FManagedPlanet& managed)
+{
+	if (managed.Residency != EPlanetResidency::Hibernated || !managed.GridRuntime.IsValid())
+	{
+		return false;
+	}
+
+	SetResidency(managed, EPlanetResidency::Waking);
+
+	managed.WakeTask = Async(EAsyncExecution::ThreadPool,
+		[content = managed.Hibernated, registryLayers = managed.RegistryLayers, path = managed.FilePath, gridRuntime = managed.GridRuntime]() mutable
+		{
+			FWakeResult result;
+			result.RegistryLayers = MoveTemp(registryLayers);
+
+			if (!path.IsEmpty() && !FPlanetSaveFormat::ReadFile(path, content))
+			{
+				UE_LOG(LogTemp, Error, TEXT("UPlanetManagerSubsystem - Could not read %s."), *path);
+				return result;
+			}
+
+			result.Metadata = MoveTemp(content.Metadata);
+			result.CellCount = content.CellCount;
+			result.Words.SetNum(FPlanetSaveFormat::ChunkCount);
+
+			std::atomic<bool> bFailed(false);
+			ParallelFor(FPlanetSaveFormat::ChunkCount, [&](int32 chunkIndex)
+				{
+					const int32 wordCount = gridRuntime->GetFaceCells()[chunkIndex % FPlanetSaveFormat::FaceCount].Num();
+					const FPlanetSaveBlob& chunk = content.Chunks.IsValidIndex(chunkIndex) ? content.Chunks[chunkIndex] : FPlanetSaveBlob();
+					if (!chunk || !FPlanetSaveFormat::DecompressChunk(*chunk, wordCount, result.Words[chunkIndex]))
+					{
+						bFailed = true;
+					}
+				});
+			ParallelFor(result.RegistryLayers.Num(), [&](int32 layerIndex)
+				{
+					FRegistryLayer& registryLayer = result.RegistryLayers[layerIndex];
+					const int32 wordCount = FMath::DivideAndRoundUp(registryLayer.ByteCount, static_cast<int32>(sizeof(uint32)));
+					if (!FPlanetSaveFormat::DecompressChunk(*registryLayer.Chunk, wordCount, registryLayer.Words))
+					{
+						bFailed = true;
+					}
+				});
+
+			result.bSuccess = !bFailed;
+			return result;
+		});
+
+	return true;
+}
+
+void UPlanetManagerSubsystem::CompleteWake(FManagedPlanet& managed)
+{
+	FWakeResult result = managed.WakeTask.Consume();
+	UPlanetData* planet = managed.Planet.Get();
+
+	if (!result.bSuccess || !planet || !planet->Grid || planet->Grid->Cells.Num() != result.CellCount)
+	{
+		// The compressed state is still there, try again on the next request
+		UE_LOG(LogTemp, Error, TEXT("UPlanetManagerSubsystem::CompleteWake - Could not restore %s."), planet ? *planet->GetName() : TEXT("a planet"));
+		SetResidency(managed, EPlanetResidency::Hibernated);
+		return;
+	}
+
+	RestoreLayers(*planet, result.Metadata, *managed.GridRuntime, result.Words, result.RegistryLayers);
+
+	DeleteHibernateFile(managed);
+	managed.Hibernated = FPlanetSaveContent();
+	managed.RegistryLayers.Empty();
+	managed.HibernatedBytes = 0;
+	managed.OutOfRangeTime = 0.0f;
+	managed.GridRuntime.Reset();
+	SetResidency(managed, EPlanetResidency::Active);
+}
+
+void UPlanetManagerSubsystem::RestoreLayers(UPlanetData& planet, const FPlanetSaveMetadata& metadata, const FHexGridRuntime& gridRuntime, const TArray<TArray<uint32>>& words,
+	TConstArrayView<FRegistryLayer> registryLayers)
+{
+	RestoringPlanet = &planet;
+	planet.InitializeDataLayers();
+	RestoringPlanet = nullptr;
+	metadata.Apply(planet);
+
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		for (int32 faceIndex = 0; faceIndex < FPlanetSaveFormat::FaceCount; ++faceIndex)
+		{
+			const EPlanetDataLayer layer = static_cast<EPlanetDataLayer>(layerIdx);
+			const TArray<int32>& cellIds = gridRuntime.GetFaceCells()[faceIndex];
+			const TArray<uint32>& chunkWords = words[FPlanetSaveFormat::GetChunkIndex(layer, faceIndex)];
+			if (chunkWords.Num() == cellIds.Num() && cellIds.Num() > 0)
+			{
+				FPlanetSaveFormat::ScatterChunk(planet, layer, cellIds, chunkWords);
+			}
+		}
+	}
+
+	// Layers unregistered or resized in the meantime keep their new values
+	FPlanetLayerRegistry& registry = planet.GetLayerRegistry();
+	for (const FRegistryLayer& registryLayer : registryLayers)
+	{
+		const TArrayView<uint8> bytes = registry.GetRawData(registry.FindLayer(registryLayer.Name));
+		if (bytes.Num() == registryLayer.ByteCount && registryLayer.Words.Num() * static_cast<int32>(sizeof(uint32)) >= bytes.Num())
+		{
+			FMemory::Memcpy(bytes.GetData(), registryLayer.Words.GetData(), bytes.Num());
+		}
+	}
+
+	// Listeners already have these values, the restore is not an edit
+	planet.DiscardChanges();
+}
+
+void UPlanetManagerSubsystem::SetResidency(FManagedPlanet& managed, EPlanetResidency residency)
+{
+	managed.Residency = residency;
+	if (residency == EPlanetResidency::Active || residency == EPlanetResidency::Hibernated)
+	{
+		OnResidencyChanged.Broadcast(managed.Planet.Get(), residency);
+	}
+}
+
+void UPlanetManagerSubsystem::DeleteHibernateFile(FManagedPlanet& managed)
+{
+	if (!managed.FilePath.IsEmpty())
+	{
+		IFileManager::Get().Delete(*managed.FilePath, false, false, true);
+		managed.FilePath.Reset();
+	}
+}
+
+void UPlanetManagerSubsystem::UpdateRelevance(float deltaTime)
+{
+	TArray<FVector> viewpoints = ExtraRelevanceLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* playerController = It->Get())
+		{
+			FVector location;
+			FRotator rotation;
+			playerController->GetPlayerViewPoint(location, rotation);
+			viewpoints.Add(location);
+		}
+	}
+
+	// Without a viewpoint nothing tells which planets matter, keep everything as is
+	if (viewpoints.Num() == 0)
+	{
+		return;
+	}
+
+	int32 transitionsInFlight = 0;
+	TArray<TPair<double, FManagedPlanet*>> wakeCandidates;
+	TArray<FManagedPlanet*> hibernateCandidates;
+
+	for (TPair<TObjectKey<UPlanetData>, FManagedPlanet>& pair : Planets)
+	{
+		FManagedPlanet& managed = pair.Value;
+		const UPlanetData* planet = managed.Planet.Get();
+		if (!planet || !planet->GetOwner())
+		{
+			continue;
+		}
+
+		if (managed.Residency == EPlanetResidency::Hibernating || managed.Residency == EPlanetResidency::Waking)
+		{
+			++transitionsInFlight;
+			continue;
+		}
+
+		const FVector location = planet->GetOwner()->GetActorLocation();
+		double distanceSquared = MAX_dbl;
+		for (const FVector& viewpoint : viewpoints)
+		{
+			distanceSquared = FMath::Min(distanceSquared, FVector::DistSquared(viewpoint, location));
+		}
+
+		if (managed.Residency == EPlanetResidency::Hibernated)
+		{
+			if (distanceSquared <= FMath::Square(static_cast<double>(ActiveDistance)))
+			{
+				wakeCandidates.Emplace(distanceSquared, &managed);
+			}
+			continue;
+		}
+
+		if (managed.bPinned || distanceSquared <= FMath::Square(static_cast<double>(HibernateDistance)))
+		{
+			managed.OutOfRangeTime = 0.0f;
+			continue;
+		}
+
+		managed.OutOfRangeTime += deltaTime;
+		if (managed.OutOfRangeTime >= HibernateDelay && CanHibernate(managed))
+		{
+			hibernateCandidates.Add(&managed);
+		}
+	}
+
+	// Nearest planets wake first, hibernation only uses the slots left
+	wakeCandidates.Sort([](const TPair<double, FManagedPlanet*>& a, const TPair<double, FManagedPlanet*>& b) { return a.Key < b.Key; });
+	for (const TPair<double, FManagedPlanet*>& candidate : wakeCandidates)
+	{
+		if (transitionsInFlight >= MaxTransitionsInFlight)
+		{
+			return;
+		}
+		transitionsInFlight += StartWake(*candidate.Value) ? 1 : 0;
+	}
+
+	for (FManagedPlanet* managed : hibernateCandidates)
+	{
+		if (transitionsInFlight >= MaxTransitionsInFlight)
+		{
+			return;
+		}
+		transitionsInFlight += StartHibernate(*managed) ? 1 : 0;
+	}
+}
+
+void UPlanetManagerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	for (TPair<TObjectKey<UPlanetData>, FManagedPlanet>& pair : Planets)
+	{
+		FManagedPlanet& managed = pair.Value;
+		if (managed.HibernateTask.IsValid() && managed.HibernateTask.IsReady())
+		{
+			CompleteHibernate(managed);
+		}
+		if (managed.WakeTask.IsValid() && managed.WakeTask.IsReady())
+		{
+			CompleteWake(managed);
+		}
+	}
+
+	UpdateTimer += DeltaTime;
+	if (UpdateTimer >= UpdateInterval)
+	{
+		UpdateRelevance(UpdateTimer);
+		UpdateTimer = 0.0f;
+	}
+}
@@ -0,0 +1,208 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlanetSave.h"
+#include "HexGridRuntime.h"
+#include "Async/Future.h"
+#include "UObject/ObjectKey.h"
+#include "PlanetManagerSubsystem.generated.h"
+
+class UPlanetData;
+
+/**
+ * Where the data layers of a managed planet live
+ */
+UENUM(BlueprintType)
+enum class EPlanetResidency : uint8
+{
+	/** Layers are resident, the planet can be read and edited */
+	Active			UMETA(DisplayName = "Active"),
+	/** Layers are being compressed, not resident */
+	Hibernating		UMETA(DisplayName = "Hibernating"),
+	/** Layers are compressed in memory or on disk */
+	Hibernated		UMETA(DisplayName = "Hibernated"),
+	/** Layers are being decompressed, resident on a later frame */
+	Waking			UMETA(DisplayName = "Waking")
+};
+
+/** Broadcast when a planet becomes active or hibernated, on the game thread. Do not register or unregister planets from it */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPlanetResidencyChanged, UPlanetData* /* Planet */, EPlanetResidency /* Residency */);
+
+/**
+ * Keeps only the planets near a viewpoint resident.
+ *
+ * Planets register when play begins. Planets further than HibernateDistance from every player viewpoint
+ * (and every extra relevance location) for HibernateDelay seconds are hibernated: their layers are
+ * gathered on the game thread, cleared from the planet, then compressed on workers with the save chunk
+ * format (FPlanetSaveFormat) and kept in memory or written to disk. Planets coming within ActiveDistance
+ * are decompressed on workers and written back on a later frame, so ActiveDistance above the distance
+ * at which a planet is needed gives it time to wake up.
+ *
+ * Registry layers (FPlanetLayerRegistry) are compressed the same way and always kept in memory, they are
+ * written back by name to the layers still registered when the planet wakes up.
+ * Code reading a planet that may hibernate checks UPlanetData::AreDataLayersInitialized or calls WakePlanetNow.
+ * Initializing the layers of a hibernated planet drops its hibernated state. Planets are never hibernated on
+ * network clients, which get their layers from the server, nor on the server while a UPlanetReplicationComponent
+ * sends them.
+ */
+UCLASS()
+class GALAXY_API UPlanetManagerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Hibernated planets within this distance of a viewpoint are woken up */
+	UPROPERTY(BlueprintReadWrite, Category = "Planet Manager", meta = (ClampMin = "0"))
+	float ActiveDistance = 200000.0f;
+
+	/** Planets further than this from every viewpoint are hibernated, above ActiveDistance to avoid flip-flopping */
+	UPROPERTY(BlueprintReadWrite, Category = "Planet Manager", meta = (ClampMin = "0"))
+	float HibernateDistance = 300000.0f;
+
+	/** Seconds a planet stays out of range before it is hibernated */
+	UPROPERTY(BlueprintReadWrite, Category = "Planet Manager", meta = (ClampMin = "0"))
+	float HibernateDelay = 10.0f;
+
+	/** Write hibernated planets to Saved/Planets/Hibernated/<process id> instead of keeping them in memory */
+	UPROPERTY(BlueprintReadWrite, Category = "Planet Manager")
+	bool bHibernateToDisk = false;
+
+	/** Planets compressed or decompressed at the same time by the automatic updates */
+	UPROPERTY(BlueprintReadWrite, Category = "Planet Manager", meta = (ClampMin = "1"))
+	int32 MaxTransitionsInFlight = 4;
+
+	/** Seconds between relevance updates */
+	UPROPERTY(BlueprintReadWrite, Category = "Planet Manager", meta = (ClampMin = "0"))
+	float UpdateInterval = 0.5f;
+
+	/** Locations keeping planets active in addition to the player viewpoints (cinematics, AI players) */
+	UPROPERTY(BlueprintReadWrite, Category = "Planet Manager")
+	TArray<FVector> ExtraRelevanceLocations;
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	void RegisterPlanet(UPlanetData* Planet);
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	void UnregisterPlanet(UPlanetData* Planet);
+
+	/** Start waking a planet up whatever its distance, false if it is not managed */
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	bool RequestActive(UPlanetData* Planet);
+
+	/** Make a planet resident right away, waiting for its background work. False if it could not be restored */
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	bool WakePlanetNow(UPlanetData* Planet);
+
+	/** Start hibernating a planet whatever its distance, false if it cannot hibernate now */
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	bool HibernatePlanet(UPlanetData* Planet);
+
+	/** Drop the hibernated layers of a planet that was given new layers (generation, load, replication), so waking it does not overwrite them */
+	void DiscardHibernatedLayers(UPlanetData* Planet);
+
+	/** Pinned planets are never hibernated automatically (player home world) */
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	void SetPlanetPinned(UPlanetData* Planet, bool bPinned);
+
+	/** Residency of a planet, unmanaged planets are active */
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	EPlanetResidency GetResidency(const UPlanetData* Planet) const;
+
+	/** Compressed bytes of the planets hibernated in memory */
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	int64 GetHibernatedMemoryBytes() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Manager")
+	int32 GetActivePlanetCount() const;
+
+	FOnPlanetResidencyChanged OnResidencyChanged;
+
+	/** Deletes the hibernate files left by sessions that are no longer running */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Front buffer of a registry layer */
+	struct FRegistryLayer
+	{
+		FName Name;
+		int32 ByteCount = 0;
+
+		/** Bytes padded to whole words, empty while compressed */
+		TArray<uint32> Words;
+		FPlanetSaveBlob Chunk;
+	};
+
+	struct FHibernateResult
+	{
+		bool bSuccess = false;
+		FPlanetSaveContent Content;
+
+		/** File holding the chunks, Content.Chunks is empty in that case */
+		FString FilePath;
+
+		/** Gathered words, only kept when compression failed to restore the planet */
+		TArray<TArray<uint32>> Words;
+		TArray<FRegistryLayer> RegistryLayers;
+	};
+
+	struct FWakeResult
+	{
+		bool bSuccess = false;
+		FPlanetSaveMetadata Metadata;
+		int32 CellCount = 0;
+		TArray<TArray<uint32>> Words;
+		TArray<FRegistryLayer> RegistryLayers;
+	};
+
+	struct FManagedPlanet
+	{
+		TWeakObjectPtr<UPlanetData> Planet;
+		EPlanetResidency Residency = EPlanetResidency::Active;
+		bool bPinned = false;
+		bool bWakeRequested = false;
+		float OutOfRangeTime = 0.0f;
+
+		/** Grid runtime the layers were gathered with, its face tables split the chunks */
+		FHexGridRuntimePtr GridRuntime;
+		FPlanetSaveContent Hibernated;
+		TArray<FRegistryLayer> RegistryLayers;
+		FString FilePath;
+		int64 HibernatedBytes = 0;
+
+		TFuture<FHibernateResult> HibernateTask;
+		TFuture<FWakeResult> WakeTask;
+	};
+
+	/** One directory per process, UniqueIDs are only unique within a process */
+	static FString GetHibernateDirectory();
+	FString GetHibernatePath(const UPlanetData& planet) const;
+
+	/** True if the planet can give its layers away now */
+	bool CanHibernate(const FManagedPlanet& managed) const;
+
+	bool StartHibernate(FManagedPlanet& managed);
+	bool StartWake(FManagedPlanet& managed);
+	void CompleteHibernate(FManagedPlanet& managed);
+	void CompleteWake(FManagedPlanet& managed);
+
+	/** Write gathered words back to a planet with freshly initialized layers */
+	void RestoreLayers(UPlanetData& planet, const FPlanetSaveMetadata& metadata, const FHexGridRuntime& gridRuntime, const TArray<TArray<uint32>>& words,
+		TConstArrayView<FRegistryLayer> registryLayers);
+
+	void UpdateRelevance(float deltaTime);
+	void SetResidency(FManagedPlanet& managed, EPlanetResidency residency);
+	static void DeleteHibernateFile(FManagedPlanet& managed);
+
+	TMap<TObjectKey<UPlanetData>, FManagedPlanet> Planets;
+	float UpdateTimer = 0.0f;
+
+	/** Planet the subsystem is restoring, its own InitializeDataLayers call does not discard anything */
+	const UPlanetData* RestoringPlanet = nullptr;
+};
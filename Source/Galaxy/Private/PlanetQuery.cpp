@@ -0,0 +1,436 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetQuery.h"
+#include "PlanetData.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	/** Words (32 cells each) written per ParallelFor task */
+	constexpr int32 QueryWordsPerTask = 256;
+
+	/// <summary>
+	/// Size the bitset and fill its words in parallel, makeWord(FirstCellId, CellCount) returns the bits of up to 32 cells
+	/// </summary>
+	template<typename WordFuncType>
+	void BuildWords(int32 cellCount, TBitArray<>& outCells, WordFuncType makeWord)
+	{
+		outCells.Init(false, cellCount);
+		uint32* words = outCells.GetData();
+		const int32 wordCount = FMath::DivideAndRoundUp(cellCount, 32);
+
+		ParallelFor(FMath::DivideAndRoundUp(wordCount, QueryWordsPerTask), [&](int32 taskIdx)
+			{
+				const int32 endWord = FMath::Min(wordCount, (taskIdx + 1) * QueryWordsPerTask);
+				for (int32 wordIdx = taskIdx * QueryWordsPerTask; wordIdx < endWord; ++wordIdx)
+				{
+					const int32 firstCellId = wordIdx * 32;
+					words[wordIdx] = makeWord(firstCellId, FMath::Min(32, cellCount - firstCellId));
+				}
+			});
+	}
+
+	/// <summary>
+	/// Scan a float layer, 4 cells per compare
+	/// </summary>
+	template<typename VectorTestType, typename ScalarTestType>
+	void ScanFloats(const float* values, int32 cellCount, TBitArray<>& outCells, VectorTestType vectorTest, ScalarTestType scalarTest)
+	{
+		BuildWords(cellCount, outCells, [&](int32 firstCellId, int32 count)
+			{
+				uint32 word = 0;
+				if (count == 32)
+				{
+					for (int32 k = 0; k < 32; k += 4)
+					{
+						word |= static_cast<uint32>(VectorMaskBits(vectorTest(VectorLoad(values + firstCellId + k)))) << k;
+					}
+				}
+				else
+				{
+					for (int32 k = 0; k < count; ++k)
+					{
+						word |= static_cast<uint32>(scalarTest(values[firstCellId + k])) << k;
+					}
+				}
+				return word;
+			});
+	}
+
+	/// <summary>
+	/// Scan packed elevations through a table giving the result of both nibbles of a byte
+	/// </summary>
+	void ScanNibbles(const FPackedNibbleLayer& layer, TBitArray<>& outCells, TFunctionRef<bool(int32)> test)
+	{
+		uint8 nibbleBits[16];
+		for (int32 nibble = 0; nibble < 16; ++nibble)
+		{
+			nibbleBits[nibble] = test(layer.GetMinValue() + nibble) ? 1 : 0;
+		}
+
+		uint8 byteBits[256];
+		for (int32 byte = 0; byte < 256; ++byte)
+		{
+			byteBits[byte] = static_cast<uint8>(nibbleBits[byte & 0xF] | (nibbleBits[byte >> 4] << 1));
+		}
+
+		const uint8* bytes = layer.GetBytes().GetData();
+		BuildWords(layer.Num(), outCells, [&](int32 firstCellId, int32 count)
+			{
+				uint32 word = 0;
+				if (count == 32)
+				{
+					const uint8* wordBytes = bytes + (firstCellId >> 1);
+					for (int32 j = 0; j < 16; ++j)
+					{
+						word |= static_cast<uint32>(byteBits[wordBytes[j]]) << (j * 2);
+					}
+				}
+				else
+				{
+					for (int32 k = 0; k < count; ++k)
+					{
+						const int32 cellId = firstCellId + k;
+						word |= static_cast<uint32>(nibbleBits[(bytes[cellId >> 1] >> ((cellId & 1) << 2)) & 0xF]) << k;
+					}
+				}
+				return word;
+			});
+	}
+
+	/// <summary>
+	/// Scan a byte layer (biome indices) through a 256 entry table
+	/// </summary>
+	void ScanBytes(TConstArrayView<uint8> bytes, TBitArray<>& outCells, TFunctionRef<bool(int32)> test)
+	{
+		uint8 byteBits[256];
+		for (int32 byte = 0; byte < 256; ++byte)
+		{
+			byteBits[byte] = test(byte) ? 1 : 0;
+		}
+
+		BuildWords(bytes.Num(), outCells, [&](int32 firstCellId, int32 count)
+			{
+				uint32 word = 0;
+				for (int32 k = 0; k < count; ++k)
+				{
+					word |= static_cast<uint32>(byteBits[bytes[firstCellId + k]]) << k;
+				}
+				return word;
+			});
+	}
+
+	/// <summary>
+	/// Scan an id layer at its packed width
+	/// </summary>
+	template<typename ElementType>
+	void ScanIdElements(const ElementType* values, int32 cellCount, TBitArray<>& outCells, TFunctionRef<bool(float)> test)
+	{
+		BuildWords(cellCount, outCells, [&](int32 firstCellId, int32 count)
+			{
+				uint32 word = 0;
+				for (int32 k = 0; k < count; ++k)
+				{
+					word |= static_cast<uint32>(test(static_cast<float>(values[firstCellId + k]))) << k;
+				}
+				return word;
+			});
+	}
+
+	void ScanIds(const FPackedIdLayer& layer, TBitArray<>& outCells, TFunctionRef<bool(float)> test)
+	{
+		const uint8* bytes = layer.GetBytes().GetData();
+		switch (layer.GetBytesPerElement())
+		{
+		case 1:		ScanIdElements(reinterpret_cast<const int8*>(bytes), layer.Num(), outCells, test); break;
+		case 2:		ScanIdElements(reinterpret_cast<const int16*>(bytes), layer.Num(), outCells, test); break;
+		default:	ScanIdElements(reinterpret_cast<const int32*>(bytes), layer.Num(), outCells, test); break;
+		}
+	}
+
+	bool CompareValue(float value, EPlanetQueryCompare compare, float reference)
+	{
+		switch (compare)
+		{
+		case EPlanetQueryCompare::Less:			return value < reference;
+		case EPlanetQueryCompare::LessEqual:	return value <= reference;
+		case EPlanetQueryCompare::Greater:		return value > reference;
+		case EPlanetQueryCompare::GreaterEqual:	return value >= reference;
+		case EPlanetQueryCompare::Equal:		return value == reference;
+		case EPlanetQueryCompare::NotEqual:		return value != reference;
+		default:								return false;
+		}
+	}
+
+	void ScanFloatCompare(const float* values, int32 cellCount, EPlanetQueryCompare compare, float reference, TBitArray<>& outCells)
+	{
+		const VectorRegister4Float ref = VectorSetFloat1(reference);
+		switch (compare)
+		{
+		case EPlanetQueryCompare::Less:
+			ScanFloats(values, cellCount, outCells, [&](VectorRegister4Float v) { return VectorCompareLT(v, ref); }, [&](float v) { return v < reference; });
+			break;
+		case EPlanetQueryCompare::LessEqual:
+			ScanFloats(values, cellCount, outCells, [&](VectorRegister4Float v) { return VectorCompareLE(v, ref); }, [&](float v) { return v <= reference; });
+			break;
+		case EPlanetQueryCompare::Greater:
+			ScanFloats(values, cellCount, outCells, [&](VectorRegister4Float v) { return VectorCompareGT(v, ref); }, [&](float v) { return v > reference; });
+			break;
+		case EPlanetQueryCompare::GreaterEqual:
+			ScanFloats(values, cellCount, outCells, [&](VectorRegister4Float v) { return VectorCompareGE(v, ref); }, [&](float v) { return v >= reference; });
+			break;
+		case EPlanetQueryCompare::Equal:
+			ScanFloats(values, cellCount, outCells, [&](VectorRegister4Float v) { return VectorCompareEQ(v, ref); }, [&](float v) { return v == reference; });
+			break;
+		case EPlanetQueryCompare::NotEqual:
+			ScanFloats(values, cellCount, outCells, [&](VectorRegister4Float v) { return VectorCompareNE(v, ref); }, [&](float v) { return v != reference; });
+			break;
+		}
+	}
+
+	void ScanFloatRange(const float* values, int32 cellCount, float minValue, float maxValue, TBitArray<>& outCells)
+	{
+		const VectorRegister4Float minRef = VectorSetFloat1(minValue);
+		const VectorRegister4Float maxRef = VectorSetFloat1(maxValue);
+		ScanFloats(values, cellCount, outCells,
+			[&](VectorRegister4Float v) { return VectorBitwiseAnd(VectorCompareGE(v, minRef), VectorCompareLE(v, maxRef)); },
+			[&](float v) { return v >= minValue && v <= maxValue; });
+	}
+
+	void CombineWords(TBitArray<>& target, const TBitArray<>& other, bool bAnd)
+	{
+		uint32* words = target.GetData();
+		const uint32* otherWords = other.GetData();
+		const int32 wordCount = FMath::DivideAndRoundUp(target.Num(), 32);
+		for (int32 wordIdx = 0; wordIdx < wordCount; ++wordIdx)
+		{
+			words[wordIdx] = bAnd ? (words[wordIdx] & otherWords[wordIdx]) : (words[wordIdx] | otherWords[wordIdx]);
+		}
+	}
+
+	void InvertWords(TBitArray<>& target)
+	{
+		uint32* words = target.GetData();
+		const int32 wordCount = FMath::DivideAndRoundUp(target.Num(), 32);
+		for (int32 wordIdx = 0; wordIdx < wordCount; ++wordIdx)
+		{
+			words[wordIdx] = ~words[wordIdx];
+		}
+
+		// Bits past the last cell stay cleared
+		const int32 tailBits = target.Num() & 31;
+		if (tailBits != 0)
+		{
+			words[wordCount - 1] &= (1u << tailBits) - 1;
+		}
+	}
+}
+
+FPlanetQuery::FPlanetQuery()
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::All;
+	Root = node;
+}
+
+FPlanetQuery FPlanetQuery::Compare(EPlanetDataLayer layer, EPlanetQueryCompare compare, float value)
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::Compare;
+	node->Layer = layer;
+	node->CompareOp = compare;
+	node->A = value;
+	return FPlanetQuery(node);
+}
+
+FPlanetQuery FPlanetQuery::InRange(EPlanetDataLayer layer, float minValue, float maxValue)
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::InRange;
+	node->Layer = layer;
+	node->A = minValue;
+	node->B = maxValue;
+	return FPlanetQuery(node);
+}
+
+FPlanetQuery FPlanetQuery::Underwater()
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::Underwater;
+	node->Layer = EPlanetDataLayer::Elevation;
+	return FPlanetQuery(node);
+}
+
+FPlanetQuery FPlanetQuery::BiomeIs(const UBiomeData* biome)
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::Biome;
+	node->Layer = EPlanetDataLayer::Biome;
+	node->Biome = biome;
+	return FPlanetQuery(node);
+}
+
+FPlanetQuery FPlanetQuery::AllOf(TConstArrayView<FPlanetQueryCondition> conditions)
+{
+	FPlanetQuery query;
+	for (int32 i = 0; i < conditions.Num(); ++i)
+	{
+		const FPlanetQueryCondition& condition = conditions[i];
+		FPlanetQuery conditionQuery = Compare(condition.Layer, condition.Compare, condition.Value);
+		if (condition.bNegate)
+		{
+			conditionQuery = !conditionQuery;
+		}
+		query = i == 0 ? conditionQuery : query && conditionQuery;
+	}
+	return query;
+}
+
+FPlanetQuery FPlanetQuery::operator&&(const FPlanetQuery& other) const
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::And;
+	node->Left = Root;
+	node->Right = other.Root;
+	return FPlanetQuery(node);
+}
+
+FPlanetQuery FPlanetQuery::operator||(const FPlanetQuery& other) const
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::Or;
+	node->Left = Root;
+	node->Right = other.Root;
+	return FPlanetQuery(node);
+}
+
+FPlanetQuery FPlanetQuery::operator!() const
+{
+	TSharedPtr<FNode> node = MakeShared<FNode>();
+	node->Type = ENodeType::Not;
+	node->Left = Root;
+	return FPlanetQuery(node);
+}
+
+void FPlanetQuery::Evaluate(const UPlanetData& planet, TBitArray<>& outCells) const
+{
+	if (!planet.AreDataLayersInitialized())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetQuery::Evaluate - Planet data layers are not initialized."));
+		outCells.Reset();
+		return;
+	}
+
+	EvaluateNode(planet, *Root, outCells);
+}
+
+int32 FPlanetQuery::Count(const UPlanetData& planet) const
+{
+	TBitArray<> cells;
+	Evaluate(planet, cells);
+	return cells.CountSetBits();
+}
+
+void FPlanetQuery::GetCellIds(const UPlanetData& planet, TArray<int32>& outCellIds) const
+{
+	TBitArray<> cells;
+	Evaluate(planet, cells);
+
+	outCellIds.Reset(cells.CountSetBits());
+	for (TConstSetBitIterator<> It(cells); It; ++It)
+	{
+		outCellIds.Add(It.GetIndex());
+	}
+}
+
+void FPlanetQuery::EvaluateNode(const UPlanetData& planet, const FNode& node, TBitArray<>& outCells)
+{
+	const int32 cellCount = planet.GetCellCount();
+
+	switch (node.Type)
+	{
+	case ENodeType::All:
+		outCells.Init(true, cellCount);
+		return;
+
+	case ENodeType::And:
+	case ENodeType::Or:
+	{
+		EvaluateNode(planet, *node.Left, outCells);
+		TBitArray<> right;
+		EvaluateNode(planet, *node.Right, right);
+		CombineWords(outCells, right, node.Type == ENodeType::And);
+		return;
+	}
+
+	case ENodeType::Not:
+		EvaluateNode(planet, *node.Left, outCells);
+		InvertWords(outCells);
+		return;
+
+	case ENodeType::Underwater:
+	{
+		const int32 waterLevel = planet.WaterLevel;
+		ScanNibbles(planet.ElevationLayer, outCells, [waterLevel](int32 elevation) { return elevation <= waterLevel; });
+		return;
+	}
+
+	case ENodeType::Biome:
+	{
+		// Slot 0 is "no biome", a null biome matches the cells without one
+		const int32 paletteIndex = node.Biome ? planet.BiomePalette.IndexOfByKey(node.Biome) : 0;
+		if (paletteIndex == INDEX_NONE)
+		{
+			outCells.Init(false, cellCount);
+			return;
+		}
+		ScanBytes(planet.BiomeIndex, outCells, [paletteIndex](int32 index) { return index == paletteIndex; });
+		return;
+	}
+
+	default:
+		break;
+	}
+
+	// Layer comparisons
+	const bool bRange = node.Type == ENodeType::InRange;
+	auto test = [&node, bRange](float value)
+		{
+			return bRange ? (value >= node.A && value <= node.B) : CompareValue(value, node.CompareOp, node.A);
+		};
+
+	switch (node.Layer)
+	{
+	case EPlanetDataLayer::Temperature:
+	case EPlanetDataLayer::Humidity:
+	{
+		const float* values = node.Layer == EPlanetDataLayer::Temperature ? planet.CellTemperature.GetData() : planet.CellHumidity.GetData();
+		if (bRange)
+		{
+			ScanFloatRange(values, cellCount, node.A, node.B, outCells);
+		}
+		else
+		{
+			ScanFloatCompare(values, cellCount, node.CompareOp, node.A, outCells);
+		}
+		break;
+	}
+	case EPlanetDataLayer::Elevation:
+		ScanNibbles(planet.ElevationLayer, outCells, [&test](int32 elevation) { return test(static_cast<float>(elevation)); });
+		break;
+	case EPlanetDataLayer::Biome:
+		ScanBytes(planet.BiomeIndex, outCells, [&test](int32 index) { return test(static_cast<float>(index)); });
+		break;
+	case EPlanetDataLayer::TectonicPlate:
+		ScanIds(planet.TectonicPlateLayer, outCells, test);
+		break;
+	case EPlanetDataLayer::Region:
+		ScanIds(planet.RegionLayer, outCells, test);
+		break;
+	default:
+		outCells.Init(false, cellCount);
+		break;
+	}
+}
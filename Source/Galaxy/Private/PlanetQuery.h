@@ -0,0 +1,155 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlanetDataLayer.h"
+#include "PlanetQuery.generated.h"
+
+class UPlanetData;
+class UBiomeData;
+
+UENUM(BlueprintType)
+enum class EPlanetQueryCompare : uint8
+{
+	Less			UMETA(DisplayName = "<"),
+	LessEqual		UMETA(DisplayName = "<="),
+	Greater			UMETA(DisplayName = ">"),
+	GreaterEqual	UMETA(DisplayName = ">="),
+	Equal			UMETA(DisplayName = "=="),
+	NotEqual		UMETA(DisplayName = "!=")
+};
+
+/**
+ * Comparison of one layer value against a constant, for Blueprint queries (UPlanetData::QueryCells)
+ */
+USTRUCT(BlueprintType)
+struct GALAXY_API FPlanetQueryCondition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Query")
+	EPlanetDataLayer Layer = EPlanetDataLayer::Elevation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Query")
+	EPlanetQueryCompare Compare = EPlanetQueryCompare::GreaterEqual;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Query")
+	float Value = 0.0f;
+
+	/** Select the cells that do not match */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Query")
+	bool bNegate = false;
+};
+
+/// <summary>
+/// Predicate over the data layers of a planet, evaluated for every cell at once into a bitset.
+///
+/// Queries are built from layer comparisons and composed with &&, || and !:
+///   FPlanetQuery query = FPlanetQuery::Underwater() && FPlanetQuery::Compare(EPlanetDataLayer::Temperature, EPlanetQueryCompare::Greater, 20.0f);
+///
+/// Each comparison compiles to a scan picked for the layer storage: SIMD compares 4 floats at a time,
+/// packed elevations and biome indices go through a lookup table built from the predicate, ids are
+/// compared at their packed width. Scans write whole 32-cell words in parallel and compositions are
+/// word-wise, so a query costs about one pass over the layers it reads.
+/// Queries are immutable and cheap to copy, evaluate them from the game thread.
+/// </summary>
+class GALAXY_API FPlanetQuery
+{
+public:
+	/// <summary>
+	/// Query matching every cell
+	/// </summary>
+	FPlanetQuery();
+
+	/// <summary>
+	/// Cells whose layer value compares to value
+	/// </summary>
+	static FPlanetQuery Compare(EPlanetDataLayer layer, EPlanetQueryCompare compare, float value);
+
+	/// <summary>
+	/// Cells whose layer value is within [minValue, maxValue]
+	/// </summary>
+	static FPlanetQuery InRange(EPlanetDataLayer layer, float minValue, float maxValue);
+
+	/// <summary>
+	/// Cells at or below the planet water level (same as UPlanetData::IsCellUnderwater)
+	/// </summary>
+	static FPlanetQuery Underwater();
+
+	/// <summary>
+	/// Cells using this biome, resolved in the palette of the planet the query is evaluated on.
+	/// The biome must stay alive as long as the query.
+	/// </summary>
+	static FPlanetQuery BiomeIs(const UBiomeData* biome);
+
+	/// <summary>
+	/// Every condition of a Blueprint condition list, every cell when the list is empty
+	/// </summary>
+	static FPlanetQuery AllOf(TConstArrayView<FPlanetQueryCondition> conditions);
+
+	FPlanetQuery operator&&(const FPlanetQuery& other) const;
+	FPlanetQuery operator||(const FPlanetQuery& other) const;
+	FPlanetQuery operator!() const;
+
+	/// <summary>
+	/// One bit per cell, set for the cells matching the query
+	/// </summary>
+	void Evaluate(const UPlanetData& planet, TBitArray<>& outCells) const;
+
+	/// <summary>
+	/// Number of matching cells
+	/// </summary>
+	int32 Count(const UPlanetData& planet) const;
+
+	/// <summary>
+	/// Matching cell ids, in increasing order
+	/// </summary>
+	void GetCellIds(const UPlanetData& planet, TArray<int32>& outCellIds) const;
+
+	/// <summary>
+	/// Call func(CellId) for every matching cell, in increasing order
+	/// </summary>
+	template<typename FuncType>
+	void ForEachCell(const UPlanetData& planet, FuncType&& func) const
+	{
+		TBitArray<> cells;
+		Evaluate(planet, cells);
+		for (TConstSetBitIterator<> It(cells); It; ++It)
+		{
+			func(It.GetIndex());
+		}
+	}
+
+private:
+	enum class ENodeType : uint8
+	{
+		All,
+		Compare,
+		InRange,
+		Underwater,
+		Biome,
+		And,
+		Or,
+		Not
+	};
+
+	struct FNode
+	{
+		ENodeType Type = ENodeType::Compare;
+		EPlanetDataLayer Layer = EPlanetDataLayer::Elevation;
+		EPlanetQueryCompare CompareOp = EPlanetQueryCompare::Equal;
+		float A = 0.0f;
+		float B = 0.0f;
+		const UBiomeData* Biome = nullptr;
+		TSharedPtr<const FNode> Left;
+		TSharedPtr<const FNode> Right;
+	};
+
+	explicit FPlanetQuery(TSharedPtr<const FNode> inRoot) : Root(MoveTemp(inRoot)) {}
+
+	static void EvaluateNode(const UPlanetData& planet, const FNode& node, TBitArray<>& outCells);
+
+	TSharedPtr<const FNode> Root;
+};
@@ -0,0 +1,618 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetReplication.h"
+#include "PlanetData.h"
+#include "PlanetManagerSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+	/** Largest payload accepted from the network */
+	constexpr uint32 MaxPayloadBytes = 1024 * 1024;
+
+	/** Entry header bit set when the values are a delta against the client's */
+	constexpr uint8 RelativeEntryFlag = 0x80;
+
+	uint32 ZigZagEncode(int32 value)
+	{
+		return (static_cast<uint32>(value) << 1) ^ static_cast<uint32>(value >> 31);
+	}
+
+	int32 ZigZagDecode(uint32 value)
+	{
+		return static_cast<int32>(value >> 1) ^ -static_cast<int32>(value & 1);
+	}
+
+	void WriteVarUInt(TArray<uint8>& outBytes, uint32 value)
+	{
+		while (value >= 0x80)
+		{
+			outBytes.Add(static_cast<uint8>(value | 0x80));
+			value >>= 7;
+		}
+		outBytes.Add(static_cast<uint8>(value));
+	}
+
+	bool ReadVarUInt(TConstArrayView<uint8> bytes, int32& offset, uint32& outValue)
+	{
+		outValue = 0;
+		for (int32 shift = 0; shift < 35; shift += 7)
+		{
+			if (offset >= bytes.Num())
+			{
+				return false;
+			}
+
+			const uint8 byte = bytes[offset++];
+			outValue |= static_cast<uint32>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+bool FPlanetReplicationPayload::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 byteCount = Bytes.Num();
+	Ar.SerializeIntPacked(byteCount);
+
+	if (Ar.IsLoading())
+	{
+		if (byteCount > MaxPayloadBytes)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+		Bytes.SetNumUninitialized(byteCount);
+	}
+
+	Ar.Serialize(Bytes.GetData(), byteCount);
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FPlanetChunkCodec::Quantize(const UPlanetData& planet, EPlanetDataLayer layer, float quantum, int32 firstCellId, TArrayView<int32> outValues)
+{
+	const int32 count = outValues.Num();
+	switch (layer)
+	{
+	case EPlanetDataLayer::Elevation:
+		for (int32 i = 0; i < count; ++i)
+		{
+			outValues[i] = planet.ElevationLayer.Get(firstCellId + i);
+		}
+		break;
+	case EPlanetDataLayer::Temperature:
+	case EPlanetDataLayer::Humidity:
+	{
+		const float* values = layer == EPlanetDataLayer::Temperature ? planet.CellTemperature.GetData() : planet.CellHumidity.GetData();
+		const float scale = 1.0f / quantum;
+		for (int32 i = 0; i < count; ++i)
+		{
+			outValues[i] = FMath::RoundToInt32(values[firstCellId + i] * scale);
+		}
+		break;
+	}
+	case EPlanetDataLayer::Biome:
+		for (int32 i = 0; i < count; ++i)
+		{
+			outValues[i] = planet.BiomeIndex[firstCellId + i];
+		}
+		break;
+	case EPlanetDataLayer::TectonicPlate:
+		for (int32 i = 0; i < count; ++i)
+		{
+			outValues[i] = planet.TectonicPlateLayer.Get(firstCellId + i);
+		}
+		break;
+	case EPlanetDataLayer::Region:
+		for (int32 i = 0; i < count; ++i)
+		{
+			outValues[i] = planet.RegionLayer.Get(firstCellId + i);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+bool FPlanetChunkCodec::Encode(EPlanetDataLayer layer, int32 chunkIndex, float quantum, TConstArrayView<int32> values, TConstArrayView<int32> base, TArray<uint8>& outBytes)
+{
+	const int32 count = values.Num();
+	const bool bRelative = base.Num() > 0;
+	check(!bRelative || base.Num() == count);
+
+	// Delta against the client's values, or against the previous cell for a first transfer
+	auto getDelta = [&](int32 i)
+		{
+			return bRelative ? values[i] - base[i] : values[i] - (i > 0 ? values[i - 1] : 0);
+		};
+
+	if (bRelative && FMemory::Memcmp(values.GetData(), base.GetData(), count * sizeof(int32)) == 0)
+	{
+		return false;
+	}
+
+	outBytes.Add(static_cast<uint8>(static_cast<uint8>(layer) | (bRelative ? RelativeEntryFlag : 0)));
+	WriteVarUInt(outBytes, chunkIndex);
+	if (IsFloatLayer(layer))
+	{
+		const int32 offset = outBytes.AddUninitialized(sizeof(float));
+		FMemory::Memcpy(outBytes.GetData() + offset, &quantum, sizeof(float));
+	}
+
+	// Zero run, literal count, literals, until every cell is covered
+	int32 i = 0;
+	while (i < count)
+	{
+		const int32 zeroStart = i;
+		while (i < count && getDelta(i) == 0)
+		{
+			++i;
+		}
+
+		const int32 literalStart = i;
+		while (i < count && getDelta(i) != 0)
+		{
+			++i;
+		}
+
+		WriteVarUInt(outBytes, literalStart - zeroStart);
+		WriteVarUInt(outBytes, i - literalStart);
+		for (int32 j = literalStart; j < i; ++j)
+		{
+			WriteVarUInt(outBytes, ZigZagEncode(getDelta(j)));
+		}
+	}
+
+	return true;
+}
+
+bool FPlanetChunkCodec::Decode(TConstArrayView<uint8> bytes, int32 cellCount, FPlanetChunkMirror& mirror,
+	TFunctionRef<void(EPlanetDataLayer layer, int32 firstCellId, int32 count, float quantum)> onChunkDecoded)
+{
+	const int32 chunkSize = FPlanetDirtyTracker::ChunkSize;
+
+	TArray<int32> decoded;
+	decoded.SetNumUninitialized(chunkSize);
+
+	int32 offset = 0;
+	while (offset < bytes.Num())
+	{
+		const uint8 header = bytes[offset++];
+		const bool bRelative = (header & RelativeEntryFlag) != 0;
+		const int32 layerIdx = header & ~RelativeEntryFlag;
+
+		uint32 chunkIndex = 0;
+		if (layerIdx >= PlanetDataLayerCount || !ReadVarUInt(bytes, offset, chunkIndex)
+			|| static_cast<int64>(chunkIndex) * chunkSize >= cellCount)
+		{
+			return false;
+		}
+
+		const EPlanetDataLayer layer = static_cast<EPlanetDataLayer>(layerIdx);
+		float quantum = 1.0f;
+		if (IsFloatLayer(layer))
+		{
+			if (offset + static_cast<int32>(sizeof(float)) > bytes.Num())
+			{
+				return false;
+			}
+			FMemory::Memcpy(&quantum, bytes.GetData() + offset, sizeof(float));
+			offset += sizeof(float);
+			if (!(quantum > 0.0f))
+			{
+				return false;
+			}
+		}
+
+		TArray<int32>& mirrorValues = mirror.Values[layerIdx];
+		if (mirrorValues.Num() != cellCount)
+		{
+			mirrorValues.SetNumZeroed(cellCount);
+		}
+
+		const int32 firstCellId = static_cast<int32>(chunkIndex) * chunkSize;
+		const int32 count = FMath::Min(chunkSize, cellCount - firstCellId);
+		const int32* base = mirrorValues.GetData() + firstCellId;
+
+		int32 i = 0;
+		int32 previous = 0;
+		while (i < count)
+		{
+			uint32 zeroCount = 0;
+			uint32 literalCount = 0;
+			if (!ReadVarUInt(bytes, offset, zeroCount) || !ReadVarUInt(bytes, offset, literalCount)
+				|| zeroCount + literalCount == 0 || static_cast<uint64>(zeroCount) + literalCount > static_cast<uint64>(count - i))
+			{
+				return false;
+			}
+
+			for (uint32 k = 0; k < zeroCount + literalCount; ++k, ++i)
+			{
+				uint32 encoded = 0;
+				if (k >= zeroCount && !ReadVarUInt(bytes, offset, encoded))
+				{
+					return false;
+				}
+
+				const int32 delta = ZigZagDecode(encoded);
+				decoded[i] = bRelative ? base[i] + delta : previous + delta;
+				previous = decoded[i];
+			}
+		}
+
+		// Only complete chunks reach the mirror
+		FMemory::Memcpy(mirrorValues.GetData() + firstCellId, decoded.GetData(), count * sizeof(int32));
+		onChunkDecoded(layer, firstCellId, count, quantum);
+	}
+
+	return true;
+}
+
+bool FPlanetChunkCodec::Apply(UPlanetData& planet, TConstArrayView<uint8> bytes, FPlanetChunkMirror& mirror)
+{
+	TArray<int32> current;
+	current.SetNumUninitialized(FPlanetDirtyTracker::ChunkSize);
+	TArray<int32> changedCellIds;
+	TArray<float> changedValues;
+
+	return Decode(bytes, planet.GetCellCount(), mirror, [&](EPlanetDataLayer layer, int32 firstCellId, int32 count, float quantum)
+		{
+			// Cells written locally since are overwritten too, the server owns the layers
+			TArrayView<int32> currentValues(current.GetData(), count);
+			Quantize(planet, layer, quantum, firstCellId, currentValues);
+			const int32* received = mirror.Values[static_cast<int32>(layer)].GetData() + firstCellId;
+
+			changedCellIds.Reset();
+			changedValues.Reset();
+			for (int32 i = 0; i < count; ++i)
+			{
+				if (received[i] != currentValues[i])
+				{
+					changedCellIds.Add(firstCellId + i);
+					changedValues.Add(IsFloatLayer(layer) ? received[i] * quantum : static_cast<float>(received[i]));
+				}
+			}
+
+			if (changedCellIds.Num() > 0)
+			{
+				planet.SetCellValues(layer, changedCellIds, changedValues);
+			}
+		});
+}
+
+UPlanetReplicationComponent::UPlanetReplicationComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	SetIsReplicatedByDefault(true);
+
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		ReplicatedLayers.Add(static_cast<EPlanetDataLayer>(layerIdx));
+	}
+}
+
+bool UPlanetReplicationComponent::ShouldReplicate() const
+{
+	// The listen server's own controller shares the server planet
+	const APlayerController* controller = Cast<APlayerController>(GetOwner());
+	return controller && controller->HasAuthority() && !controller->IsLocalController();
+}
+
+bool UPlanetReplicationComponent::IsClientUpToDate() const
+{
+	if (!Planet || !Planet->AreDataLayersInitialized() || PendingPackets.Num() > 0)
+	{
+		return false;
+	}
+
+	const FPlanetDirtyTracker& tracker = Planet->GetDirtyTracker();
+	if (tracker.GetCellCount() != SyncedCellCount)
+	{
+		return false;
+	}
+
+	for (EPlanetDataLayer layer : ReplicatedLayers)
+	{
+		if (Layers[static_cast<int32>(layer)].SyncedVersion != tracker.GetLayerVersion(layer))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void UPlanetReplicationComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!ShouldReplicate())
+	{
+		return;
+	}
+
+	if (!Planet)
+	{
+		for (TObjectIterator<UPlanetData> It; It; ++It)
+		{
+			if (It->GetWorld() == GetWorld())
+			{
+				Planet = *It;
+				break;
+			}
+		}
+	}
+
+	if (!Planet)
+	{
+		return;
+	}
+
+	// A planet picked while hibernated is woken up, CanHibernate keeps it resident from then on
+	if (!Planet->AreDataLayersInitialized())
+	{
+		if (UPlanetManagerSubsystem* manager = GetWorld()->GetSubsystem<UPlanetManagerSubsystem>())
+		{
+			manager->RequestActive(Planet);
+		}
+		return;
+	}
+
+	const int32 cellCount = Planet->GetDirtyTracker().GetCellCount();
+	if (cellCount != SyncedCellCount || HasQuantumChanged())
+	{
+		ResetConnectionState(cellCount);
+	}
+
+	// Up to one second of unused budget is kept
+	ByteBudget = FMath::Min(ByteBudget + BytesPerSecond * DeltaTime, static_cast<float>(FMath::Max(BytesPerSecond, MaxPacketBytes)));
+
+	SendPalette();
+	while (ByteBudget > 0.0f && UnacknowledgedBytes < MaxUnacknowledgedBytes)
+	{
+		if (!SendChunks())
+		{
+			break;
+		}
+	}
+}
+
+void UPlanetReplicationComponent::ResetConnectionState(int32 cellCount)
+{
+	const int32 chunkCount = FMath::DivideAndRoundUp(cellCount, FPlanetDirtyTracker::ChunkSize);
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		// Version 0 is never used by the tracker, chunks at 0 were never sent
+		FLayerState& state = Layers[layerIdx];
+		state.SentVersions.Init(0, chunkCount);
+		state.ClientValues.Empty();
+		state.SyncedVersion = 0;
+		state.NextChunk = 0;
+		state.Quantum = GetQuantum(static_cast<EPlanetDataLayer>(layerIdx));
+	}
+
+	SentPalette.Reset();
+	SyncedCellCount = cellCount;
+	ResetSequence = NextSequence;
+}
+
+bool UPlanetReplicationComponent::HasQuantumChanged() const
+{
+	// ClientValues of a float layer are in the old scale, relative entries against them would be wrong
+	return Layers[static_cast<int32>(EPlanetDataLayer::Temperature)].Quantum != TemperatureQuantum
+		|| Layers[static_cast<int32>(EPlanetDataLayer::Humidity)].Quantum != HumidityQuantum;
+}
+
+float UPlanetReplicationComponent::GetQuantum(EPlanetDataLayer layer) const
+{
+	switch (layer)
+	{
+	case EPlanetDataLayer::Temperature:	return TemperatureQuantum;
+	case EPlanetDataLayer::Humidity:	return HumidityQuantum;
+	default:							return 1.0f;
+	}
+}
+
+void UPlanetReplicationComponent::SendPalette()
+{
+	// Sent before the biome chunks, reliable RPCs of an actor arrive in order
+	if (!ReplicatedLayers.Contains(EPlanetDataLayer::Biome) || SentPalette == Planet->BiomePalette)
+	{
+		return;
+	}
+
+	TArray<UBiomeData*> palette;
+	palette.Reserve(Planet->BiomePalette.Num());
+	for (const TObjectPtr<UBiomeData>& biome : Planet->BiomePalette)
+	{
+		palette.Add(biome);
+	}
+
+	ClientReceiveBiomePalette(Planet, palette);
+	SentPalette = Planet->BiomePalette;
+}
+
+bool UPlanetReplicationComponent::SendChunks()
+{
+	const FPlanetDirtyTracker& tracker = Planet->GetDirtyTracker();
+	const int32 cellCount = tracker.GetCellCount();
+	const int32 chunkCount = tracker.GetChunkCount();
+	const int32 chunkSize = FPlanetDirtyTracker::ChunkSize;
+
+	FPlanetReplicationPayload payload;
+	TArray<int32> values;
+	values.SetNumUninitialized(chunkSize);
+	int32 chunksInPacket = 0;
+	bool bFull = false;
+
+	for (int32 layerStep = 0; layerStep < PlanetDataLayerCount && !bFull; ++layerStep)
+	{
+		const int32 layerIdx = (NextLayer + layerStep) % PlanetDataLayerCount;
+		const EPlanetDataLayer layer = static_cast<EPlanetDataLayer>(layerIdx);
+		FLayerState& state = Layers[layerIdx];
+		const uint32 layerVersion = tracker.GetLayerVersion(layer);
+		if (state.SyncedVersion == layerVersion || !ReplicatedLayers.Contains(layer))
+		{
+			continue;
+		}
+
+		const float quantum = GetQuantum(layer);
+		int32 scannedChunks = 0;
+		for (; scannedChunks < chunkCount; ++scannedChunks)
+		{
+			const int32 chunkIndex = state.NextChunk;
+			const uint32 chunkVersion = tracker.GetChunkVersion(layer, chunkIndex);
+			if (state.SentVersions[chunkIndex] != chunkVersion)
+			{
+				const int32 firstCellId = chunkIndex * chunkSize;
+				TArrayView<int32> chunkValues(values.GetData(), FMath::Min(chunkSize, cellCount - firstCellId));
+				FPlanetChunkCodec::Quantize(*Planet, layer, quantum, firstCellId, chunkValues);
+
+				TConstArrayView<int32> base;
+				if (state.SentVersions[chunkIndex] != 0)
+				{
+					base = TConstArrayView<int32>(state.ClientValues.GetData() + firstCellId, chunkValues.Num());
+				}
+
+				const int32 previousSize = payload.Bytes.Num();
+				if (FPlanetChunkCodec::Encode(layer, chunkIndex, quantum, chunkValues, base, payload.Bytes))
+				{
+					// Keep the chunk for the next packet, unless it is alone
+					if (payload.Bytes.Num() > MaxPacketBytes && previousSize > 0)
+					{
+						payload.Bytes.SetNum(previousSize);
+						bFull = true;
+						NextLayer = layerIdx;
+						break;
+					}
+					++chunksInPacket;
+				}
+
+				if (state.ClientValues.Num() != cellCount)
+				{
+					state.ClientValues.SetNumZeroed(cellCount);
+				}
+				FMemory::Memcpy(state.ClientValues.GetData() + firstCellId, chunkValues.GetData(), chunkValues.Num() * sizeof(int32));
+				state.SentVersions[chunkIndex] = chunkVersion;
+			}
+
+			state.NextChunk = (state.NextChunk + 1) % chunkCount;
+			if (payload.Bytes.Num() >= MaxPacketBytes)
+			{
+				bFull = true;
+				NextLayer = layerIdx;
+				++scannedChunks;
+				break;
+			}
+		}
+
+		// Every chunk was checked since the layer version was read
+		if (scannedChunks == chunkCount)
+		{
+			state.SyncedVersion = layerVersion;
+		}
+	}
+
+	if (payload.Bytes.Num() == 0)
+	{
+		return false;
+	}
+
+	const int32 sequence = NextSequence++;
+	const int32 packetBytes = payload.Bytes.Num();
+	ClientReceiveChunks(Planet, sequence, cellCount, payload);
+
+	PendingPackets.Add({ sequence, packetBytes });
+	UnacknowledgedBytes += packetBytes;
+	ByteBudget -= packetBytes;
+	BytesSent += packetBytes;
+	ChunksSent += chunksInPacket;
+
+	UE_LOG(LogTemp, Verbose, TEXT("UPlanetReplicationComponent - Sent packet %d: %d chunks, %d bytes."), sequence, chunksInPacket, packetBytes);
+	return true;
+}
+
+void UPlanetReplicationComponent::ClientReceiveBiomePalette_Implementation(UPlanetData* TargetPlanet, const TArray<UBiomeData*>& Palette)
+{
+	if (!TargetPlanet)
+	{
+		return;
+	}
+
+	TargetPlanet->BiomePalette.Reset(Palette.Num());
+	for (UBiomeData* biome : Palette)
+	{
+		TargetPlanet->BiomePalette.Add(biome);
+	}
+	TargetPlanet->RebuildBiomeLookupTables();
+}
+
+void UPlanetReplicationComponent::ClientReceiveChunks_Implementation(UPlanetData* TargetPlanet, int32 Sequence, int32 CellCount, const FPlanetReplicationPayload& Payload)
+{
+	bool bApplied = false;
+	if (!TargetPlanet)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetReplicationComponent - Packet %d targets a planet that is not resolved yet."), Sequence);
+	}
+	else
+	{
+		if (!TargetPlanet->AreDataLayersInitialized() && TargetPlanet->Grid)
+		{
+			TargetPlanet->InitializeDataLayers();
+		}
+
+		if (TargetPlanet->GetCellCount() != CellCount)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UPlanetReplicationComponent - Server planet has %d cells, local planet has %d. Is the grid the same?"),
+				CellCount, TargetPlanet->GetCellCount());
+		}
+		else if (!FPlanetChunkCodec::Apply(*TargetPlanet, Payload.Bytes, ReceivedValues))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UPlanetReplicationComponent - Malformed packet %d."), Sequence);
+		}
+		else
+		{
+			bApplied = true;
+		}
+	}
+
+	// The server believes the chunks of a dropped packet arrived, later deltas against them would be wrong
+	if (bApplied)
+	{
+		ServerAcknowledge(Sequence);
+	}
+	else
+	{
+		ServerRequestResync(Sequence);
+	}
+}
+
+void UPlanetReplicationComponent::ServerAcknowledge_Implementation(int32 Sequence)
+{
+	int32 acknowledged = 0;
+	while (acknowledged < PendingPackets.Num() && PendingPackets[acknowledged].Sequence <= Sequence)
+	{
+		UnacknowledgedBytes -= PendingPackets[acknowledged].Bytes;
+		++acknowledged;
+	}
+	PendingPackets.RemoveAt(0, acknowledged);
+}
+
+void UPlanetReplicationComponent::ServerRequestResync_Implementation(int32 Sequence)
+{
+	ServerAcknowledge_Implementation(Sequence);
+
+	// Packets sent before the last reset are covered by it, the chunks they held are sent again anyway
+	if (Sequence >= ResetSequence && SyncedCellCount != INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Log, TEXT("UPlanetReplicationComponent - Client dropped packet %d, sending every chunk again."), Sequence);
+		ResetConnectionState(SyncedCellCount);
+	}
+}
@@ -0,0 +1,218 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "PlanetDataLayer.h"
+#include "PlanetReplication.generated.h"
+
+class UPlanetData;
+class UBiomeData;
+class UPackageMap;
+
+/**
+ * Encoded layer chunks sent in one RPC, serialized as raw bytes (no per-element array overhead or size limit)
+ */
+USTRUCT()
+struct GALAXY_API FPlanetReplicationPayload
+{
+	GENERATED_BODY()
+
+	TArray<uint8> Bytes;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FPlanetReplicationPayload> : public TStructOpsTypeTraitsBase2<FPlanetReplicationPayload>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/// <summary>
+/// Quantized values of every layer as last received from the server, the base of relative chunk entries.
+/// Kept apart from the planet so local writes on the client do not shift the base the server encodes against.
+/// </summary>
+struct GALAXY_API FPlanetChunkMirror
+{
+	TStaticArray<TArray<int32>, PlanetDataLayerCount> Values;
+};
+
+/// <summary>
+/// Wire format of the layer chunks.
+///
+/// Each chunk of FPlanetDirtyTracker::ChunkSize cells is quantized to integers (elevation, biome and ids
+/// are exact, temperature / humidity are rounded to a quantum) then sent either as a delta against the
+/// values the client last received, or, for its first transfer, as differences between consecutive cells.
+/// Both are mostly zeros or small numbers, stored as alternating zero runs and zigzag varint literals.
+/// </summary>
+class GALAXY_API FPlanetChunkCodec
+{
+public:
+	/// <summary>
+	/// Quantized values of cells [firstCellId, firstCellId + outValues.Num())
+	/// </summary>
+	static void Quantize(const UPlanetData& planet, EPlanetDataLayer layer, float quantum, int32 firstCellId, TArrayView<int32> outValues);
+
+	/// <summary>
+	/// Append a chunk entry, base is the client's values or empty for a first transfer. Returns false when nothing changed
+	/// </summary>
+	static bool Encode(EPlanetDataLayer layer, int32 chunkIndex, float quantum, TConstArrayView<int32> values, TConstArrayView<int32> base, TArray<uint8>& outBytes);
+
+	/// <summary>
+	/// Decode every entry of a payload into the mirror, relative entries are added to the mirror values
+	/// </summary>
+	/// <param name="bytes">Payload</param>
+	/// <param name="cellCount">Cell count of the planet the payload was encoded for</param>
+	/// <param name="mirror">Values received so far, layers are sized to cellCount on first use</param>
+	/// <param name="onChunkDecoded">Called with the layer, first cell id, cell count and quantum of every decoded chunk</param>
+	/// <returns>False if the payload is malformed, entries before the error are decoded</returns>
+	static bool Decode(TConstArrayView<uint8> bytes, int32 cellCount, FPlanetChunkMirror& mirror,
+		TFunctionRef<void(EPlanetDataLayer layer, int32 firstCellId, int32 count, float quantum)> onChunkDecoded);
+
+	/// <summary>
+	/// Decode every entry of a payload and write the cells of the planet that differ from the received values
+	/// </summary>
+	/// <returns>False if the payload is malformed, entries before the error are applied</returns>
+	static bool Apply(UPlanetData& planet, TConstArrayView<uint8> bytes, FPlanetChunkMirror& mirror);
+
+	static bool IsFloatLayer(EPlanetDataLayer layer) { return layer == EPlanetDataLayer::Temperature || layer == EPlanetDataLayer::Humidity; }
+};
+
+/**
+ * Replicates the data layers of a planet to one client, in chunks.
+ *
+ * Add it to the PlayerController: the server keeps, per connection, the chunk versions (FPlanetDirtyTracker)
+ * and values it already sent, and only sends chunks whose version changed, delta-encoded against them.
+ * Packets are reliable so every sent packet eventually arrives in order, acknowledgements bound the
+ * bytes in flight and the send rate is capped by BytesPerSecond. A packet the client cannot apply
+ * (planet not resolved yet, different grid, malformed payload) is answered with a resync request and
+ * every chunk is sent again from scratch. The client planet must use the same grid,
+ * its layers are owned by the server. The planet must be net addressable (placed in the level or on a
+ * replicated actor). Test with Play As Listen Server and 2 players: edits on the server cost bytes
+ * proportional to the changed cells (see BytesSent).
+ */
+UCLASS(classGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GALAXY_API UPlanetReplicationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPlanetReplicationComponent();
+
+	/** Planet to replicate, the first planet of the world when not set. Only used on the server */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Replication")
+	TObjectPtr<UPlanetData> Planet;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Replication")
+	TArray<EPlanetDataLayer> ReplicatedLayers;
+
+	/** Send rate cap for this connection */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Replication", meta = (ClampMin = "1024"))
+	int32 BytesPerSecond = 64 * 1024;
+
+	/** Largest payload of a single RPC, a chunk bigger than this is still sent alone */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Replication", meta = (ClampMin = "256"))
+	int32 MaxPacketBytes = 8 * 1024;
+
+	/** Bytes sent and not yet acknowledged by the client before sending pauses */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Replication", meta = (ClampMin = "1024"))
+	int32 MaxUnacknowledgedBytes = 64 * 1024;
+
+	/** Precision of the replicated temperatures */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Replication", meta = (ClampMin = "0.0001"))
+	float TemperatureQuantum = 0.05f;
+
+	/** Precision of the replicated humidities */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Replication", meta = (ClampMin = "0.0001"))
+	float HumidityQuantum = 0.005f;
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Replication")
+	int64 GetBytesSent() const { return BytesSent; }
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Replication")
+	int32 GetChunksSent() const { return ChunksSent; }
+
+	/** True when every replicated chunk is up to date on the client and acknowledged */
+	UFUNCTION(BlueprintCallable, Category = "Planet Replication")
+	bool IsClientUpToDate() const;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveBiomePalette(UPlanetData* TargetPlanet, const TArray<UBiomeData*>& Palette);
+
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveChunks(UPlanetData* TargetPlanet, int32 Sequence, int32 CellCount, const FPlanetReplicationPayload& Payload);
+
+	UFUNCTION(Server, Reliable)
+	void ServerAcknowledge(int32 Sequence);
+
+	/** The client dropped a packet, acknowledges it and resets the connection unless a reset already covers it */
+	UFUNCTION(Server, Reliable)
+	void ServerRequestResync(int32 Sequence);
+
+	bool ShouldReplicate() const;
+
+	/** Drop the per-connection state, every chunk is sent again from scratch */
+	void ResetConnectionState(int32 cellCount);
+
+	/** True when a quantum was edited since the client values were sent */
+	bool HasQuantumChanged() const;
+
+	void SendPalette();
+
+	/** Send one packet of changed chunks, false when there was nothing to send */
+	bool SendChunks();
+
+	float GetQuantum(EPlanetDataLayer layer) const;
+
+	struct FLayerState
+	{
+		/** Tracker version of every chunk when it was last sent */
+		TArray<uint32> SentVersions;
+
+		/** Quantized values the client has, allocated with the first sent chunk */
+		TArray<int32> ClientValues;
+
+		/** Tracker layer version once every chunk was sent */
+		uint32 SyncedVersion = 0;
+		int32 NextChunk = 0;
+
+		/** Quantum ClientValues are expressed in */
+		float Quantum = 1.0f;
+	};
+
+	struct FPendingPacket
+	{
+		int32 Sequence = 0;
+		int32 Bytes = 0;
+	};
+
+	/** Palette the client has */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UBiomeData>> SentPalette;
+
+	TStaticArray<FLayerState, PlanetDataLayerCount> Layers;
+	TArray<FPendingPacket> PendingPackets;
+
+	/** Client side: values received from the server */
+	FPlanetChunkMirror ReceivedValues;
+	int32 SyncedCellCount = INDEX_NONE;
+	int32 NextSequence = 0;
+
+	/** First packet sent after the last connection reset */
+	int32 ResetSequence = 0;
+	int32 NextLayer = 0;
+	int32 UnacknowledgedBytes = 0;
+	float ByteBudget = 0.0f;
+
+	int64 BytesSent = 0;
+	int32 ChunksSent = 0;
+};
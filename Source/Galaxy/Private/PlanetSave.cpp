@@ -0,0 +1,771 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetSave.h"
+#include "PlanetData.h"
+#include "HexGridAsset.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** Sanity limit when reading the plate list */
+	constexpr int32 MaxSavedPlates = 1 << 16;
+
+	int32 GetIntValue(const UPlanetData& planet, EPlanetDataLayer layer, int32 cellId)
+	{
+		switch (layer)
+		{
+		case EPlanetDataLayer::Elevation:		return planet.ElevationLayer.Get(cellId);
+		case EPlanetDataLayer::Biome:			return planet.BiomeIndex[cellId];
+		case EPlanetDataLayer::TectonicPlate:	return planet.TectonicPlateLayer.Get(cellId);
+		case EPlanetDataLayer::Region:			return planet.RegionLayer.Get(cellId);
+		default:								return 0;
+		}
+	}
+
+	bool IsFloatLayer(EPlanetDataLayer layer)
+	{
+		return layer == EPlanetDataLayer::Temperature || layer == EPlanetDataLayer::Humidity;
+	}
+}
+
+void FPlanetSaveMetadata::Capture(const UPlanetData& planet)
+{
+	WaterLevel = planet.WaterLevel;
+	PlanetRadius = planet.PlanetRadius;
+	TectonicPlates = planet.TectonicPlates;
+
+	BiomePalette.Reset(planet.BiomePalette.Num());
+	for (const TObjectPtr<UBiomeData>& biome : planet.BiomePalette)
+	{
+		BiomePalette.Add(biome ? FSoftObjectPath(biome.Get()).ToString() : FString());
+	}
+}
+
+void FPlanetSaveMetadata::Apply(UPlanetData& planet) const
+{
+	planet.WaterLevel = WaterLevel;
+	planet.PlanetRadius = PlanetRadius;
+	planet.TectonicPlates = TectonicPlates;
+
+	planet.BiomePalette.Reset(BiomePalette.Num());
+	for (const FString& path : BiomePalette)
+	{
+		UBiomeData* biome = path.IsEmpty() ? nullptr : Cast<UBiomeData>(FSoftObjectPath(path).TryLoad());
+		if (!path.IsEmpty() && !biome)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FPlanetSaveMetadata::Apply - Biome %s could not be loaded."), *path);
+		}
+		planet.BiomePalette.Add(biome);
+	}
+	planet.RebuildBiomeLookupTables();
+}
+
+FArchive& operator<<(FArchive& Ar, FPlanetSaveMetadata& metadata)
+{
+	Ar << metadata.WaterLevel;
+	Ar << metadata.PlanetRadius;
+	Ar << metadata.BiomePalette;
+
+	int32 plateCount = metadata.TectonicPlates.Num();
+	Ar << plateCount;
+	if (Ar.IsLoading())
+	{
+		if (plateCount < 0 || plateCount > MaxSavedPlates)
+		{
+			Ar.SetError();
+			return Ar;
+		}
+		metadata.TectonicPlates.SetNum(plateCount);
+	}
+
+	for (FTectonicPlate& plate : metadata.TectonicPlates)
+	{
+		Ar << plate.SeedCellId;
+		Ar << plate.CellCount;
+		Ar << plate.bContinental;
+		Ar << plate.EulerPole;
+		Ar << plate.AngularSpeed;
+	}
+	return Ar;
+}
+
+void FPlanetSaveFormat::BuildFaceCells(const UHexGridAsset& grid, TArray<TArray<int32>>& outFaceCells, TArray<uint8>& outCellFaces)
+{
+	const int32 cellCount = grid.Cells.Num();
+	outFaceCells.SetNum(FaceCount);
+	for (TArray<int32>& cells : outFaceCells)
+	{
+		cells.Reset();
+	}
+
+	outCellFaces.SetNumUninitialized(cellCount);
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		const uint8 faceIndex = static_cast<uint8>(FMath::Min<int32>(grid.Cells[cellId].IcosaheronFaceIndex, FaceCount - 1));
+		outCellFaces[cellId] = faceIndex;
+		outFaceCells[faceIndex].Add(cellId);
+	}
+}
+
+void FPlanetSaveFormat::GatherChunk(const UPlanetData& planet, EPlanetDataLayer layer, TConstArrayView<int32> cellIds, TArray<uint32>& outWords)
+{
+	outWords.SetNumUninitialized(cellIds.Num());
+
+	if (IsFloatLayer(layer))
+	{
+		const TArray<float>& values = layer == EPlanetDataLayer::Temperature ? planet.CellTemperature : planet.CellHumidity;
+		for (int32 i = 0; i < cellIds.Num(); ++i)
+		{
+			FMemory::Memcpy(&outWords[i], &values[cellIds[i]], sizeof(uint32));
+		}
+		return;
+	}
+
+	int32 previous = 0;
+	for (int32 i = 0; i < cellIds.Num(); ++i)
+	{
+		const int32 value = GetIntValue(planet, layer, cellIds[i]);
+		outWords[i] = static_cast<uint32>(value - previous);
+		previous = value;
+	}
+}
+
+void FPlanetSaveFormat::ScatterChunk(UPlanetData& planet, EPlanetDataLayer layer, TConstArrayView<int32> cellIds, TConstArrayView<uint32> words)
+{
+	check(cellIds.Num() == words.Num());
+
+	TArray<float> values;
+	values.SetNumUninitialized(words.Num());
+
+	if (IsFloatLayer(layer))
+	{
+		FMemory::Memcpy(values.GetData(), words.GetData(), words.Num() * sizeof(float));
+	}
+	else
+	{
+		int32 value = 0;
+		for (int32 i = 0; i < words.Num(); ++i)
+		{
+			value += static_cast<int32>(words[i]);
+			values[i] = static_cast<float>(value);
+		}
+	}
+
+	planet.SetCellValues(layer, TArray<int32>(cellIds), values);
+}
+
+FPlanetSaveBlob FPlanetSaveFormat::CompressChunk(TConstArrayView<uint32> words)
+{
+	const int32 wordCount = words.Num();
+	const int32 rawSize = wordCount * sizeof(uint32);
+	TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> blob = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+	if (rawSize == 0)
+	{
+		return blob;
+	}
+
+	// Byte planes: low bytes of every word, then second bytes...
+	TArray<uint8> planes;
+	planes.SetNumUninitialized(rawSize);
+	for (int32 plane = 0; plane < 4; ++plane)
+	{
+		uint8* planeBytes = planes.GetData() + plane * wordCount;
+		for (int32 i = 0; i < wordCount; ++i)
+		{
+			planeBytes[i] = static_cast<uint8>(words[i] >> (plane * 8));
+		}
+	}
+
+	int32 compressedSize = FCompression::CompressMemoryBound(NAME_Oodle, rawSize);
+	blob->SetNumUninitialized(compressedSize);
+	if (!FCompression::CompressMemory(NAME_Oodle, blob->GetData(), compressedSize, planes.GetData(), rawSize))
+	{
+		return nullptr;
+	}
+
+	blob->SetNum(compressedSize);
+	return blob;
+}
+
+bool FPlanetSaveFormat::DecompressChunk(const TArray<uint8>& blob, int32 wordCount, TArray<uint32>& outWords)
+{
+	const int32 rawSize = wordCount * sizeof(uint32);
+	outWords.SetNumUninitialized(wordCount);
+	if (rawSize == 0)
+	{
+		return true;
+	}
+
+	TArray<uint8> planes;
+	planes.SetNumUninitialized(rawSize);
+	if (!FCompression::UncompressMemory(NAME_Oodle, planes.GetData(), rawSize, blob.GetData(), blob.Num()))
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < wordCount; ++i)
+	{
+		outWords[i] = static_cast<uint32>(planes[i])
+			| (static_cast<uint32>(planes[wordCount + i]) << 8)
+			| (static_cast<uint32>(planes[2 * wordCount + i]) << 16)
+			| (static_cast<uint32>(planes[3 * wordCount + i]) << 24);
+	}
+	return true;
+}
+
+bool FPlanetSaveFormat::WriteFile(const FString& path, FPlanetSaveContent& content)
+{
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+
+	uint32 magic = Magic;
+	int32 version = Version;
+	int32 chunkCount = ChunkCount;
+	writer << magic;
+	writer << version;
+	writer << content.CellCount;
+	writer << chunkCount;
+	writer << content.Metadata;
+
+	check(content.Chunks.Num() == ChunkCount);
+	for (const FPlanetSaveBlob& chunk : content.Chunks)
+	{
+		int32 chunkSize = chunk ? chunk->Num() : 0;
+		writer << chunkSize;
+	}
+
+	for (const FPlanetSaveBlob& chunk : content.Chunks)
+	{
+		if (chunk && chunk->Num() > 0)
+		{
+			writer.Serialize(const_cast<uint8*>(chunk->GetData()), chunk->Num());
+		}
+	}
+
+	// A crash while writing leaves the previous save intact
+	const FString tempPath = path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(bytes, *tempPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("FPlanetSaveFormat::WriteFile - Could not write %s."), *tempPath);
+		return false;
+	}
+	return IFileManager::Get().Move(*path, *tempPath, true, true);
+}
+
+bool FPlanetSaveFormat::ReadFile(const FString& path, FPlanetSaveContent& outContent)
+{
+	TArray<uint8> bytes;
+	if (!FFileHelper::LoadFileToArray(bytes, *path, FILEREAD_Silent))
+	{
+		UE_LOG(LogTemp, Log, TEXT("FPlanetSaveFormat::ReadFile - No save at %s."), *path);
+		return false;
+	}
+
+	FMemoryReader reader(bytes);
+	uint32 magic = 0;
+	int32 version = 0;
+	int32 chunkCount = 0;
+	reader << magic;
+	reader << version;
+	reader << outContent.CellCount;
+	reader << chunkCount;
+
+	if (reader.IsError() || magic != Magic || version != Version || chunkCount != ChunkCount)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetSaveFormat::ReadFile - %s is not a planet save of version %d."), *path, Version);
+		return false;
+	}
+
+	reader << outContent.Metadata;
+
+	TArray<int32> chunkSizes;
+	chunkSizes.SetNumUninitialized(ChunkCount);
+	for (int32& chunkSize : chunkSizes)
+	{
+		reader << chunkSize;
+	}
+
+	if (reader.IsError())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetSaveFormat::ReadFile - %s is truncated."), *path);
+		return false;
+	}
+
+	int64 offset = reader.Tell();
+	outContent.Chunks.SetNum(ChunkCount);
+	for (int32 chunkIndex = 0; chunkIndex < ChunkCount; ++chunkIndex)
+	{
+		const int32 chunkSize = chunkSizes[chunkIndex];
+		if (chunkSize < 0 || offset + chunkSize > bytes.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FPlanetSaveFormat::ReadFile - %s is truncated."), *path);
+			return false;
+		}
+
+		outContent.Chunks[chunkIndex] = chunkSize > 0 ? MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(bytes.GetData() + offset, chunkSize) : FPlanetSaveBlob();
+		offset += chunkSize;
+	}
+
+	return true;
+}
+
+UPlanetSaveComponent::UPlanetSaveComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+FString UPlanetSaveComponent::GetSavePath() const
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Planets"), SaveName + TEXT(".planet"));
+}
+
+void UPlanetSaveComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!Planet && GetOwner())
+	{
+		Planet = GetOwner()->FindComponentByClass<UPlanetData>();
+	}
+
+	if (Planet)
+	{
+		LayersChangedHandle = Planet->OnLayersChanged.AddUObject(this, &UPlanetSaveComponent::HandleLayersChanged);
+	}
+
+	if (bLoadOnBeginPlay)
+	{
+		LoadAsync();
+	}
+}
+
+void UPlanetSaveComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Let the last save reach the disk
+	if (SaveTask.IsValid())
+	{
+		SaveTask.Wait();
+		CompleteSave();
+	}
+
+	if (Planet)
+	{
+		Planet->OnLayersChanged.Remove(LayersChangedHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool UPlanetSaveComponent::EnsureFaces()
+{
+	if (!Planet || !Planet->Grid || !Planet->AreDataLayersInitialized())
+	{
+		return false;
+	}
+
+	if (CellFaces.Num() == Planet->GetCellCount())
+	{
+		return true;
+	}
+
+	// New grid or first use: nothing is saved for it yet
+	FPlanetSaveFormat::BuildFaceCells(*Planet->Grid, FaceCells, CellFaces);
+	Chunks.Init(FPlanetSaveBlob(), FPlanetSaveFormat::ChunkCount);
+	DirtyChunks.Init(true, FPlanetSaveFormat::ChunkCount);
+	SavingChunks.Init(false, FPlanetSaveFormat::ChunkCount);
+	LoadedFaces.Init(true, FPlanetSaveFormat::FaceCount);
+	RequestedFaces.Init(false, FPlanetSaveFormat::FaceCount);
+	return true;
+}
+
+void UPlanetSaveComponent::HandleLayersChanged(const FPlanetChangeSet& changes)
+{
+	if (bApplyingLoad || !EnsureFaces())
+	{
+		return;
+	}
+
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		const EPlanetDataLayer layer = static_cast<EPlanetDataLayer>(layerIdx);
+		const FPlanetLayerChanges& layerChanges = changes.Get(layer);
+
+		if (layerChanges.bAllCells)
+		{
+			for (int32 faceIndex = 0; faceIndex < FPlanetSaveFormat::FaceCount; ++faceIndex)
+			{
+				DirtyChunks[FPlanetSaveFormat::GetChunkIndex(layer, faceIndex)] = true;
+			}
+			continue;
+		}
+
+		for (int32 cellId : layerChanges.CellIds)
+		{
+			if (CellFaces.IsValidIndex(cellId))
+			{
+				DirtyChunks[FPlanetSaveFormat::GetChunkIndex(layer, CellFaces[cellId])] = true;
+			}
+		}
+	}
+}
+
+bool UPlanetSaveComponent::SaveAsync()
+{
+	if (IsSaving() || OpenTask.IsValid() || !EnsureFaces())
+	{
+		return false;
+	}
+
+	// Pending edits are part of this save
+	Planet->FlushChanges();
+
+	FPlanetSaveContent content;
+	content.CellCount = Planet->GetCellCount();
+	content.Metadata.Capture(*Planet);
+	content.Chunks = Chunks;
+
+	TArray<int32> chunkIndices;
+	TArray<TArray<uint32>> chunkWords;
+	bool bSkippedUnloadedFaces = false;
+	for (TConstSetBitIterator<> It(DirtyChunks); It; ++It)
+	{
+		const int32 chunkIndex = It.GetIndex();
+		const int32 faceIndex = chunkIndex % FPlanetSaveFormat::FaceCount;
+		if (!LoadedFaces[faceIndex])
+		{
+			bSkippedUnloadedFaces = true;
+			continue;
+		}
+
+		chunkIndices.Add(chunkIndex);
+		FPlanetSaveFormat::GatherChunk(*Planet, static_cast<EPlanetDataLayer>(chunkIndex / FPlanetSaveFormat::FaceCount),
+			FaceCells[faceIndex], chunkWords.AddDefaulted_GetRef());
+	}
+
+	if (bSkippedUnloadedFaces)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetSaveComponent::SaveAsync - Cells of faces that are not loaded were edited, these edits are not saved."));
+	}
+
+	SavingChunks.Init(false, FPlanetSaveFormat::ChunkCount);
+	for (int32 chunkIndex : chunkIndices)
+	{
+		DirtyChunks[chunkIndex] = false;
+		SavingChunks[chunkIndex] = true;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("UPlanetSaveComponent::SaveAsync - Saving %s, %d of %d chunks changed."),
+		*GetSavePath(), chunkIndices.Num(), FPlanetSaveFormat::ChunkCount);
+
+	SaveTask = Async(EAsyncExecution::ThreadPool,
+		[path = GetSavePath(), content = MoveTemp(content), chunkIndices = MoveTemp(chunkIndices), chunkWords = MoveTemp(chunkWords)]() mutable
+		{
+			FSaveResult result;
+			result.Chunks.SetNum(FPlanetSaveFormat::ChunkCount);
+
+			ParallelFor(chunkIndices.Num(), [&](int32 i)
+				{
+					result.Chunks[chunkIndices[i]] = FPlanetSaveFormat::CompressChunk(chunkWords[i]);
+				});
+
+			for (int32 chunkIndex : chunkIndices)
+			{
+				if (!result.Chunks[chunkIndex])
+				{
+					UE_LOG(LogTemp, Error, TEXT("UPlanetSaveComponent - Chunk %d could not be compressed."), chunkIndex);
+					return result;
+				}
+				content.Chunks[chunkIndex] = result.Chunks[chunkIndex];
+			}
+
+			result.bSuccess = FPlanetSaveFormat::WriteFile(path, content);
+			return result;
+		});
+
+	return true;
+}
+
+void UPlanetSaveComponent::CompleteSave()
+{
+	FSaveResult result = SaveTask.Consume();
+
+	if (result.bSuccess && Chunks.Num() == result.Chunks.Num())
+	{
+		for (int32 chunkIndex = 0; chunkIndex < result.Chunks.Num(); ++chunkIndex)
+		{
+			if (result.Chunks[chunkIndex])
+			{
+				Chunks[chunkIndex] = MoveTemp(result.Chunks[chunkIndex]);
+			}
+		}
+	}
+	else
+	{
+		// Saved again next time
+		for (TConstSetBitIterator<> It(SavingChunks); It; ++It)
+		{
+			if (DirtyChunks.IsValidIndex(It.GetIndex()))
+			{
+				DirtyChunks[It.GetIndex()] = true;
+			}
+		}
+	}
+
+	SavingChunks.Init(false, FPlanetSaveFormat::ChunkCount);
+	OnSaveFinished.Broadcast(result.bSuccess);
+}
+
+bool UPlanetSaveComponent::LoadAsync()
+{
+	if (IsSaving() || IsLoading())
+	{
+		return false;
+	}
+
+	OpenTask = Async(EAsyncExecution::ThreadPool, [path = GetSavePath()]()
+		{
+			FOpenResult result;
+			result.bSuccess = FPlanetSaveFormat::ReadFile(path, result.Content);
+			return result;
+		});
+	return true;
+}
+
+void UPlanetSaveComponent::CompleteOpen()
+{
+	FOpenResult result = OpenTask.Consume();
+
+	// Faces requested while the file was read wait for it, release them so they can be requested again
+	auto abandonOpen = [this]()
+		{
+			RequestedFaces.Init(false, FPlanetSaveFormat::FaceCount);
+		};
+
+	if (!result.bSuccess)
+	{
+		abandonOpen();
+		return;
+	}
+
+	if (!Planet || !Planet->Grid || Planet->GetCellCount() != result.Content.CellCount)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetSaveComponent::CompleteOpen - The save has %d cells, the planet grid has %d."),
+			result.Content.CellCount, Planet ? Planet->GetCellCount() : 0);
+		abandonOpen();
+		return;
+	}
+
+	// Reset the planet, faces are written to it when loaded
+	Planet->FlushChanges();
+	bApplyingLoad = true;
+	Planet->InitializeDataLayers();
+	result.Content.Metadata.Apply(*Planet);
+	Planet->FlushChanges();
+	bApplyingLoad = false;
+
+	const TBitArray<> requestedFaces = RequestedFaces;
+	EnsureFaces();
+	Chunks = MoveTemp(result.Content.Chunks);
+	DirtyChunks.Init(false, FPlanetSaveFormat::ChunkCount);
+	LoadedFaces.Init(false, FPlanetSaveFormat::FaceCount);
+	RequestedFaces.Init(false, FPlanetSaveFormat::FaceCount);
+
+	for (int32 faceIndex = 0; faceIndex < FPlanetSaveFormat::FaceCount; ++faceIndex)
+	{
+		const bool bRequested = requestedFaces.IsValidIndex(faceIndex) && requestedFaces[faceIndex];
+		if (!bLazyLoad || bRequested)
+		{
+			RequestedFaces[faceIndex] = true;
+			LaunchFaceDecode(faceIndex);
+		}
+	}
+}
+
+void UPlanetSaveComponent::LaunchFaceDecode(int32 faceIndex)
+{
+	TArray<FPlanetSaveBlob> faceChunks;
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		faceChunks.Add(Chunks[FPlanetSaveFormat::GetChunkIndex(static_cast<EPlanetDataLayer>(layerIdx), faceIndex)]);
+	}
+
+	PendingFaces.Add(Async(EAsyncExecution::ThreadPool, [faceIndex, faceChunks = MoveTemp(faceChunks), wordCount = FaceCells[faceIndex].Num()]()
+		{
+			return DecodeFace(faceIndex, faceChunks, wordCount);
+		}));
+}
+
+UPlanetSaveComponent::FDecodedFace UPlanetSaveComponent::DecodeFace(int32 faceIndex, const TArray<FPlanetSaveBlob>& chunks, int32 wordCount)
+{
+	FDecodedFace face;
+	face.FaceIndex = faceIndex;
+	face.bSuccess = true;
+
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		// Layers missing from the save keep their default values
+		if (chunks[layerIdx] && !FPlanetSaveFormat::DecompressChunk(*chunks[layerIdx], wordCount, face.Layers[layerIdx]))
+		{
+			face.Layers[layerIdx].Reset();
+			face.bSuccess = false;
+		}
+	}
+	return face;
+}
+
+void UPlanetSaveComponent::ApplyFace(const FDecodedFace& face)
+{
+	if (!EnsureFaces() || !LoadedFaces.IsValidIndex(face.FaceIndex) || LoadedFaces[face.FaceIndex])
+	{
+		return;
+	}
+
+	if (!face.bSuccess)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlanetSaveComponent::ApplyFace - Some layers of face %d could not be decompressed."), face.FaceIndex);
+	}
+
+	const TArray<int32>& cellIds = FaceCells[face.FaceIndex];
+
+	Planet->FlushChanges();
+	bApplyingLoad = true;
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		if (face.Layers[layerIdx].Num() == cellIds.Num() && cellIds.Num() > 0)
+		{
+			FPlanetSaveFormat::ScatterChunk(*Planet, static_cast<EPlanetDataLayer>(layerIdx), cellIds, face.Layers[layerIdx]);
+		}
+	}
+	Planet->FlushChanges();
+	bApplyingLoad = false;
+
+	LoadedFaces[face.FaceIndex] = true;
+	RequestedFaces[face.FaceIndex] = false;
+	OnFaceLoaded.Broadcast(face.FaceIndex);
+}
+
+void UPlanetSaveComponent::CompleteFaces()
+{
+	for (int32 i = 0; i < PendingFaces.Num();)
+	{
+		if (PendingFaces[i].IsReady())
+		{
+			ApplyFace(PendingFaces[i].Consume());
+			PendingFaces.RemoveAt(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void UPlanetSaveComponent::RequestFaces(const TArray<int32>& FaceIndices)
+{
+	if (!EnsureFaces())
+	{
+		return;
+	}
+
+	for (int32 faceIndex : FaceIndices)
+	{
+		if (!LoadedFaces.IsValidIndex(faceIndex) || LoadedFaces[faceIndex] || RequestedFaces[faceIndex])
+		{
+			continue;
+		}
+
+		// Faces requested while the file is read are decoded once it is
+		RequestedFaces[faceIndex] = true;
+		if (!OpenTask.IsValid())
+		{
+			LaunchFaceDecode(faceIndex);
+		}
+	}
+}
+
+void UPlanetSaveComponent::RequestCells(const TArray<int32>& CellIds)
+{
+	if (!EnsureFaces())
+	{
+		return;
+	}
+
+	TArray<int32> faceIndices;
+	for (int32 cellId : CellIds)
+	{
+		if (CellFaces.IsValidIndex(cellId))
+		{
+			faceIndices.AddUnique(CellFaces[cellId]);
+		}
+	}
+	RequestFaces(faceIndices);
+}
+
+void UPlanetSaveComponent::LoadFacesNow(const TArray<int32>& FaceIndices)
+{
+	if (OpenTask.IsValid())
+	{
+		OpenTask.Wait();
+		CompleteOpen();
+	}
+
+	if (!EnsureFaces())
+	{
+		return;
+	}
+
+	for (int32 faceIndex : FaceIndices)
+	{
+		if (!LoadedFaces.IsValidIndex(faceIndex) || LoadedFaces[faceIndex])
+		{
+			continue;
+		}
+
+		TArray<FPlanetSaveBlob> faceChunks;
+		for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+		{
+			faceChunks.Add(Chunks[FPlanetSaveFormat::GetChunkIndex(static_cast<EPlanetDataLayer>(layerIdx), faceIndex)]);
+		}
+		ApplyFace(DecodeFace(faceIndex, faceChunks, FaceCells[faceIndex].Num()));
+	}
+}
+
+bool UPlanetSaveComponent::IsFaceLoaded(int32 FaceIndex) const
+{
+	return LoadedFaces.IsValidIndex(FaceIndex) && LoadedFaces[FaceIndex];
+}
+
+void UPlanetSaveComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (SaveTask.IsValid() && SaveTask.IsReady())
+	{
+		CompleteSave();
+	}
+
+	if (OpenTask.IsValid() && OpenTask.IsReady())
+	{
+		CompleteOpen();
+	}
+
+	CompleteFaces();
+
+	if (AutosaveInterval > 0.0f)
+	{
+		AutosaveTimer += DeltaTime;
+		if (AutosaveTimer >= AutosaveInterval && !IsSaving() && !IsLoading())
+		{
+			AutosaveTimer = 0.0f;
+			SaveAsync();
+		}
+	}
+}
@@ -0,0 +1,253 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "PlanetDataLayer.h"
+#include "PlanetTectonics.h"
+#include "Async/Future.h"
+#include "PlanetSave.generated.h"
+
+class UPlanetData;
+class UHexGridAsset;
+struct FPlanetChangeSet;
+
+/** Broadcast when a save finishes, on the game thread */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlanetSaveFinished, bool /* bSuccess */);
+
+/** Broadcast when a saved face has been written to the planet, on the game thread */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlanetFaceLoaded, int32 /* FaceIndex */);
+
+/// <summary>
+/// Planet state stored outside the layers, small and saved whole every time
+/// </summary>
+struct GALAXY_API FPlanetSaveMetadata
+{
+	int32 WaterLevel = 0;
+	float PlanetRadius = 0.0f;
+	TArray<FString> BiomePalette;
+	TArray<FTectonicPlate> TectonicPlates;
+
+	void Capture(const UPlanetData& planet);
+
+	/// <summary>
+	/// Restore the metadata, biome assets that are not loaded yet are loaded synchronously
+	/// </summary>
+	void Apply(UPlanetData& planet) const;
+
+	friend FArchive& operator<<(FArchive& Ar, FPlanetSaveMetadata& metadata);
+};
+
+/// <summary>
+/// Compressed chunk shared between the chunk store and the save / load workers, immutable
+/// </summary>
+using FPlanetSaveBlob = TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>;
+
+/// <summary>
+/// Content of a planet save file
+/// </summary>
+struct GALAXY_API FPlanetSaveContent
+{
+	int32 CellCount = 0;
+	FPlanetSaveMetadata Metadata;
+
+	/// <summary>
+	/// One compressed chunk per layer and face (FPlanetSaveFormat::GetChunkIndex), null when not saved
+	/// </summary>
+	TArray<FPlanetSaveBlob> Chunks;
+};
+
+/// <summary>
+/// Save file format: a header, the metadata, a table of chunk sizes, then the chunks.
+///
+/// Every layer is split in one chunk per icosahedron face (FHexCell::IcosaheronFaceIndex), holding the
+/// values of the face cells in cell id order. Integer layers are stored as differences between
+/// consecutive cells and float layers as their bits, both split into byte planes so the compressor sees
+/// long runs of similar bytes. Chunks are compressed independently, so unchanged chunks are reused as is
+/// and each chunk can be decompressed on its own.
+/// </summary>
+class GALAXY_API FPlanetSaveFormat
+{
+public:
+	static constexpr uint32 Magic = 0x504C4E54;
+	static constexpr int32 Version = 1;
+	static constexpr int32 FaceCount = 20;
+	static constexpr int32 ChunkCount = PlanetDataLayerCount * FaceCount;
+
+	static int32 GetChunkIndex(EPlanetDataLayer layer, int32 faceIndex) { return static_cast<int32>(layer) * FaceCount + faceIndex; }
+
+	/// <summary>
+	/// Cells of every face in increasing order, and the face of every cell
+	/// </summary>
+	static void BuildFaceCells(const UHexGridAsset& grid, TArray<TArray<int32>>& outFaceCells, TArray<uint8>& outCellFaces);
+
+	/// <summary>
+	/// Layer values of the cells as chunk words, game thread
+	/// </summary>
+	static void GatherChunk(const UPlanetData& planet, EPlanetDataLayer layer, TConstArrayView<int32> cellIds, TArray<uint32>& outWords);
+
+	/// <summary>
+	/// Write chunk words back to the layer, game thread
+	/// </summary>
+	static void ScatterChunk(UPlanetData& planet, EPlanetDataLayer layer, TConstArrayView<int32> cellIds, TConstArrayView<uint32> words);
+
+	/// <summary>
+	/// Compress / decompress chunk words, thread-safe
+	/// </summary>
+	static FPlanetSaveBlob CompressChunk(TConstArrayView<uint32> words);
+	static bool DecompressChunk(const TArray<uint8>& blob, int32 wordCount, TArray<uint32>& outWords);
+
+	/// <summary>
+	/// Write a whole file through a temporary file, thread-safe
+	/// </summary>
+	static bool WriteFile(const FString& path, FPlanetSaveContent& content);
+
+	/// <summary>
+	/// Read a whole file, chunks stay compressed. Thread-safe
+	/// </summary>
+	static bool ReadFile(const FString& path, FPlanetSaveContent& outContent);
+};
+
+/**
+ * Saves and loads the planet on the same actor in the background.
+ *
+ * The component keeps the compressed chunks of the last save or load. Saving gathers the layer values
+ * of the chunks changed since (tracked per face from UPlanetData::OnLayersChanged) on the game thread,
+ * then compresses them in parallel and writes the file on a worker, so an autosave costs about the
+ * changed faces. Loading reads the file on a worker and resets the planet; faces are then decompressed
+ * on workers and written to the planet when requested (RequestFaces), or all at once without bLazyLoad.
+ * Load the faces of cells before editing them: edits to faces that are not loaded yet are not saved.
+ */
+UCLASS(classGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GALAXY_API UPlanetSaveComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPlanetSaveComponent();
+
+	/** Planet to save, the owner's UPlanetData when not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Save")
+	TObjectPtr<UPlanetData> Planet;
+
+	/** File name in Saved/Planets */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Save")
+	FString SaveName = TEXT("Planet");
+
+	/** Seconds between autosaves, 0 disables autosave */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Save", meta = (ClampMin = "0"))
+	float AutosaveInterval = 300.0f;
+
+	/** Load the save (if any) when play begins */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Save")
+	bool bLoadOnBeginPlay = false;
+
+	/** Only load faces when requested, otherwise every face is loaded after the file is read */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planet Save")
+	bool bLazyLoad = true;
+
+	/** Start saving in the background, false if a save or load is already in progress */
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	bool SaveAsync();
+
+	/** Start reading the save in the background, false if a save or load is already in progress */
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	bool LoadAsync();
+
+	/** Decompress faces in the background, they are written to the planet on a later frame */
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	void RequestFaces(const TArray<int32>& FaceIndices);
+
+	/** Request the faces of these cells */
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	void RequestCells(const TArray<int32>& CellIds);
+
+	/** Load faces right away, on the game thread */
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	void LoadFacesNow(const TArray<int32>& FaceIndices);
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	bool IsFaceLoaded(int32 FaceIndex) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	bool IsSaving() const { return SaveTask.IsValid(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	bool IsLoading() const { return OpenTask.IsValid() || PendingFaces.Num() > 0; }
+
+	UFUNCTION(BlueprintCallable, Category = "Planet Save")
+	FString GetSavePath() const;
+
+	FOnPlanetSaveFinished OnSaveFinished;
+	FOnPlanetFaceLoaded OnFaceLoaded;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	struct FSaveResult
+	{
+		bool bSuccess = false;
+
+		/** New chunks indexed by chunk, null for the reused ones */
+		TArray<FPlanetSaveBlob> Chunks;
+	};
+
+	struct FOpenResult
+	{
+		bool bSuccess = false;
+		FPlanetSaveContent Content;
+	};
+
+	struct FDecodedFace
+	{
+		int32 FaceIndex = INDEX_NONE;
+		bool bSuccess = false;
+		TStaticArray<TArray<uint32>, PlanetDataLayerCount> Layers;
+	};
+
+	/** Build the face tables for the planet grid, false if the planet is not ready */
+	bool EnsureFaces();
+
+	void HandleLayersChanged(const FPlanetChangeSet& changes);
+
+	/** Decompress a face from the chunk store, thread-safe */
+	static FDecodedFace DecodeFace(int32 faceIndex, const TArray<FPlanetSaveBlob>& chunks, int32 wordCount);
+
+	/** Write a decoded face to the planet without marking its chunks dirty */
+	void ApplyFace(const FDecodedFace& face);
+
+	void LaunchFaceDecode(int32 faceIndex);
+
+	void CompleteSave();
+	void CompleteOpen();
+	void CompleteFaces();
+
+	/** Last saved or loaded compressed chunks */
+	TArray<FPlanetSaveBlob> Chunks;
+
+	/** Chunks changed since they were last compressed */
+	TBitArray<> DirtyChunks;
+
+	/** Chunks being saved, marked dirty again if the save fails */
+	TBitArray<> SavingChunks;
+
+	TBitArray<> LoadedFaces;
+	TBitArray<> RequestedFaces;
+
+	TArray<TArray<int32>> FaceCells;
+	TArray<uint8> CellFaces;
+
+	TFuture<FSaveResult> SaveTask;
+	TFuture<FOpenResult> OpenTask;
+	TArray<TFuture<FDecodedFace>> PendingFaces;
+
+	FDelegateHandle LayersChangedHandle;
+	float AutosaveTimer = 0.0f;
+
+	/** Set while the component writes to the planet, changes are not dirtying chunks */
+	bool bApplyingLoad = false;
+};
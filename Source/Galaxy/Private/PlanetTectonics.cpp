@@ -0,0 +1,253 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetTectonics.h"
+#include "HexGridAsset.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+namespace
+{
+	/// <summary>
+	/// Stateless per-cell random number, the same inputs always give the same value on every thread
+	/// </summary>
+	uint32 HashCell(uint32 seed, uint32 a, uint32 b)
+	{
+		uint64 x = (static_cast<uint64>(seed) << 32) ^ (static_cast<uint64>(a) * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64>(b) * 0xC2B2AE3D27D4EB4Full);
+		x ^= x >> 33;
+		x *= 0xFF51AFD7ED558CCDull;
+		x ^= x >> 33;
+		x *= 0xC4CEB9FE1A85EC53ull;
+		x ^= x >> 33;
+		return static_cast<uint32>(x);
+	}
+
+	float HashToUnit(uint32 hash)
+	{
+		return static_cast<float>(hash >> 8) * (1.0f / 16777216.0f);
+	}
+
+	/// <summary>
+	/// Synchronous multi-source flood fill from cells already labeled.
+	/// Every round, frontier cells that expand claim their unlabeled neighbors, the claim with the lowest
+	/// (priority, label) wins. Cells that do not expand stay in the frontier.
+	/// The labels and rounds only depend on the inputs, never on thread scheduling.
+	/// </summary>
+	void ParallelFlood(const UHexGridAsset& grid, TArray<int32>& labels, TArray<int32>* outRounds, TConstArrayView<int32> seedCellIds, int32 maxRounds,
+		TFunctionRef<bool(int32 /* CellId */, int32 /* Round */)> shouldExpand,
+		TFunctionRef<uint32(int32 /* CellId */, int32 /* Label */)> getPriority)
+	{
+		const int32 cellCount = grid.Cells.Num();
+
+		TArray<std::atomic<uint64>> claims;
+		claims.SetNum(cellCount);
+		ParallelFor(cellCount, [&](int32 cellId)
+			{
+				claims[cellId].store(MAX_uint64, std::memory_order_relaxed);
+			});
+
+		TArray<int32> frontier(seedCellIds);
+		TArray<int32> nextFrontier;
+		TArray<int32> claimed;
+		nextFrontier.SetNumUninitialized(cellCount);
+		claimed.SetNumUninitialized(cellCount);
+
+		for (int32 round = 1; frontier.Num() > 0 && round <= maxRounds; ++round)
+		{
+			std::atomic<int32> nextCount = 0;
+			std::atomic<int32> claimedCount = 0;
+
+			ParallelFor(frontier.Num(), [&](int32 frontierIdx)
+				{
+					const int32 cellId = frontier[frontierIdx];
+					const int32 label = labels[cellId];
+					const bool bExpand = shouldExpand(cellId, round);
+					bool bHasFreeNeighbor = false;
+
+					for (uint32 neighborId : grid.GetNeighborView(cellId))
+					{
+						if (labels[neighborId] != INDEX_NONE)
+						{
+							continue;
+						}
+
+						bHasFreeNeighbor = true;
+						if (!bExpand)
+						{
+							continue;
+						}
+
+						const uint64 key = (static_cast<uint64>(getPriority(neighborId, label)) << 32) | static_cast<uint32>(label);
+						uint64 current = claims[neighborId].load(std::memory_order_relaxed);
+						const bool bFirstClaim = current == MAX_uint64;
+						while (key < current && !claims[neighborId].compare_exchange_weak(current, key, std::memory_order_relaxed))
+						{
+						}
+
+						// Only the thread that moved the cell away from MAX_uint64 lists it
+						if (bFirstClaim && current == MAX_uint64)
+						{
+							claimed[claimedCount.fetch_add(1, std::memory_order_relaxed)] = neighborId;
+						}
+					}
+
+					if (bHasFreeNeighbor && !bExpand)
+					{
+						nextFrontier[nextCount.fetch_add(1, std::memory_order_relaxed)] = cellId;
+					}
+				});
+
+			const int32 newCount = claimedCount.load();
+			ParallelFor(newCount, [&](int32 claimedIdx)
+				{
+					const int32 cellId = claimed[claimedIdx];
+					labels[cellId] = static_cast<int32>(static_cast<uint32>(claims[cellId].load(std::memory_order_relaxed)));
+					if (outRounds)
+					{
+						(*outRounds)[cellId] = round;
+					}
+					nextFrontier[nextCount.fetch_add(1, std::memory_order_relaxed)] = cellId;
+				});
+
+			frontier = TArray<int32>(nextFrontier.GetData(), nextCount.load());
+		}
+	}
+}
+
+bool FPlanetTectonicsGenerator::Generate(const UHexGridAsset& grid, const FPlanetTectonicsSettings& settings,
+	TArray<int32>& outPlateIds, TArray<int32>& outElevations, TArray<FTectonicPlate>& outPlates)
+{
+	const int32 cellCount = grid.Cells.Num();
+	outPlates.Reset();
+	outPlateIds.Init(INDEX_NONE, cellCount);
+	outElevations.Init(0, cellCount);
+
+	if (cellCount == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetTectonicsGenerator::Generate - Grid has no cells."));
+		return false;
+	}
+
+	const uint32 seed = static_cast<uint32>(settings.Seed);
+	FRandomStream random(settings.Seed);
+
+	// Plates, drawn sequentially so they only depend on the seed
+	const int32 plateCount = FMath::Clamp(settings.PlateCount, 1, cellCount);
+	TArray<float> growthRates;
+	TArray<int32> seedCellIds;
+	while (outPlates.Num() < plateCount)
+	{
+		const int32 cellId = random.RandHelper(cellCount);
+		if (outPlateIds[cellId] != INDEX_NONE)
+		{
+			continue;
+		}
+
+		FTectonicPlate& plate = outPlates.AddDefaulted_GetRef();
+		plate.SeedCellId = cellId;
+		plate.bContinental = random.FRand() < settings.ContinentalRatio;
+		plate.EulerPole = random.GetUnitVector();
+		plate.AngularSpeed = random.FRandRange(0.2f, 1.0f);
+		growthRates.Add(random.FRandRange(FMath::Clamp(settings.MinGrowthRate, 0.05f, 1.0f), 1.0f));
+
+		outPlateIds[cellId] = outPlates.Num() - 1;
+		seedCellIds.Add(cellId);
+	}
+
+	ParallelFlood(grid, outPlateIds, nullptr, seedCellIds, MAX_int32,
+		[&](int32 cellId, int32 round) { return HashToUnit(HashCell(seed, cellId, round)) < growthRates[outPlateIds[cellId]]; },
+		[&](int32 cellId, int32 plateId) { return HashCell(seed ^ 0x5BD1E995u, cellId, plateId); });
+
+	// Uplift of every boundary cell, averaged over its edges with other plates
+	TArray<float> uplift;
+	uplift.SetNumZeroed(cellCount);
+	TArray<int32> boundaryIds;
+	boundaryIds.Init(INDEX_NONE, cellCount);
+
+	ParallelFor(cellCount, [&](int32 cellId)
+		{
+			const FTectonicPlate& plate = outPlates[outPlateIds[cellId]];
+			const FVector position = grid.Cells[cellId].Position.GetSafeNormal();
+			const FVector velocity = plate.GetVelocity(position);
+
+			float total = 0.0f;
+			int32 edgeCount = 0;
+			for (uint32 neighborId : grid.GetNeighborView(cellId))
+			{
+				const int32 otherPlateId = outPlateIds[neighborId];
+				if (otherPlateId == outPlateIds[cellId])
+				{
+					continue;
+				}
+
+				const FTectonicPlate& other = outPlates[otherPlateId];
+				const FVector otherPosition = grid.Cells[neighborId].Position.GetSafeNormal();
+				const FVector direction = (otherPosition - position).GetSafeNormal();
+
+				// Positive when the plates move towards each other, in [-1, 1]
+				const float convergence = 0.5f * static_cast<float>(FVector::DotProduct(velocity - other.GetVelocity(otherPosition), direction));
+
+				float value;
+				if (convergence >= 0.0f)
+				{
+					value = plate.bContinental ? settings.MountainUplift
+						: other.bContinental ? -settings.TrenchDepth
+						: settings.IslandArcUplift;
+					value *= convergence;
+				}
+				else
+				{
+					value = (plate.bContinental ? -settings.RiftDepth : settings.RidgeUplift) * -convergence;
+				}
+
+				total += value;
+				++edgeCount;
+			}
+
+			if (edgeCount > 0)
+			{
+				uplift[cellId] = total / edgeCount;
+				boundaryIds[cellId] = cellId;
+			}
+		});
+
+	TArray<int32> boundarySeeds;
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		if (boundaryIds[cellId] != INDEX_NONE)
+		{
+			boundarySeeds.Add(cellId);
+		}
+	}
+
+	// Nearest boundary within BoundaryWidth, ties go to the lowest boundary cell id
+	const int32 boundaryWidth = FMath::Max(1, settings.BoundaryWidth);
+	TArray<int32> boundaryDistances;
+	boundaryDistances.SetNumZeroed(cellCount);
+	ParallelFlood(grid, boundaryIds, &boundaryDistances, boundarySeeds, boundaryWidth,
+		[](int32, int32) { return true; },
+		[](int32, int32) { return 0u; });
+
+	ParallelFor(cellCount, [&](int32 cellId)
+		{
+			const FTectonicPlate& plate = outPlates[outPlateIds[cellId]];
+			float elevation = plate.bContinental ? settings.ContinentalElevation : settings.OceanicElevation;
+
+			const int32 boundaryId = boundaryIds[cellId];
+			if (boundaryId != INDEX_NONE)
+			{
+				const float falloff = 1.0f - static_cast<float>(boundaryDistances[cellId]) / (boundaryWidth + 1);
+				elevation += uplift[boundaryId] * falloff;
+			}
+
+			elevation += settings.Roughness * (HashToUnit(HashCell(seed ^ 0x27D4EB2Fu, cellId, 0)) - 0.5f);
+			outElevations[cellId] = FMath::RoundToInt32(elevation);
+		});
+
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		++outPlates[outPlateIds[cellId]].CellCount;
+	}
+
+	return true;
+}
@@ -0,0 +1,121 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlanetTectonics.generated.h"
+
+class UHexGridAsset;
+
+/**
+ * Parameters of the plate and elevation generation stage, elevations are in elevation levels
+ */
+USTRUCT(BlueprintType)
+struct GALAXY_API FPlanetTectonicsSettings
+{
+	GENERATED_BODY()
+
+	/** Same seed and settings on the same grid always give the same planet */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics")
+	int32 Seed = 1337;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics", meta = (ClampMin = "1", ClampMax = "256"))
+	int32 PlateCount = 12;
+
+	/** Fraction of the plates that are continental, the others are oceanic */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics", meta = (ClampMin = "0", ClampMax = "1"))
+	float ContinentalRatio = 0.4f;
+
+	/** Slowest plate growth rate, relative to the fastest. Lower values give plates of more varied sizes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics", meta = (ClampMin = "0.05", ClampMax = "1"))
+	float MinGrowthRate = 0.2f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation")
+	float ContinentalElevation = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation")
+	float OceanicElevation = -3.0f;
+
+	/** Uplift of converging continental edges */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation", meta = (ClampMin = "0"))
+	float MountainUplift = 6.0f;
+
+	/** Uplift of converging oceanic plates (island arcs) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation", meta = (ClampMin = "0"))
+	float IslandArcUplift = 4.0f;
+
+	/** Depth of an oceanic edge subducting under a continent */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation", meta = (ClampMin = "0"))
+	float TrenchDepth = 3.0f;
+
+	/** Uplift of diverging oceanic edges (mid-ocean ridges) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation", meta = (ClampMin = "0"))
+	float RidgeUplift = 2.0f;
+
+	/** Depth of diverging continental edges (rift valleys) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation", meta = (ClampMin = "0"))
+	float RiftDepth = 2.0f;
+
+	/** Distance in cells over which boundary effects fade out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation", meta = (ClampMin = "1"))
+	int32 BoundaryWidth = 4;
+
+	/** Amplitude of the per-cell random elevation offset */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tectonics|Elevation", meta = (ClampMin = "0"))
+	float Roughness = 1.0f;
+};
+
+/**
+ * A tectonic plate, rotating around an Euler pole through the planet center
+ */
+USTRUCT(BlueprintType)
+struct GALAXY_API FTectonicPlate
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tectonics")
+	int32 SeedCellId = INDEX_NONE;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tectonics")
+	int32 CellCount = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tectonics")
+	bool bContinental = false;
+
+	/** Rotation axis of the plate motion, unit vector */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tectonics")
+	FVector EulerPole = FVector::UpVector;
+
+	/** Angular speed around the pole, velocities on the unit sphere stay below 1 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tectonics")
+	float AngularSpeed = 0.0f;
+
+	/** Surface velocity of the plate at a point of the unit sphere */
+	FVector GetVelocity(const FVector& position) const { return FVector::CrossProduct(EulerPole, position) * AngularSpeed; }
+};
+
+/// <summary>
+/// Plate and elevation generation stage.
+///
+/// Plates grow from random seed cells with a synchronous parallel flood fill: every round, each frontier
+/// cell expands with its plate's growth probability and claims its free neighbors. Concurrent claims on a
+/// cell are resolved with an atomic min on a hashed priority, so the result only depends on the seed.
+/// Elevation comes from the plate type plus the uplift of the nearest plate boundary, which depends on
+/// the plate types on each side and on how fast the plates converge or diverge there.
+/// </summary>
+class GALAXY_API FPlanetTectonicsGenerator
+{
+public:
+	/// <summary>
+	/// Generate plates and elevations for every cell of a grid
+	/// </summary>
+	/// <param name="grid">Grid to generate on</param>
+	/// <param name="settings">Generation parameters</param>
+	/// <param name="outPlateIds">Plate of every cell</param>
+	/// <param name="outElevations">Unclamped, rounded elevation level of every cell</param>
+	/// <param name="outPlates">Generated plates, indexed by plate id</param>
+	/// <returns>False if the grid is empty</returns>
+	static bool Generate(const UHexGridAsset& grid, const FPlanetTectonicsSettings& settings,
+		TArray<int32>& outPlateIds, TArray<int32>& outElevations, TArray<FTectonicPlate>& outPlates);
+};
@@ -0,0 +1,68 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetTerrainElevation.h"
+#include "HexGridAsset.h"
+#include "PlanetData.h"
+#include "TerrainNoiseSampler.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	/** Cells sampled per ParallelFor task */
+	constexpr int32 CellsPerTask = 128;
+}
+
+FTerrainNoiseParams FPlanetTerrainElevationSettings::ToNoiseParams(float planetRadius) const
+{
+	FTerrainNoiseParams params;
+	params.Frequency = Frequency;
+	params.Amplitude = Amplitude;
+	params.Lacunarity = Lacunarity;
+	params.Persistence = Persistence;
+	params.Octaves = Octaves;
+	params.Radius = TerrainRadius > 0.0f ? TerrainRadius : planetRadius;
+	params.Seed = static_cast<uint32>(Seed);
+	return params;
+}
+
+bool FPlanetTerrainElevationGenerator::Generate(const UHexGridAsset& grid, const FPlanetTerrainElevationSettings& settings,
+	float planetRadius, TArray<int32>& outElevations)
+{
+	const int32 cellCount = grid.Cells.Num();
+	if (cellCount == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlanetTerrainElevationGenerator::Generate - Grid has no cells."));
+		return false;
+	}
+
+	const FTerrainNoiseSampler sampler(settings.ToNoiseParams(planetRadius));
+	const float heightPerLevel = settings.HeightPerLevel > 0.0f
+		? settings.HeightPerLevel
+		: FMath::Max(FMath::Abs(settings.Amplitude), UE_KINDA_SMALL_NUMBER) / UPlanetData::MAX_ELEVATION_LEVEL;
+
+	outElevations.SetNumUninitialized(cellCount);
+
+	ParallelFor(FMath::DivideAndRoundUp(cellCount, CellsPerTask), [&](int32 taskIdx)
+		{
+			const int32 end = FMath::Min(cellCount, (taskIdx + 1) * CellsPerTask);
+			for (int32 cellId = taskIdx * CellsPerTask; cellId < end; ++cellId)
+			{
+				const FHexCell& cell = grid.Cells[cellId];
+
+				float height = sampler.SampleHeight(FVector3f(cell.Position));
+				if (settings.bAverageCorners && cell.Vertices.Num() > 0)
+				{
+					for (const FVector& vertex : cell.Vertices)
+					{
+						height += sampler.SampleHeight(FVector3f(vertex));
+					}
+					height /= cell.Vertices.Num() + 1;
+				}
+
+				outElevations[cellId] = FMath::RoundToInt32(height / heightPerLevel);
+			}
+		});
+
+	return true;
+}
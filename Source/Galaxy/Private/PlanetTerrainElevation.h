@@ -0,0 +1,74 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainNoiseDispatcher.h"
+#include "PlanetTerrainElevation.generated.h"
+
+class UHexGridAsset;
+
+/**
+ * Terrain noise to sample into the elevation layer, same meaning as FTerrainNoiseParams so a planet
+ * configured like its rendered terrain gets matching elevations
+ */
+USTRUCT(BlueprintType)
+struct GALAXY_API FPlanetTerrainElevationSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Noise")
+	int32 Seed = 1337;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Noise")
+	float Frequency = 1.5f;
+
+	/** Height of the terrain noise, in world units */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Noise")
+	float Amplitude = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Noise")
+	float Lacunarity = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Noise")
+	float Persistence = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Noise", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 Octaves = 6;
+
+	/** Radius of the rendered terrain, the noise depends on it. 0 uses the planet radius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Noise", meta = (ClampMin = "0"))
+	float TerrainRadius = 0.0f;
+
+	/** Average the height over the cell corners and center instead of only sampling the center */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elevation")
+	bool bAverageCorners = false;
+
+	/** World height of one elevation level. 0 spreads the levels over Amplitude */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Elevation", meta = (ClampMin = "0"))
+	float HeightPerLevel = 0.0f;
+
+	FTerrainNoiseParams ToNoiseParams(float planetRadius) const;
+};
+
+/// <summary>
+/// Samples the terrain noise rendered by the GPU (FTerrainNoiseSampler) at the grid cells, on the CPU.
+///
+/// Cell centers (and corners when averaging) are projected on the terrain sphere and evaluated in
+/// parallel with the base LOD octaves, then heights are quantized to elevation levels.
+/// </summary>
+class GALAXY_API FPlanetTerrainElevationGenerator
+{
+public:
+	/// <summary>
+	/// Sample the terrain height of every cell of a grid
+	/// </summary>
+	/// <param name="grid">Grid to sample</param>
+	/// <param name="settings">Noise and quantization parameters</param>
+	/// <param name="planetRadius">Radius used when the settings have no terrain radius</param>
+	/// <param name="outElevations">Unclamped, rounded elevation level of every cell</param>
+	/// <returns>False if the grid is empty</returns>
+	static bool Generate(const UHexGridAsset& grid, const FPlanetTerrainElevationSettings& settings,
+		float planetRadius, TArray<int32>& outElevations);
+};
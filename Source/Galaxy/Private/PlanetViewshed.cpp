@@ -0,0 +1,129 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "PlanetViewshed.h"
+#include "PlanetData.h"
+#include "HexGridAsset.h"
+#include "HexGridIterators.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+
+void FPlanetViewshed::Compute(const UPlanetData& planet, int32 observerCellId, const FPlanetViewshedSettings& settings, TArray<int32>& outVisibleCells)
+{
+	using FWalker = THexRingWalker<MaxRadius>;
+
+	outVisibleCells.Reset();
+
+	if (!planet.Grid || !planet.AreDataLayersInitialized() || !planet.Grid->Cells.IsValidIndex(observerCellId))
+	{
+		return;
+	}
+
+	const UHexGridAsset& grid = *planet.Grid;
+	const FHexGridRuntimePtr gridRuntime = grid.GetRuntime();
+	const TConstArrayView<FVector> positions = gridRuntime->GetPositions();
+	const int32 radius = settings.MaxRadius > 0 ? FMath::Min(settings.MaxRadius, MaxRadius) : MaxRadius;
+	const double sphereRadius = planet.PlanetRadius > 0.0f ? planet.PlanetRadius : 1.0;
+
+	auto getSurfacePoint = [&](int32 cellId, float height)
+		{
+			const double elevation = planet.ElevationLayer.Get(cellId) + height;
+			return positions[cellId] * (sphereRadius + elevation * settings.HeightPerLevel);
+		};
+
+	const FVector& up = positions[observerCellId];
+	const FVector eye = getSurfacePoint(observerCellId, settings.ObserverHeight);
+
+	// Slope of the line from the eye to a point, against the observer horizontal plane
+	auto getSlope = [&](const FVector& point)
+		{
+			const FVector delta = point - eye;
+			const double vertical = FVector::DotProduct(delta, up);
+			const double horizontal = (delta - up * vertical).Size();
+			return static_cast<float>(vertical / FMath::Max(horizontal, UE_DOUBLE_KINDA_SMALL_NUMBER));
+		};
+
+	outVisibleCells.Add(observerCellId);
+
+	// Horizon buffer of the previous ring, aligned with the ring (sorted by cell id)
+	FWalker::FRing previousRing;
+	TArray<float, TFixedAllocator<FWalker::MaxRingSize>> previousHorizons;
+	TArray<float, TFixedAllocator<FWalker::MaxRingSize>> horizons;
+	previousRing.Add(observerCellId);
+	previousHorizons.Add(-MAX_flt);
+
+	FWalker walker(grid, observerCellId);
+	while (walker.GetRadius() < radius && walker.Advance())
+	{
+		const FWalker::FRing& ring = walker.GetRing();
+		horizons.SetNumUninitialized(ring.Num());
+
+		for (int32 ringIdx = 0; ringIdx < ring.Num(); ++ringIdx)
+		{
+			const int32 cellId = ring[ringIdx];
+			const FVector& direction = positions[cellId];
+
+			// Plane of the great-circle ray from the observer through the cell
+			const FVector rayNormal = FVector::CrossProduct(up, direction).GetSafeNormal();
+
+			// The two cells of the previous ring closest to the ray
+			double bestDistances[2] = { MAX_dbl, MAX_dbl };
+			float bestHorizons[2] = { -MAX_flt, -MAX_flt };
+			for (uint32 neighborId : gridRuntime->GetNeighbors(cellId))
+			{
+				const int32 previousIdx = Algo::BinarySearch(previousRing, static_cast<int32>(neighborId));
+				if (previousIdx == INDEX_NONE)
+				{
+					continue;
+				}
+
+				const double distance = FMath::Abs(FVector::DotProduct(rayNormal, positions[neighborId]));
+				if (distance < bestDistances[0])
+				{
+					bestDistances[1] = bestDistances[0];
+					bestHorizons[1] = bestHorizons[0];
+					bestDistances[0] = distance;
+					bestHorizons[0] = previousHorizons[previousIdx];
+				}
+				else if (distance < bestDistances[1])
+				{
+					bestDistances[1] = distance;
+					bestHorizons[1] = previousHorizons[previousIdx];
+				}
+			}
+
+			float horizon = bestHorizons[0];
+			if (bestDistances[1] < MAX_dbl && bestDistances[0] + bestDistances[1] > UE_DOUBLE_SMALL_NUMBER)
+			{
+				// Closer parent weighs more, both are on the observer side of the cell
+				const double weight = bestDistances[1] / (bestDistances[0] + bestDistances[1]);
+				horizon = static_cast<float>(bestHorizons[0] * weight + bestHorizons[1] * (1.0 - weight));
+			}
+
+			const float groundSlope = getSlope(getSurfacePoint(cellId, 0.0f));
+			const float targetSlope = settings.TargetHeight > 0.0f ? getSlope(getSurfacePoint(cellId, settings.TargetHeight)) : groundSlope;
+			if (targetSlope >= horizon)
+			{
+				outVisibleCells.Add(cellId);
+			}
+
+			horizons[ringIdx] = FMath::Max(horizon, groundSlope);
+		}
+
+		previousRing = ring;
+		Swap(previousHorizons, horizons);
+	}
+
+	outVisibleCells.Sort();
+}
+
+void FPlanetViewshed::ComputeBatch(const UPlanetData& planet, TConstArrayView<int32> observerCellIds, const FPlanetViewshedSettings& settings,
+	TArray<TArray<int32>>& outVisibleCells)
+{
+	outVisibleCells.SetNum(observerCellIds.Num());
+
+	ParallelFor(observerCellIds.Num(), [&](int32 observerIdx)
+		{
+			Compute(planet, observerCellIds[observerIdx], settings, outVisibleCells[observerIdx]);
+		});
+}
@@ -0,0 +1,64 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlanetViewshed.generated.h"
+
+class UPlanetData;
+
+/**
+ * Observer and target heights of a viewshed, heights are in elevation levels
+ */
+USTRUCT(BlueprintType)
+struct GALAXY_API FPlanetViewshedSettings
+{
+	GENERATED_BODY()
+
+	/** Distance in cells beyond which nothing is visible, 0 uses FPlanetViewshed::MaxRadius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Viewshed", meta = (ClampMin = "0", ClampMax = "64"))
+	int32 MaxRadius = 16;
+
+	/** Eye height of the observer above its cell */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Viewshed", meta = (ClampMin = "0"))
+	float ObserverHeight = 0.5f;
+
+	/** Height above a cell that has to be seen for the cell to be visible, 0 is the ground */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Viewshed", meta = (ClampMin = "0"))
+	float TargetHeight = 0.0f;
+
+	/** World height of one elevation level, relative to UPlanetData::PlanetRadius. Sets how much the curvature hides */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Viewshed", meta = (ClampMin = "0"))
+	float HeightPerLevel = 20.0f;
+};
+
+/// <summary>
+/// Cells visible from an observer cell, over the elevation layer and the planet curvature.
+///
+/// The sweep walks the rings around the observer from the inside out, keeping a horizon buffer for the
+/// last ring: the steepest slope from the eye met along the ray to each cell. The horizon of a cell is
+/// interpolated from the two cells of the previous ring closest to the great-circle ray from the
+/// observer, so every cell is tested once instead of walking a line to each of them. Slopes are measured
+/// from the observer local horizontal to points on the sphere, so far cells drop below the horizon.
+/// </summary>
+class GALAXY_API FPlanetViewshed
+{
+public:
+	static constexpr int32 MaxRadius = 64;
+
+	/// <summary>
+	/// Cells visible from a cell, the observer cell included, sorted by cell id. Thread-safe
+	/// </summary>
+	/// <param name="planet">Planet with initialized data layers</param>
+	/// <param name="observerCellId">Cell the observer stands on</param>
+	/// <param name="settings">Radius and heights</param>
+	/// <param name="outVisibleCells">Visible cells, empty for an invalid observer</param>
+	static void Compute(const UPlanetData& planet, int32 observerCellId, const FPlanetViewshedSettings& settings, TArray<int32>& outVisibleCells);
+
+	/// <summary>
+	/// Viewsheds of many observers, computed in parallel
+	/// </summary>
+	static void ComputeBatch(const UPlanetData& planet, TConstArrayView<int32> observerCellIds, const FPlanetViewshedSettings& settings,
+		TArray<TArray<int32>>& outVisibleCells);
+};
@@ -0,0 +1,173 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0.
+// Noncommercial use only. Commercial use requires written permission.
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "Misc/AutomationTest.h"
+#include "PlanetReplication.h"
+#include "PlanetDirtyTracker.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlanetChunkCodecRoundTripTest, "Galaxy.Planet.Replication.ChunkCodecRoundTrip",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPlanetChunkCodecRoundTripTest::RunTest(const FString& Parameters)
+{
+	// Two full chunks and a partial one
+	const int32 chunkSize = FPlanetDirtyTracker::ChunkSize;
+	const int32 cellCount = chunkSize * 2 + chunkSize / 3;
+	const int32 chunkCount = FMath::DivideAndRoundUp(cellCount, chunkSize);
+	const float quantum = 0.05f;
+
+	FRandomStream random(1234);
+	TStaticArray<TArray<int32>, PlanetDataLayerCount> values;
+	for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+	{
+		values[layerIdx].SetNumUninitialized(cellCount);
+		for (int32 cellId = 0; cellId < cellCount; ++cellId)
+		{
+			// Smooth runs with some noise, like terrain
+			values[layerIdx][cellId] = (cellId / 37) % 11 - 5 + (random.FRand() < 0.1f ? random.RandRange(-300, 300) : 0);
+		}
+	}
+
+	// Encode every chunk against what the receiver has, then check it decodes to the sent values
+	FPlanetChunkMirror mirror;
+	TStaticArray<TArray<int32>, PlanetDataLayerCount> sent;
+	auto sendAndCheck = [&](const TCHAR* step) -> bool
+		{
+			TArray<uint8> bytes;
+			for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+			{
+				const EPlanetDataLayer layer = static_cast<EPlanetDataLayer>(layerIdx);
+				for (int32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+				{
+					const int32 firstCellId = chunkIndex * chunkSize;
+					const int32 count = FMath::Min(chunkSize, cellCount - firstCellId);
+					TConstArrayView<int32> chunkValues(values[layerIdx].GetData() + firstCellId, count);
+					TConstArrayView<int32> base;
+					if (sent[layerIdx].Num() > 0)
+					{
+						base = TConstArrayView<int32>(sent[layerIdx].GetData() + firstCellId, count);
+					}
+					FPlanetChunkCodec::Encode(layer, chunkIndex, quantum, chunkValues, base, bytes);
+				}
+				sent[layerIdx] = values[layerIdx];
+			}
+
+			int32 decodedChunks = 0;
+			const bool bDecoded = FPlanetChunkCodec::Decode(bytes, cellCount, mirror,
+				[&](EPlanetDataLayer layer, int32 firstCellId, int32 count, float decodedQuantum)
+				{
+					++decodedChunks;
+					if (FPlanetChunkCodec::IsFloatLayer(layer))
+					{
+						TestEqual(FString::Printf(TEXT("%s: quantum"), step), decodedQuantum, quantum);
+					}
+				});
+
+			TestTrue(FString::Printf(TEXT("%s: payload decodes"), step), bDecoded);
+			for (int32 layerIdx = 0; layerIdx < PlanetDataLayerCount; ++layerIdx)
+			{
+				if (!TestTrue(FString::Printf(TEXT("%s: layer %d round trips"), step, layerIdx), mirror.Values[layerIdx] == values[layerIdx]))
+				{
+					return false;
+				}
+			}
+			return decodedChunks > 0;
+		};
+
+	TestTrue(TEXT("First transfer"), sendAndCheck(TEXT("First transfer")));
+
+	// Sparse edits are sent as deltas against the previous values
+	for (int32 edit = 0; edit < 50; ++edit)
+	{
+		const int32 layerIdx = random.RandRange(0, PlanetDataLayerCount - 1);
+		values[layerIdx][random.RandRange(0, cellCount - 1)] += random.RandRange(-20, 20) | 1;
+	}
+	TestTrue(TEXT("Delta transfer"), sendAndCheck(TEXT("Delta transfer")));
+
+	// Unchanged chunks are not encoded at all
+	TArray<uint8> unchanged;
+	const TConstArrayView<int32> firstChunk(values[0].GetData(), chunkSize);
+	TestFalse(TEXT("Unchanged chunk is skipped"), FPlanetChunkCodec::Encode(static_cast<EPlanetDataLayer>(0), 0, quantum, firstChunk, firstChunk, unchanged));
+	TestEqual(TEXT("Unchanged chunk writes nothing"), unchanged.Num(), 0);
+
+	// Truncated payloads are rejected and leave the mirror values of the broken chunk untouched
+	TArray<uint8> bytes;
+	values[0][0] += 1000;
+	FPlanetChunkCodec::Encode(static_cast<EPlanetDataLayer>(0), 0, quantum, firstChunk, TConstArrayView<int32>(sent[0].GetData(), chunkSize), bytes);
+	bytes.SetNum(bytes.Num() - 1);
+	const TArray<int32> before = mirror.Values[0];
+	TestFalse(TEXT("Truncated payload fails"), FPlanetChunkCodec::Decode(bytes, cellCount, mirror, [](EPlanetDataLayer, int32, int32, float) {}));
+	TestTrue(TEXT("Truncated chunk is not applied"), mirror.Values[0] == before);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlanetChunkCodecResyncTest, "Galaxy.Planet.Replication.ChunkCodecResync",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPlanetChunkCodecResyncTest::RunTest(const FString& Parameters)
+{
+	// One layer is enough, entries of different layers are independent
+	const EPlanetDataLayer layer = static_cast<EPlanetDataLayer>(0);
+	const int32 chunkSize = FPlanetDirtyTracker::ChunkSize;
+	const int32 cellCount = chunkSize * 2;
+	const float quantum = 1.0f;
+
+	TArray<int32> values;
+	values.SetNumUninitialized(cellCount);
+	for (int32 cellId = 0; cellId < cellCount; ++cellId)
+	{
+		values[cellId] = cellId % 17;
+	}
+
+	// What the server believes the client has, like UPlanetReplicationComponent ClientValues
+	TArray<int32> sent;
+	auto encodeAll = [&](bool bAbsolute) -> TArray<uint8>
+		{
+			TArray<uint8> bytes;
+			for (int32 chunkIndex = 0; chunkIndex < cellCount / chunkSize; ++chunkIndex)
+			{
+				TConstArrayView<int32> chunkValues(values.GetData() + chunkIndex * chunkSize, chunkSize);
+				TConstArrayView<int32> base;
+				if (!bAbsolute && sent.Num() > 0)
+				{
+					base = TConstArrayView<int32>(sent.GetData() + chunkIndex * chunkSize, chunkSize);
+				}
+				FPlanetChunkCodec::Encode(layer, chunkIndex, quantum, chunkValues, base, bytes);
+			}
+			sent = values;
+			return bytes;
+		};
+	auto decode = [&](const TArray<uint8>& bytes, FPlanetChunkMirror& mirror)
+		{
+			return FPlanetChunkCodec::Decode(bytes, cellCount, mirror, [](EPlanetDataLayer, int32, int32, float) {});
+		};
+
+	FPlanetChunkMirror mirror;
+	TestTrue(TEXT("First transfer decodes"), decode(encodeAll(false), mirror));
+
+	// A packet the client drops: the server already counts its chunks as sent
+	values[5] += 100;
+	values[chunkSize + 5] += 100;
+	encodeAll(false);
+
+	// Deltas sent after it are against values the client never got
+	values[6] += 1;
+	TestTrue(TEXT("Delta after the drop decodes"), decode(encodeAll(false), mirror));
+	TestFalse(TEXT("Mirror is wrong after a dropped packet"), mirror.Values[0] == values);
+
+	// The resync drops the server state, every chunk is sent again without a base
+	TestTrue(TEXT("Resync decodes"), decode(encodeAll(true), mirror));
+	TestTrue(TEXT("Mirror recovers after the resync"), mirror.Values[0] == values);
+
+	// And deltas are right again from there
+	values[7] -= 3;
+	TestTrue(TEXT("Delta after the resync decodes"), decode(encodeAll(false), mirror));
+	TestTrue(TEXT("Mirror stays in sync"), mirror.Values[0] == values);
+
+	return true;
+}
+
+#endif
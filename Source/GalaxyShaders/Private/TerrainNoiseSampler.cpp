@@ -0,0 +1,217 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0. 
+// Noncommercial use only. Commercial use requires written permission. 
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#include "TerrainNoiseSampler.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// FastNoiseLite.ush constants, integer math wraps like HLSL through uint32
+	constexpr int32 PrimeX = 501125321;
+	constexpr int32 PrimeY = 1136930381;
+	constexpr int32 PrimeZ = 1720413743;
+
+	/** fnlCreateState frequency, the shader never changes it */
+	constexpr float StateFrequency = 0.01f;
+
+	/** Directions sampled per ParallelFor task */
+	constexpr int32 SamplesPerTask = 256;
+
+	const float Gradients3D[] =
+	{
+		0, 1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0,
+		1, 0, 1, 0, -1, 0, 1, 0, 1, 0, -1, 0, -1, 0, -1, 0,
+		1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0, 0,
+		0, 1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0,
+		1, 0, 1, 0, -1, 0, 1, 0, 1, 0, -1, 0, -1, 0, -1, 0,
+		1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0, 0,
+		0, 1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0,
+		1, 0, 1, 0, -1, 0, 1, 0, 1, 0, -1, 0, -1, 0, -1, 0,
+		1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0, 0,
+		0, 1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0,
+		1, 0, 1, 0, -1, 0, 1, 0, 1, 0, -1, 0, -1, 0, -1, 0,
+		1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0, 0,
+		0, 1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0,
+		1, 0, 1, 0, -1, 0, 1, 0, 1, 0, -1, 0, -1, 0, -1, 0,
+		1, 1, 0, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, 0, 0,
+		1, 1, 0, 0, 0, -1, 1, 0, -1, 1, 0, 0, 0, -1, -1, 0
+	};
+
+	FORCEINLINE int32 WrapMul(int32 a, int32 b)
+	{
+		return static_cast<int32>(static_cast<uint32>(a) * static_cast<uint32>(b));
+	}
+
+	FORCEINLINE int32 WrapAdd(int32 a, int32 b)
+	{
+		return static_cast<int32>(static_cast<uint32>(a) + static_cast<uint32>(b));
+	}
+
+	FORCEINLINE int32 FastRound(float f)
+	{
+		return f >= 0 ? static_cast<int32>(f + 0.5f) : static_cast<int32>(f - 0.5f);
+	}
+
+	FORCEINLINE float GradCoord3D(int32 seed, int32 xPrimed, int32 yPrimed, int32 zPrimed, float xd, float yd, float zd)
+	{
+		int32 hash = WrapMul(seed ^ xPrimed ^ yPrimed ^ zPrimed, 0x27d4eb2d);
+		hash ^= hash >> 15;
+		hash &= 63 << 2;
+		return xd * Gradients3D[hash] + yd * Gradients3D[hash | 1] + zd * Gradients3D[hash | 2];
+	}
+
+	/** _fnlSingleOpenSimplex23D, two offset rotated cube grids */
+	float SingleOpenSimplex23D(int32 seed, float x, float y, float z)
+	{
+		int32 i = FastRound(x);
+		int32 j = FastRound(y);
+		int32 k = FastRound(z);
+		float x0 = x - i;
+		float y0 = y - j;
+		float z0 = z - k;
+
+		int32 xNSign = static_cast<int32>(-1.0f - x0) | 1;
+		int32 yNSign = static_cast<int32>(-1.0f - y0) | 1;
+		int32 zNSign = static_cast<int32>(-1.0f - z0) | 1;
+
+		float ax0 = xNSign * -x0;
+		float ay0 = yNSign * -y0;
+		float az0 = zNSign * -z0;
+
+		i = WrapMul(i, PrimeX);
+		j = WrapMul(j, PrimeY);
+		k = WrapMul(k, PrimeZ);
+
+		float value = 0;
+		float a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+
+		for (int32 l = 0;; l++)
+		{
+			if (a > 0)
+			{
+				value += (a * a) * (a * a) * GradCoord3D(seed, i, j, k, x0, y0, z0);
+			}
+
+			float b = a + 1;
+			int32 i1 = i;
+			int32 j1 = j;
+			int32 k1 = k;
+			float x1 = x0;
+			float y1 = y0;
+			float z1 = z0;
+			if (ax0 >= ay0 && ax0 >= az0)
+			{
+				x1 += xNSign;
+				b -= xNSign * 2 * x1;
+				i1 = WrapAdd(i1, -WrapMul(xNSign, PrimeX));
+			}
+			else if (ay0 > ax0 && ay0 >= az0)
+			{
+				y1 += yNSign;
+				b -= yNSign * 2 * y1;
+				j1 = WrapAdd(j1, -WrapMul(yNSign, PrimeY));
+			}
+			else
+			{
+				z1 += zNSign;
+				b -= zNSign * 2 * z1;
+				k1 = WrapAdd(k1, -WrapMul(zNSign, PrimeZ));
+			}
+
+			if (b > 0)
+			{
+				value += (b * b) * (b * b) * GradCoord3D(seed, i1, j1, k1, x1, y1, z1);
+			}
+
+			if (l == 1)
+			{
+				break;
+			}
+
+			ax0 = 0.5f - ax0;
+			ay0 = 0.5f - ay0;
+			az0 = 0.5f - az0;
+
+			x0 = xNSign * ax0;
+			y0 = yNSign * ay0;
+			z0 = zNSign * az0;
+
+			a += (0.75f - ax0) - (ay0 + az0);
+
+			i = WrapAdd(i, (xNSign >> 1) & PrimeX);
+			j = WrapAdd(j, (yNSign >> 1) & PrimeY);
+			k = WrapAdd(k, (zNSign >> 1) & PrimeZ);
+
+			xNSign = -xNSign;
+			yNSign = -yNSign;
+			zNSign = -zNSign;
+
+			seed = ~seed;
+		}
+
+		return value * 32.69428253173828125f;
+	}
+}
+
+FTerrainNoiseSampler::FTerrainNoiseSampler(const FTerrainNoiseParams& InParams)
+	: Params(InParams)
+{
+}
+
+float FTerrainNoiseSampler::GetNoise3D(int32 Seed, float X, float Y, float Z)
+{
+	// _fnlTransformNoiseCoordinate3D: frequency then the OpenSimplex2 rotation (not a skew)
+	X *= StateFrequency;
+	Y *= StateFrequency;
+	Z *= StateFrequency;
+
+	const float R3 = static_cast<float>(2.0 / 3.0);
+	const float r = (X + Y + Z) * R3;
+	return SingleOpenSimplex23D(Seed, r - X, r - Y, r - Z);
+}
+
+float FTerrainNoiseSampler::SampleHeight(const FVector3f& Direction, float ExtraOctaves) const
+{
+	// ComputeWorldPosition: point of the sphere of radius Radius, relative to the planet center
+	const FVector3f worldPos = Direction.GetSafeNormal() * Params.Radius;
+
+	// GetExtraOctaves
+	const float clampedExtraOctaves = FMath::Max(ExtraOctaves, 0.0f);
+	const int32 extraOctaves = FMath::FloorToInt32(clampedExtraOctaves);
+	const float fractionalOctave = clampedExtraOctaves - extraOctaves;
+
+	float sum = 0.0f;
+	float currentAmplitude = 1.0f;
+	float currentFrequency = Params.Frequency;
+	const int32 totalOctaves = Params.Octaves + extraOctaves + 1;
+
+	for (int32 i = 0; i < totalOctaves; ++i)
+	{
+		const float noise3D = GetNoise3D(static_cast<int32>(Params.Seed),
+			worldPos.X * currentFrequency,
+			worldPos.Y * currentFrequency,
+			worldPos.Z * currentFrequency);
+
+		const float octaveWeight = i >= Params.Octaves + extraOctaves ? fractionalOctave : 1.0f;
+
+		sum += currentAmplitude * noise3D * octaveWeight;
+		currentFrequency *= Params.Lacunarity;
+		currentAmplitude *= Params.Persistence;
+	}
+
+	return sum * Params.Amplitude;
+}
+
+void FTerrainNoiseSampler::SampleHeights(TConstArrayView<FVector3f> Directions, TArrayView<float> OutHeights, float ExtraOctaves) const
+{
+	check(Directions.Num() == OutHeights.Num());
+
+	ParallelFor(FMath::DivideAndRoundUp(Directions.Num(), SamplesPerTask), [&](int32 taskIdx)
+		{
+			const int32 end = FMath::Min(Directions.Num(), (taskIdx + 1) * SamplesPerTask);
+			for (int32 i = taskIdx * SamplesPerTask; i < end; ++i)
+			{
+				OutHeights[i] = SampleHeight(Directions[i], ExtraOctaves);
+			}
+		});
+}
@@ -0,0 +1,37 @@
+// (c) 2025 Michal Desmedt. Licensed under the PolyForm Noncommercial License 1.0.0. 
+// Noncommercial use only. Commercial use requires written permission. 
+// See https://polyformproject.org/licenses/noncommercial/1.0.0/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainNoiseDispatcher.h"
+
+/**
+ * CPU evaluation of the terrain height computed by TerrainNoiseCS.usf (SampleHeight).
+ *
+ * Port of the FastNoiseLite.ush path the shader uses: OpenSimplex2 3D with the default state of
+ * fnlCreateState (frequency 0.01, OpenSimplex2 rotation, no fractal), evaluated in float with the
+ * same operation order, so the same FTerrainNoiseParams give the heights the GPU renders.
+ */
+class FTerrainNoiseSampler
+{
+public:
+	GALAXYSHADERS_API explicit FTerrainNoiseSampler(const FTerrainNoiseParams& InParams);
+
+	/**
+	 * Height above the sphere of radius Params.Radius in a direction from the planet center.
+	 * ExtraOctaves adds detail octaves like the shader does for dense patches, 0 is the base LOD.
+	 */
+	GALAXYSHADERS_API float SampleHeight(const FVector3f& Direction, float ExtraOctaves = 0.0f) const;
+
+	/** SampleHeight for many directions, in parallel */
+	GALAXYSHADERS_API void SampleHeights(TConstArrayView<FVector3f> Directions, TArrayView<float> OutHeights, float ExtraOctaves = 0.0f) const;
+
+	/** fnlGetNoise3D with the shader noise state, in [-1, 1] */
+	static GALAXYSHADERS_API float GetNoise3D(int32 Seed, float X, float Y, float Z);
+
+	const FTerrainNoiseParams& GetParams() const { return Params; }
+
+private:
+	FTerrainNoiseParams Params;
+};